@@ -3,7 +3,9 @@
 
 namespace Prizm
 {
-	void Component::SetOwner(std::shared_ptr<Entity>& entity)
+	Component::~Component() {}
+
+	void Component::SetOwner(const std::shared_ptr<Entity>& entity)
 	{
 		_owner = entity;
 	}
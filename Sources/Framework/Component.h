@@ -20,7 +20,7 @@ namespace Prizm
 		virtual void Draw(void) = 0;
 		virtual void Finalize(void) = 0;
 		
-		void SetOwner(std::shared_ptr<Entity>& entity);
+		void SetOwner(const std::shared_ptr<Entity>& entity);
 		std::shared_ptr<Entity> GetOwner(void);
 	};
 }
\ No newline at end of file
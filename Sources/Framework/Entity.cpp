@@ -5,34 +5,49 @@ namespace Prizm
 {
 	void Entity::RunComponets(void)
 	{
-		for (const auto& component : _components)
+		for (auto it = _components.begin(); it != _components.end();)
 		{
-			if (component.second)
-				component.second->Run();
+			if (it->second)
+			{
+				it->second->Run();
+				++it;
+			}
 			else
-				_components.erase(component.first);
+			{
+				it = _components.erase(it);
+			}
 		}
 	}
 
 	void Entity::DrawComponents(void)
 	{
-		for (const auto& component : _components)
+		for (auto it = _components.begin(); it != _components.end();)
 		{
-			if (component.second)
-				component.second->Draw();
+			if (it->second)
+			{
+				it->second->Draw();
+				++it;
+			}
 			else
-				_components.erase(component.first);
+			{
+				it = _components.erase(it);
+			}
 		}
 	}
 
 	void Entity::FinalizeComponets(void)
 	{
-		for (const auto& component : _components)
+		for (auto it = _components.begin(); it != _components.end();)
 		{
-			if (component.second)
-				component.second->Finalize();
+			if (it->second)
+			{
+				it->second->Finalize();
+				++it;
+			}
 			else
-				_components.erase(component.first);
+			{
+				it = _components.erase(it);
+			}
 		}
 	}
 }
\ No newline at end of file
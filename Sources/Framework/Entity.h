@@ -1,17 +1,22 @@
 #pragma once
 
-#include<unordered_map>
+#include<map>
 #include<typeindex>
 #include<memory>
 
 #include"Component.h"
+#include"../Utilities/PoolAllocator.h"
 
 namespace Prizm
 {
-	class Entity
+	class Entity : public std::enable_shared_from_this<Entity>
 	{
 	private:
-		std::unordered_map<std::type_index, std::shared_ptr<Component>> _components;
+		// a node based map so every allocation is one pooled block, an unordered_map would take its buckets from the heap
+		using ComponentMap = std::map<std::type_index, std::shared_ptr<Component>, std::less<std::type_index>,
+			PoolAllocator<std::pair<const std::type_index, std::shared_ptr<Component>>>>;
+
+		ComponentMap _components;
 
 	public:
 		Entity(){}
@@ -19,21 +24,27 @@ namespace Prizm
 
 		virtual bool Initialize(void) = 0;
 		virtual void Run(void) = 0;
+		// simulation step at the fixed rate, dt in seconds
+		virtual void FixedRun(float) {}
 		virtual void Draw(void) = 0;
 		virtual void Finalize(void) = 0;
 
 		template<typename _ComTy, typename ... Args>
 		void AddComponent(const Args& ... args)
 		{
-			auto component = _components[typeid(_ComTy)] = std::make_shared<_ComTy>(args ...);
-			component->SetOwner(this);
+			// component and control block come from the per-type pool
+			auto component = _components[typeid(_ComTy)] = std::allocate_shared<_ComTy>(PoolAllocator<_ComTy>(), args ...);
+			component->SetOwner(shared_from_this());
 			component->Initialize();
 		}
 
 		template<typename _ComTy>
-		std::shared_ptr<Component>& GetComponent(void)
+		std::shared_ptr<_ComTy> GetComponent(void)
 		{
-			return std::static_pointer_cast<_ComTy>(_components[typeid(_ComTy)]);
+			auto it = _components.find(typeid(_ComTy));
+			if (it == _components.end()) return nullptr;
+
+			return std::static_pointer_cast<_ComTy>(it->second);
 		}
 
 		void RunComponets(void);
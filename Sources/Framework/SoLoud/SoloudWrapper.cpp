@@ -1,16 +1,95 @@
 
+#include<vector>
 #include<cassert>
+#include<algorithm>
 
 #include"SoloudWrapper.h"
+#include"..\SoundFramework\MusicStream.h"
 
 namespace Prizm
 {
+	namespace
+	{
+		constexpr unsigned int MAX_ACTIVE_VOICES = 32;
+
+		// SoLoud pulls a MusicStream on its mixer thread, seeks come from the game thread through Soloud::seek
+		class MusicStreamInstance : public SoLoud::AudioSourceInstance
+		{
+		private:
+			MusicStream& _stream;
+			// SoLoud asks for at most SAMPLE_GRANULARITY, sized here so the mixer thread never allocates
+			std::vector<float> _interleaved;
+
+		public:
+			explicit MusicStreamInstance(MusicStream& stream) : _stream(stream), _interleaved(SAMPLE_GRANULARITY * stream.GetChannels()) {}
+
+			unsigned int getAudio(float* buffer, unsigned int samples, unsigned int buffer_size) override
+			{
+				const unsigned int channels = _stream.GetChannels();
+				const unsigned int read = _stream.Read(_interleaved.data(), (std::min)(samples, static_cast<unsigned int>(SAMPLE_GRANULARITY)));
+
+				// SoLoud wants one channel after the other
+				for (unsigned int c = 0; c < channels; ++c)
+				{
+					float* output = buffer + c * buffer_size;
+
+					for (unsigned int i = 0; i < read; ++i) output[i] = _interleaved[i * channels + c];
+					std::fill(output + read, output + samples, 0.0f);
+				}
+
+				return samples;
+			}
+
+			bool hasEnded() override
+			{
+				return _stream.IsFinished();
+			}
+
+			SoLoud::result seek(SoLoud::time seconds, float*, unsigned int) override
+			{
+				_stream.Seek(seconds);
+				mStreamPosition = seconds;
+				return SoLoud::SO_NO_ERROR;
+			}
+
+			SoLoud::result rewind() override
+			{
+				return seek(0.0, nullptr, 0);
+			}
+		};
+
+		class MusicStreamSource : public SoLoud::AudioSource
+		{
+		private:
+			std::shared_ptr<MusicStream> _stream;
+
+		public:
+			explicit MusicStreamSource(const std::shared_ptr<MusicStream>& stream) : _stream(stream)
+			{
+				mChannels = _stream->GetChannels();
+				mBaseSamplerate = static_cast<float>(_stream->GetSampleRate());
+			}
+
+			~MusicStreamSource()
+			{
+				// instances still playing refer to the stream
+				stop();
+			}
+
+			SoLoud::AudioSourceInstance* createInstance() override
+			{
+				return new MusicStreamInstance(*_stream);
+			}
+		};
+	}
+
 	void SoloudWrapper::Initialize(void)
 	{
 		_instance = std::make_unique<SoLoud::Soloud>();
 		_instance.get()->init(SoLoud::Soloud::CLIP_ROUNDOFF | SoLoud::Soloud::ENABLE_VISUALIZATION | SoLoud::Soloud::LEFT_HANDED_3D);
 		_instance.get()->setGlobalVolume(0.75);
 		_instance.get()->setPostClipScaler(0.75);
+		_instance.get()->setMaxActiveVoiceCount(MAX_ACTIVE_VOICES);
 		_filter.setParams(SoLoud::BiquadResonantFilter::LOWPASS, 44100, 100, 10);
 
 		_speech = std::make_unique<SoLoud::Speech>();
@@ -23,49 +102,108 @@ namespace Prizm
 
 	unsigned int SoloudWrapper::AddSound(std::string& file_path, bool do_loop = false)
 	{
-		SoLoud::Wav sound;
-		sound.load(file_path.c_str());
-		sound.setLooping(do_loop);
+		auto sound = std::make_shared<SoLoud::Wav>();
+		sound->load(file_path.c_str());
+		sound->setLooping(do_loop);
+		// virtual voices keep their place instead of pausing
+		sound->setInaudibleBehavior(true, false);
 
-		return _sounds.Load(std::make_shared<SoLoud::Wav>(sound));
+		return _sounds.Load(sound);
 	}
 
 	unsigned int SoloudWrapper::AddMusic(std::string& file_path, bool do_loop = false)
 	{
-		SoLoud::Wav sound;
-		sound.load(file_path.c_str());
-		sound.setLooping(do_loop);
-		sound.setFilter(0, &_filter);
+		// the stream loops by itself, SoLoud's looping would rewind it
+		auto stream = MusicStream::Open(file_path, do_loop);
+
+		if (!stream)
+		{
+			// what MusicStream does not read is decoded whole as before
+			const unsigned int id = AddSound(file_path, do_loop);
+			_sounds.Get(id)->setFilter(0, &_filter);
+			return id;
+		}
+
+		auto music = std::make_shared<MusicStreamSource>(stream);
+		music->setFilter(0, &_filter);
+		music->setInaudibleBehavior(true, false);
+		// the stream has a single reader, SoLoud stops the playing instance before it creates the next
+		music->setSingleInstance(true);
+
+		const unsigned int id = _sounds.Load(music);
+		_instance_limit[id] = 1;
+
+		return id;
+	}
+
+	void SoloudWrapper::AddHandle(unsigned int id, SoundHandle handle)
+	{
+		auto& handles = _handle_id[id];
+
+		// finished voices drop out here rather than on a callback
+		handles.erase(std::remove_if(handles.begin(), handles.end(), [&](SoundHandle h) { return !_instance.get()->isValidVoiceHandle(h); }), handles.end());
+
+		const auto limit = _instance_limit.find(id);
+
+		if (limit != _instance_limit.end() && limit->second)
+		{
+			// the new voice is already playing, the oldest make room for it
+			while (handles.size() >= limit->second)
+			{
+				_instance.get()->stop(handles.front());
+				handles.erase(handles.begin());
+			}
+		}
 
-		return _sounds.Load(std::make_shared<SoLoud::Wav>(sound));
+		handles.push_back(handle);
 	}
 
 	void SoloudWrapper::Play(unsigned int id)
 	{
 		SoundHandle sh = _instance.get()->play(*_sounds.Get(id), 1);
 
-		_handle_id[id] = sh;
+		AddHandle(id, sh);
 	}
 
 	void SoloudWrapper::Play3d(unsigned int id, float x, float y, float z)
 	{
 		SoundHandle sh = _instance.get()->play3d(*_sounds.Get(id), x, y, z);
 
-		_handle_id[id] = sh;
+		AddHandle(id, sh);
 	}
 
 	void SoloudWrapper::Stop(unsigned int id)
 	{
-		_instance.get()->stop(_handle_id[id]);
+		const auto handles = _handle_id.find(id);
+		if (handles == _handle_id.end()) return;
+
+		for (auto handle : handles->second) _instance.get()->stop(handle);
+
+		_handle_id.erase(handles);
+	}
+
+	void SoloudWrapper::SetInstanceLimit(unsigned int id, unsigned int count)
+	{
+		_instance_limit[id] = count;
+	}
+
+	void SoloudWrapper::SetMaxVoices(unsigned int count)
+	{
+		_instance.get()->setMaxActiveVoiceCount(count);
 	}
 
 	void SoloudWrapper::Release(unsigned int id)
 	{
+		// the ids are reused, the next sound starts without a limit
+		_handle_id.erase(id);
+		_instance_limit.erase(id);
 		_sounds.Release(id);
 	}
 
 	void SoloudWrapper::Reset(void)
 	{
+		_handle_id.clear();
+		_instance_limit.clear();
 		_sounds.Reset();
 		assert(_sounds.Empty());
 	}
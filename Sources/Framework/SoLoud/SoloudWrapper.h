@@ -1,6 +1,7 @@
 #pragma once
 
 #include<string>
+#include<vector>
 #include<memory>
 #include<unordered_map>
 
@@ -26,8 +27,14 @@ namespace Prizm
 		std::unique_ptr<SoLoud::Speech> _speech;
 		SoLoud::BiquadResonantFilter _filter;
 
-		ResourcePool<SoLoud::Wav> _sounds;
-		std::unordered_map<unsigned int, SoundHandle> _handle_id;
+		// Wav for sounds, streamed for music
+		ResourcePool<SoLoud::AudioSource> _sounds;
+		// every voice still playing per sound id, oldest first
+		std::unordered_map<unsigned int, std::vector<SoundHandle>> _handle_id;
+		// 0 or missing is unlimited
+		std::unordered_map<unsigned int, unsigned int> _instance_limit;
+
+		void AddHandle(unsigned int id, SoundHandle handle);
 
 	public:
 		void Initialize(void);
@@ -36,14 +43,22 @@ namespace Prizm
 
 		unsigned int AddSound(std::string& file_path, bool do_loop);
 
+		// decoded while it plays, see MusicStream, one instance of a track plays at a time
 		unsigned int AddMusic(std::string& file_path, bool do_loop);
 
 		void Play(unsigned int id);
 
 		void Play3d(unsigned int id, float x, float y, float z);
 
+		// every voice of the sound
 		void Stop(unsigned int id);
 
+		// voices of the sound at once, the oldest is stopped to make room, 0 is unlimited
+		void SetInstanceLimit(unsigned int id, unsigned int count);
+
+		// SoLoud mixes the loudest this many, the others are virtual and keep playing silently
+		void SetMaxVoices(unsigned int count);
+
 		void Release(unsigned int id);
 
 		void Reset(void);
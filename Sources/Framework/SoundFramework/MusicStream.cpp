@@ -0,0 +1,373 @@
+
+#include<mutex>
+#include<atomic>
+#include<thread>
+#include<chrono>
+#include<algorithm>
+#include<condition_variable>
+
+#include"MusicStream.h"
+#include"WavFile.h"
+#include"../../Utilities/Log.h"
+#include"../../Utilities/Platform.h"
+#include"../../Utilities/SpscRing.h"
+
+namespace Prizm
+{
+	class MusicStream::Impl
+	{
+	public:
+		// after a seek the ring is full of chunks the reader drops on its next read,
+		// the worker looks for the room this often for a while instead of once a poll
+		static constexpr unsigned int SEEK_POLL = 250;	// microseconds
+		static constexpr unsigned int SEEK_POLL_COUNT = 64;
+
+		struct Chunk
+		{
+			float samples[CHUNK_FRAMES * 2];
+			unsigned int frames;
+			// the seek this chunk was decoded for
+			std::uint32_t serial;
+			// a one-shot stream ends with this chunk
+			bool last;
+			std::uint64_t first_frame;
+		};
+
+		Platform::MappedFile file;
+		WavFile::Format format;
+		std::uint64_t frame_count = 0;
+		bool loop = false;
+
+		SpscRing<Chunk, CHUNK_COUNT> chunks;
+
+		// the first chunk after a seek when the ring is full, read before the ring's chunks of the same seek
+		// the worker owns one until it sets ready, the reader hands it back by clearing ready,
+		// two so the next seek has one while the reader is still on the last
+		static constexpr unsigned int SEEK_CHUNK_COUNT = 2;
+		Chunk seek_chunks[SEEK_CHUNK_COUNT];
+		std::atomic<bool> seek_chunk_ready[SEEK_CHUNK_COUNT];
+
+		// game thread to worker, the serial is bumped after the frame is stored
+		std::atomic<std::uint64_t> seek_frame;
+		std::atomic<std::uint32_t> serial;
+
+		std::thread worker;
+		std::atomic<bool> worker_terminated;
+		std::mutex worker_mutex;
+		std::condition_variable worker_wake;
+
+		// reader thread
+		unsigned int chunk_read = 0;
+		Chunk* reading_seek_chunk = nullptr;
+		bool finished = false;
+		// a seek after the end starts it over
+		std::uint32_t finished_serial = 0;
+		std::atomic<std::uint64_t> position;
+		std::atomic<std::uint64_t> starve_count;
+
+		Impl(void) : seek_frame(0), serial(0), worker_terminated(false), position(0), starve_count(0)
+		{
+			for (auto& ready : seek_chunk_ready) ready = false;
+		}
+
+		// worker thread
+		Chunk* FreeSeekChunk(void)
+		{
+			for (unsigned int i = 0; i < SEEK_CHUNK_COUNT; ++i)
+			{
+				if (!seek_chunk_ready[i].load(std::memory_order_acquire)) return &seek_chunks[i];
+			}
+
+			return nullptr;
+		}
+
+		unsigned int SeekChunkIndex(const Chunk* chunk) const
+		{
+			return static_cast<unsigned int>(chunk - seek_chunks);
+		}
+
+		bool IsSeekChunk(const Chunk* chunk) const
+		{
+			return chunk >= seek_chunks && chunk < seek_chunks + SEEK_CHUNK_COUNT;
+		}
+
+		~Impl(void)
+		{
+			if (!worker.joinable()) return;
+
+			{
+				std::lock_guard<std::mutex> lock(worker_mutex);
+				worker_terminated = true;
+			}
+
+			worker_wake.notify_one();
+			worker.join();
+		}
+
+		void Decode(Chunk& chunk, std::uint64_t& frame, bool& ended)
+		{
+			const unsigned int channels = format.channels;
+
+			chunk.frames = 0;
+			chunk.last = false;
+			chunk.first_frame = frame;
+
+			while (chunk.frames < CHUNK_FRAMES)
+			{
+				if (frame >= frame_count)
+				{
+					if (!loop)
+					{
+						chunk.last = ended = true;
+						return;
+					}
+
+					frame = 0;
+				}
+
+				const unsigned int count = static_cast<unsigned int>((std::min)(static_cast<std::uint64_t>(CHUNK_FRAMES - chunk.frames), frame_count - frame));
+
+				// the page faults of the mapping are taken here rather than on the mixer
+				WavFile::Decode(format, static_cast<std::size_t>(frame), count, chunk.samples + chunk.frames * channels);
+
+				chunk.frames += count;
+				frame += count;
+			}
+		}
+
+		void WorkerFunc(void)
+		{
+			// a free chunk comes every CHUNK_FRAMES of playback, polling a few times in that is enough
+			const auto poll = std::chrono::microseconds(static_cast<std::uint64_t>(CHUNK_FRAMES) * 250000 / format.sample_rate);
+
+			std::uint32_t decode_serial = serial.load(std::memory_order_acquire);
+			std::uint64_t frame = seek_frame.load(std::memory_order_relaxed);
+			bool ended = false;
+			// the first chunk of this seek is not decoded yet
+			bool seek_pending = false;
+			unsigned int seek_polls = 0;
+
+			while (!worker_terminated)
+			{
+				const std::uint32_t current = serial.load(std::memory_order_acquire);
+
+				if (current != decode_serial)
+				{
+					decode_serial = current;
+					frame = seek_frame.load(std::memory_order_relaxed);
+					ended = false;
+					seek_pending = true;
+					seek_polls = SEEK_POLL_COUNT;
+				}
+
+				Chunk* chunk = ended ? nullptr : chunks.BeginPush();
+
+				// the ring is full of what the seek made stale, the reader gets the new position without waiting for room
+				if (!chunk && !ended && seek_pending) chunk = FreeSeekChunk();
+
+				if (!chunk)
+				{
+					const auto timeout = seek_polls ? std::chrono::microseconds(static_cast<std::int64_t>(SEEK_POLL)) : poll;
+					if (seek_polls) --seek_polls;
+
+					std::unique_lock<std::mutex> lock(worker_mutex);
+					worker_wake.wait_for(lock, timeout, [&] { return worker_terminated || serial.load(std::memory_order_acquire) != decode_serial; });
+					continue;
+				}
+
+				chunk->serial = decode_serial;
+				Decode(*chunk, frame, ended);
+				seek_pending = false;
+
+				if (IsSeekChunk(chunk))
+				{
+					seek_chunk_ready[SeekChunkIndex(chunk)].store(true, std::memory_order_release);
+					continue;
+				}
+
+				chunks.EndPush();
+				seek_polls = 0;
+			}
+		}
+
+		unsigned int Read(float* output, unsigned int frames)
+		{
+			const unsigned int channels = format.channels;
+			const std::uint32_t current = serial.load(std::memory_order_acquire);
+
+			unsigned int done = 0;
+
+			while (done < frames)
+			{
+				Chunk* chunk = NextChunk(current);
+
+				if (!chunk)
+				{
+					if (!(finished && finished_serial == current)) starve_count.fetch_add(1, std::memory_order_relaxed);
+					break;
+				}
+
+				// decoded before the last seek
+				if (static_cast<std::int32_t>(chunk->serial - current) < 0)
+				{
+					ReleaseChunk(chunk);
+					continue;
+				}
+
+				finished = false;
+
+				const unsigned int count = (std::min)(frames - done, chunk->frames - chunk_read);
+				std::copy(chunk->samples + chunk_read * channels, chunk->samples + (chunk_read + count) * channels, output + done * channels);
+
+				done += count;
+				chunk_read += count;
+
+				position.store((chunk->first_frame + chunk_read) % frame_count, std::memory_order_relaxed);
+
+				if (chunk_read == chunk->frames)
+				{
+					finished = chunk->last;
+					finished_serial = chunk->serial;
+					ReleaseChunk(chunk);
+				}
+			}
+
+			return done;
+		}
+
+		// reader thread, the seek chunk of the current seek goes first
+		Chunk* NextChunk(std::uint32_t current)
+		{
+			Chunk* seek_chunk = nullptr;
+
+			for (unsigned int i = 0; i < SEEK_CHUNK_COUNT; ++i)
+			{
+				if (!seek_chunk_ready[i].load(std::memory_order_acquire)) continue;
+
+				if (seek_chunks[i].serial == current)
+					seek_chunk = &seek_chunks[i];
+				else // a later seek came before it was read, the worker can have it for the next
+					ReleaseChunk(&seek_chunks[i]);
+			}
+
+			if (!seek_chunk) return chunks.Front();
+
+			// what the ring has before the seek's own chunks is stale, room for the worker right away
+			while (auto stale = chunks.Front())
+			{
+				if (static_cast<std::int32_t>(stale->serial - current) >= 0) break;
+				chunks.PopFront();
+			}
+
+			if (reading_seek_chunk != seek_chunk)
+			{// a stale ring chunk may have been read part way
+				reading_seek_chunk = seek_chunk;
+				chunk_read = 0;
+			}
+
+			return seek_chunk;
+		}
+
+		void ReleaseChunk(Chunk* chunk)
+		{
+			chunk_read = 0;
+
+			if (!IsSeekChunk(chunk))
+			{
+				chunks.PopFront();
+				return;
+			}
+
+			if (reading_seek_chunk == chunk) reading_seek_chunk = nullptr;
+			seek_chunk_ready[SeekChunkIndex(chunk)].store(false, std::memory_order_release);
+		}
+	};
+
+	MusicStream::MusicStream(void) : _impl(std::make_unique<Impl>())
+	{
+
+	}
+
+	MusicStream::~MusicStream(void)
+	{
+
+	}
+
+	std::shared_ptr<MusicStream> MusicStream::Open(const std::string& file_path, bool loop)
+	{
+		auto stream = std::make_shared<MusicStream>();
+		auto& impl = *stream->_impl;
+
+		if (!impl.file.Open(file_path))
+		{
+			Log::Error(PRIZM_FMT("Cannot open {}."), file_path);
+			return nullptr;
+		}
+
+		if (!WavFile::Parse(impl.file.GetData(), impl.file.GetSize(), impl.format))
+		{
+			Log::Error(PRIZM_FMT("{} is not a RIFF WAVE file."), file_path);
+			return nullptr;
+		}
+
+		if (!impl.format.IsSupported() || impl.format.GetFrameCount() == 0)
+		{
+			Log::Error(PRIZM_FMT("{}: unsupported format {} / {} bit / {} channels."), file_path, impl.format.format, impl.format.bits, impl.format.channels);
+			return nullptr;
+		}
+
+		impl.frame_count = impl.format.GetFrameCount();
+		impl.loop = loop;
+		impl.worker = std::thread(&Impl::WorkerFunc, &impl);
+
+		return stream;
+	}
+
+	unsigned int MusicStream::GetChannels(void) const
+	{
+		return _impl->format.channels;
+	}
+
+	unsigned int MusicStream::GetSampleRate(void) const
+	{
+		return _impl->format.sample_rate;
+	}
+
+	double MusicStream::GetLength(void) const
+	{
+		return static_cast<double>(_impl->frame_count) / _impl->format.sample_rate;
+	}
+
+	void MusicStream::Seek(double seconds)
+	{
+		const double frame = (std::max)(0.0, seconds) * _impl->format.sample_rate;
+		_impl->seek_frame.store((std::min)(static_cast<std::uint64_t>(frame), _impl->frame_count), std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(_impl->worker_mutex);
+			_impl->serial.fetch_add(1, std::memory_order_release);
+		}
+
+		_impl->worker_wake.notify_one();
+	}
+
+	double MusicStream::GetPosition(void) const
+	{
+		return static_cast<double>(_impl->position.load(std::memory_order_relaxed)) / _impl->format.sample_rate;
+	}
+
+	std::uint64_t MusicStream::GetStarveCount(void) const
+	{
+		return _impl->starve_count.load(std::memory_order_relaxed);
+	}
+
+	unsigned int MusicStream::Read(float* output, unsigned int frames)
+	{
+		return _impl->Read(output, frames);
+	}
+
+	bool MusicStream::IsFinished(void) const
+	{
+		return _impl->finished && _impl->finished_serial == _impl->serial.load(std::memory_order_acquire);
+	}
+}
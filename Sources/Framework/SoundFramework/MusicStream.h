@@ -0,0 +1,56 @@
+#pragma once
+
+#include<string>
+#include<memory>
+#include<cstdint>
+
+/*
+Music decoded as it plays instead of all at once.
+
+The file is memory mapped and a worker thread keeps CHUNK_COUNT chunks decoded ahead of
+the reader in a lock-free ring, so a track costs its read-ahead rather than its decoded
+length and opening one does not wait for a decode.
+
+Read belongs to a single reader thread, the mixer. Seek may come from the game thread
+at any time, the reader drops whatever was decoded before it. When the ring is full of
+those, the worker decodes the new position into a spare chunk the reader hands back,
+so a seek does not have to wait for the ring to drain.
+*/
+
+namespace Prizm
+{
+	class MusicStream
+	{
+	public:
+		static constexpr unsigned int CHUNK_FRAMES = 2048;
+		// about 0.75 s ahead at 44.1 kHz, 256 KB for stereo
+		static constexpr unsigned int CHUNK_COUNT = 16;
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> _impl;
+
+	public:
+		MusicStream(void);
+		~MusicStream(void);
+
+		// RIFF WAVE in the formats of SoundBuffer::LoadWav, starts decoding right away
+		static std::shared_ptr<MusicStream> Open(const std::string& file_path, bool loop = false);
+
+		unsigned int GetChannels(void) const;
+		unsigned int GetSampleRate(void) const;
+		double GetLength(void) const;
+
+		// game thread
+		void Seek(double seconds);
+		// where the reader is, in seconds
+		double GetPosition(void) const;
+		// reads that found the decoder behind and came back short
+		std::uint64_t GetStarveCount(void) const;
+
+		// reader thread, interleaved, fewer than frames at the end or while the decoder catches up
+		unsigned int Read(float* output, unsigned int frames);
+		// reader thread, a one-shot stream has been read to the end
+		bool IsFinished(void) const;
+	};
+}
@@ -1,9 +1,972 @@
 
+#include<cmath>
+#include<mutex>
+#include<atomic>
+#include<complex>
+#include<cstring>
+#include<algorithm>
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define PRIZM_SOUND_SSE 1
+#include<emmintrin.h>
+#else
+#define PRIZM_SOUND_SSE 0
+#endif
+
 #include"Sound.h"
+#include"../../Utilities/SpscRing.h"
 
 namespace Prizm
 {
-	Sound::Sound()
+	namespace
+	{
+		constexpr unsigned int FFT_SIZE = Sound::VISUALIZATION_SIZE * 2;
+		constexpr float PI = 3.14159265358979f;
+
+		// positions are 32.32 fixed point frames
+		constexpr int FRACTION_BITS = 32;
+		constexpr std::uint64_t ONE_FRAME = std::uint64_t(1) << FRACTION_BITS;
+		constexpr float FRACTION_SCALE = 1.0f / 4294967296.0f;
+
+		constexpr float MIN_PITCH = 1.0f / 16.0f;
+		constexpr float MAX_PITCH = 16.0f;
+
+		// source frames per output frame a stream may advance, bounds what one block reads
+		constexpr unsigned int MAX_STREAM_STEP = 16;
+		// the frame under the play position and the next are carried from block to block
+		constexpr unsigned int STREAM_CARRY = 2;
+
+		VoiceHandle MakeHandle(unsigned int slot, std::uint16_t generation) { return static_cast<VoiceHandle>(generation) << 16 | slot; }
+		unsigned int HandleSlot(VoiceHandle handle) { return handle & 0xFFFF; }
+		std::uint16_t HandleGeneration(VoiceHandle handle) { return static_cast<std::uint16_t>(handle >> 16); }
+
+		float Attenuate(Sound::ATTENUATION model, float distance, float min_distance, float max_distance, float rolloff)
+		{
+			distance = (std::max)(min_distance, (std::min)(max_distance, distance));
+
+			switch (model)
+			{
+			case Sound::INVERSE_DISTANCE:
+				return min_distance / (min_distance + rolloff * (distance - min_distance));
+			case Sound::LINEAR_DISTANCE:
+				return max_distance > min_distance ? (std::max)(0.0f, 1.0f - rolloff * (distance - min_distance) / (max_distance - min_distance)) : 1.0f;
+			case Sound::EXPONENTIAL_DISTANCE:
+				return std::pow(distance / min_distance, -rolloff);
+			default:
+				return 1.0f;
+			}
+		}
+
+		// output += input * gain, gain going linearly from -> to across the block
+		void Accumulate(float* output, const float* input, float from, float to)
+		{
+			const float delta = (to - from) / Sound::BLOCK_FRAMES;
+
+#if PRIZM_SOUND_SSE
+			__m128 gain = _mm_setr_ps(from, from + delta, from + delta * 2.0f, from + delta * 3.0f);
+			const __m128 gain_step = _mm_set1_ps(delta * 4.0f);
+
+			for (unsigned int i = 0; i < Sound::BLOCK_FRAMES; i += 4)
+			{
+				_mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i), _mm_mul_ps(_mm_loadu_ps(input + i), gain)));
+				gain = _mm_add_ps(gain, gain_step);
+			}
+#else
+			for (unsigned int i = 0; i < Sound::BLOCK_FRAMES; ++i)
+			{
+				output[i] += input[i] * (from + delta * i);
+			}
+#endif
+		}
+
+		// master volume and clip, planar to interleaved
+		void Interleave(float* output, const float* left, const float* right, float from, float to)
+		{
+			const float delta = (to - from) / Sound::BLOCK_FRAMES;
+
+#if PRIZM_SOUND_SSE
+			__m128 gain = _mm_setr_ps(from, from + delta, from + delta * 2.0f, from + delta * 3.0f);
+			const __m128 gain_step = _mm_set1_ps(delta * 4.0f);
+			const __m128 minimum = _mm_set1_ps(-1.0f);
+			const __m128 maximum = _mm_set1_ps(1.0f);
+
+			for (unsigned int i = 0; i < Sound::BLOCK_FRAMES; i += 4)
+			{
+				const __m128 l = _mm_mul_ps(_mm_loadu_ps(left + i), gain);
+				const __m128 r = _mm_mul_ps(_mm_loadu_ps(right + i), gain);
+
+				_mm_storeu_ps(output + i * 2, _mm_max_ps(minimum, _mm_min_ps(maximum, _mm_unpacklo_ps(l, r))));
+				_mm_storeu_ps(output + i * 2 + 4, _mm_max_ps(minimum, _mm_min_ps(maximum, _mm_unpackhi_ps(l, r))));
+				gain = _mm_add_ps(gain, gain_step);
+			}
+#else
+			for (unsigned int i = 0; i < Sound::BLOCK_FRAMES; ++i)
+			{
+				const float gain = from + delta * i;
+				output[i * 2] = (std::max)(-1.0f, (std::min)(1.0f, left[i] * gain));
+				output[i * 2 + 1] = (std::max)(-1.0f, (std::min)(1.0f, right[i] * gain));
+			}
+#endif
+		}
+
+		// in place radix-2
+		void FFT(std::complex<float>* data, unsigned int size)
+		{
+			for (unsigned int i = 1, j = 0; i < size; ++i)
+			{
+				unsigned int bit = size >> 1;
+				for (; j & bit; bit >>= 1) j ^= bit;
+				j ^= bit;
+
+				if (i < j) std::swap(data[i], data[j]);
+			}
+
+			for (unsigned int length = 2; length <= size; length <<= 1)
+			{
+				const std::complex<float> root = std::polar(1.0f, -2.0f * PI / length);
+
+				for (unsigned int i = 0; i < size; i += length)
+				{
+					std::complex<float> w(1.0f, 0.0f);
+
+					for (unsigned int k = 0; k < length / 2; ++k)
+					{
+						const auto even = data[i + k];
+						const auto odd = data[i + k + length / 2] * w;
+
+						data[i + k] = even + odd;
+						data[i + k + length / 2] = even - odd;
+						w *= root;
+					}
+				}
+			}
+		}
+	}
+
+	class Sound::Impl
+	{
+	public:
+		struct Command
+		{
+			enum Type : std::uint8_t
+			{
+				PLAY,
+				STOP,
+				STOP_ALL,
+				SET_GAIN,
+				SET_PAN,
+				SET_PITCH,
+				SET_POSITION,
+				SET_GLOBAL_VOLUME,
+				SET_MAX_VOICES,
+				SET_LISTENER_POSITION,
+				SET_LISTENER_ORIENTATION,
+			};
+
+			Type type;
+			bool loop;
+			bool spatial;
+			std::uint8_t attenuation;
+			std::uint16_t slot;
+			std::uint16_t generation;
+			const SoundBuffer* buffer;
+			MusicStream* stream;
+			float gain;
+			float pan;
+			float pitch;
+			// the listener orientation sends at here
+			float position[3];
+			float up[3];
+			float min_distance;
+			float max_distance;
+			float rolloff;
+			int priority;
+			unsigned int max_voices;
+		};
+
+		// owned by the game thread
+		struct Slot
+		{
+			std::shared_ptr<const SoundBuffer> buffer;
+			std::shared_ptr<MusicStream> stream;
+			std::uint16_t generation = 1;
+			bool in_use = false;
+			// stopped voices no longer count against max_instances
+			bool stopped = false;
+			// the STOP did not fit in the ring, it goes ahead of the next command
+			bool stop_pending = false;
+			std::uint64_t started = 0;
+		};
+
+		// owned by the audio thread
+		struct Voice
+		{
+			// one of the two
+			const SoundBuffer* buffer;
+			MusicStream* stream;
+			unsigned int channels;
+			unsigned int source_rate;
+			std::uint16_t generation;
+			bool active = false;
+			bool loop;
+			bool stopping;
+			bool spatial;
+			ATTENUATION attenuation;
+			int priority;
+			// not mixed this block, a voice that was gets one more block to fade out
+			bool virtualized;
+			// played since the last block, gains are picked once it is ranked
+			bool starting;
+
+			std::uint64_t position;
+			std::uint64_t step;
+
+			float gain;
+			float pan;
+			float pitch;
+
+			float source_position[3];
+			float min_distance;
+			float max_distance;
+			float rolloff;
+
+			// gain and pan at the listener for this block
+			float audible_gain;
+			float audible_pan;
+
+			// streams only, the position is the fraction past the first carried frame
+			float carry[STREAM_CARRY * CHANNELS];
+			unsigned int carry_frames;
+
+			// per channel gains reached at the end of the last block, the next ramp starts there
+			float left;
+			float right;
+		};
+
+		unsigned int sample_rate = DEFAULT_SAMPLE_RATE;
+
+		// game thread
+		Slot slots[MAX_VOICES];
+		std::vector<std::uint16_t> free_slots;
+		unsigned int active_slots = 0;
+		float global_volume = 1.0f;
+		unsigned int max_voices = DEFAULT_MAX_VOICES;
+		std::uint64_t play_count = 0;
+		std::uint64_t dropped_commands = 0;
+		// a voice left playing is never dropped like the other commands, these are sent again
+		unsigned int pending_stops = 0;
+		bool stop_all_pending = false;
+		float wave[VISUALIZATION_SIZE];
+		float fft[VISUALIZATION_SIZE];
+
+		SpscRing<Command, 1024> commands;
+		// a slot finishes once before it is reused, so MAX_VOICES never overflows
+		SpscRing<std::uint16_t, MAX_VOICES> finished;
+
+		// audio thread
+		Voice voices[MAX_VOICES];
+		float mix_global_volume = 1.0f;
+		float mix_applied_volume = 1.0f;
+		float listener_position[3];
+		float listener_right[3];
+		unsigned int mix_max_voices = DEFAULT_MAX_VOICES;
+		std::uint16_t ranking[MAX_VOICES];
+		std::atomic<unsigned int> real_voices;
+		float mix_left[BLOCK_FRAMES];
+		float mix_right[BLOCK_FRAMES];
+		float source_left[BLOCK_FRAMES];
+		float source_right[BLOCK_FRAMES];
+		float stream_frames[(BLOCK_FRAMES * MAX_STREAM_STEP + STREAM_CARRY) * CHANNELS];
+		float block[BLOCK_FRAMES * CHANNELS];
+		unsigned int block_read = BLOCK_FRAMES;
+
+		std::mutex audio_mutex;
+
+		// neither side waits on it, the audio thread skips a block and the game a refresh when the other holds it
+		std::mutex visualization_mutex;
+		float history[FFT_SIZE];
+
+		Impl(void)
+		{
+			Reset();
+		}
+
+		void Reset(void)
+		{
+			free_slots.clear();
+
+			for (unsigned int i = MAX_VOICES; i-- > 0;)
+			{
+				slots[i].buffer.reset();
+				slots[i].stream.reset();
+				slots[i].in_use = false;
+				slots[i].stopped = false;
+				slots[i].stop_pending = false;
+				free_slots.push_back(static_cast<std::uint16_t>(i));
+				voices[i].active = false;
+			}
+
+			std::uint16_t slot;
+			while (finished.Pop(slot)) {}
+
+			Command command;
+			while (commands.Pop(command)) {}
+
+			active_slots = 0;
+			pending_stops = 0;
+			stop_all_pending = false;
+			global_volume = mix_global_volume = mix_applied_volume = 1.0f;
+			max_voices = mix_max_voices = DEFAULT_MAX_VOICES;
+			real_voices = 0;
+
+			std::fill(std::begin(listener_position), std::end(listener_position), 0.0f);
+			SetListenerOrientation(0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f);
+			block_read = BLOCK_FRAMES;
+
+			std::fill(std::begin(wave), std::end(wave), 0.0f);
+			std::fill(std::begin(fft), std::end(fft), 0.0f);
+			std::fill(std::begin(history), std::end(history), 0.0f);
+		}
+
+		// game thread
+
+		bool Send(const Command& command)
+		{
+			if (SendPendingStops() && commands.Push(command)) return true;
+
+			++dropped_commands;
+			return false;
+		}
+
+		// the slot of a handle the game still owns, nullptr otherwise
+		Slot* FindSlot(VoiceHandle handle)
+		{
+			const unsigned int slot = HandleSlot(handle);
+			if (slot >= MAX_VOICES || !slots[slot].in_use || slots[slot].generation != HandleGeneration(handle)) return nullptr;
+
+			return &slots[slot];
+		}
+
+		void SendToVoice(VoiceHandle handle, Command command)
+		{
+			if (!FindSlot(handle)) return;
+
+			command.slot = static_cast<std::uint16_t>(HandleSlot(handle));
+			command.generation = HandleGeneration(handle);
+			Send(command);
+		}
+
+		void SendToVoice(VoiceHandle handle, Command::Type type, float value)
+		{
+			Command command = {};
+			command.type = type;
+			command.gain = command.pan = command.pitch = value;
+			SendToVoice(handle, command);
+		}
+
+		// buffer or stream, the other is null
+		VoiceHandle Start(const std::shared_ptr<const SoundBuffer>& buffer, const std::shared_ptr<MusicStream>& stream, const PlayParameters& parameters)
+		{
+			CollectFinished();
+
+			if (free_slots.empty())
+			{
+				++dropped_commands;
+				return INVALID_VOICE;
+			}
+
+			if (parameters.max_instances) LimitInstances(buffer.get(), stream.get(), parameters.max_instances - 1);
+
+			const std::uint16_t index = free_slots.back();
+			auto& slot = slots[index];
+
+			Command command = {};
+			command.type = Command::PLAY;
+			command.loop = parameters.loop;
+			command.slot = index;
+			command.generation = slot.generation;
+			command.buffer = buffer.get();
+			command.stream = stream.get();
+			command.gain = parameters.gain;
+			command.pan = parameters.pan;
+			command.pitch = parameters.pitch;
+			command.spatial = parameters.spatial;
+			command.attenuation = static_cast<std::uint8_t>(parameters.attenuation);
+			std::copy(parameters.position, parameters.position + 3, command.position);
+			// the exponential model divides by it
+			command.min_distance = (std::max)(parameters.min_distance, 0.0001f);
+			command.max_distance = (std::max)(parameters.max_distance, command.min_distance);
+			command.rolloff = parameters.rolloff;
+			command.priority = parameters.priority;
+
+			if (!Send(command)) return INVALID_VOICE;
+
+			free_slots.pop_back();
+			slot.buffer = buffer;
+			slot.stream = stream;
+			slot.in_use = true;
+			slot.stopped = false;
+			slot.started = ++play_count;
+			++active_slots;
+
+			return MakeHandle(index, slot.generation);
+		}
+
+		void StopSlot(unsigned int index)
+		{
+			auto& slot = slots[index];
+
+			if (!slot.stop_pending)
+			{
+				slot.stop_pending = true;
+				++pending_stops;
+			}
+
+			SendPendingStops();
+		}
+
+		void StopAll(void)
+		{
+			// covers the single stops too
+			for (auto& slot : slots) slot.stop_pending = false;
+			pending_stops = 0;
+			stop_all_pending = true;
+
+			SendPendingStops();
+		}
+
+		// false while a stop is still waiting for room, nothing else may pass it
+		bool SendPendingStops(void)
+		{
+			if (stop_all_pending)
+			{
+				Command command = {};
+				command.type = Command::STOP_ALL;
+				if (!commands.Push(command)) return false;
+
+				for (auto& slot : slots) slot.stopped = slot.in_use;
+				stop_all_pending = false;
+			}
+
+			for (unsigned int i = 0; pending_stops && i < MAX_VOICES; ++i)
+			{
+				auto& slot = slots[i];
+				if (!slot.stop_pending) continue;
+
+				Command command = {};
+				command.type = Command::STOP;
+				command.slot = static_cast<std::uint16_t>(i);
+				command.generation = slot.generation;
+				if (!commands.Push(command)) return false;
+
+				slot.stop_pending = false;
+				slot.stopped = true;
+				--pending_stops;
+			}
+
+			return true;
+		}
+
+		// stops the oldest voices of the buffer or stream until at most keep are left
+		void LimitInstances(const SoundBuffer* buffer, const MusicStream* stream, unsigned int keep)
+		{
+			for (;;)
+			{
+				unsigned int count = 0;
+				unsigned int oldest = MAX_VOICES;
+
+				for (unsigned int i = 0; i < MAX_VOICES; ++i)
+				{
+					const auto& slot = slots[i];
+					if (!slot.in_use || slot.stopped || slot.stop_pending || slot.buffer.get() != buffer || slot.stream.get() != stream) continue;
+
+					++count;
+					if (oldest == MAX_VOICES || slot.started < slots[oldest].started) oldest = i;
+				}
+
+				if (count <= keep) return;
+
+				StopSlot(oldest);
+			}
+		}
+
+		void CollectFinished(void)
+		{
+			std::uint16_t index;
+
+			while (finished.Pop(index))
+			{
+				auto& slot = slots[index];
+
+				slot.buffer.reset();
+				slot.stream.reset();
+				slot.in_use = false;
+
+				// finished on its own before the stop went out
+				if (slot.stop_pending)
+				{
+					slot.stop_pending = false;
+					--pending_stops;
+				}
+
+				// 0 would make the handle of slot 0 INVALID_VOICE
+				if (++slot.generation == 0) slot.generation = 1;
+
+				free_slots.push_back(index);
+				--active_slots;
+			}
+		}
+
+		void UpdateVisualization(void)
+		{
+			float samples[FFT_SIZE];
+
+			{
+				// the mixer is writing a block into it, last frame's wave and spectrum stay up rather than waiting
+				std::unique_lock<std::mutex> lock(visualization_mutex, std::try_to_lock);
+				if (!lock.owns_lock()) return;
+
+				std::copy(std::begin(history), std::end(history), samples);
+			}
+
+			std::copy(samples + FFT_SIZE - VISUALIZATION_SIZE, samples + FFT_SIZE, wave);
+
+			std::complex<float> spectrum[FFT_SIZE];
+
+			// hann window
+			for (unsigned int i = 0; i < FFT_SIZE; ++i)
+			{
+				spectrum[i] = samples[i] * (0.5f - 0.5f * std::cos(2.0f * PI * i / (FFT_SIZE - 1)));
+			}
+
+			FFT(spectrum, FFT_SIZE);
+
+			for (unsigned int i = 0; i < VISUALIZATION_SIZE; ++i)
+			{
+				fft[i] = std::abs(spectrum[i]) * (2.0f / VISUALIZATION_SIZE);
+			}
+		}
+
+		// audio thread
+
+		std::uint64_t StepOf(const Voice& voice) const
+		{
+			const double step = static_cast<double>((std::max)(MIN_PITCH, (std::min)(MAX_PITCH, voice.pitch))) * voice.source_rate / sample_rate;
+			const std::uint64_t fixed = (std::max)(std::uint64_t(1), static_cast<std::uint64_t>(step * ONE_FRAME));
+
+			return voice.stream ? (std::min)(fixed, std::uint64_t(MAX_STREAM_STEP) << FRACTION_BITS) : fixed;
+		}
+
+		// right is up x at in a left handed space, kept as it is when the orientation is degenerate
+		void SetListenerOrientation(float at_x, float at_y, float at_z, float up_x, float up_y, float up_z)
+		{
+			const float x = up_y * at_z - up_z * at_y;
+			const float y = up_z * at_x - up_x * at_z;
+			const float z = up_x * at_y - up_y * at_x;
+			const float length = std::sqrt(x * x + y * y + z * z);
+
+			if (length <= 0.0f) return;
+
+			listener_right[0] = x / length;
+			listener_right[1] = y / length;
+			listener_right[2] = z / length;
+		}
+
+		void ProcessCommands(void)
+		{
+			while (auto command = commands.Front())
+			{
+				auto& voice = voices[command->slot];
+				const bool matches = voice.active && voice.generation == command->generation;
+
+				switch (command->type)
+				{
+				case Command::PLAY:
+					voice.buffer = command->buffer;
+					voice.stream = command->stream;
+					voice.channels = voice.stream ? voice.stream->GetChannels() : voice.buffer->GetChannels();
+					voice.source_rate = voice.stream ? voice.stream->GetSampleRate() : voice.buffer->GetSampleRate();
+					voice.carry_frames = 0;
+					voice.generation = command->generation;
+					voice.active = true;
+					voice.loop = command->loop;
+					voice.stopping = false;
+					voice.position = 0;
+					voice.gain = command->gain;
+					voice.pan = command->pan;
+					voice.pitch = command->pitch;
+					voice.step = StepOf(voice);
+					voice.spatial = command->spatial;
+					voice.attenuation = static_cast<ATTENUATION>(command->attenuation);
+					std::copy(command->position, command->position + 3, voice.source_position);
+					voice.min_distance = command->min_distance;
+					voice.max_distance = command->max_distance;
+					voice.rolloff = command->rolloff;
+					voice.priority = command->priority;
+					voice.virtualized = false;
+					voice.starting = true;
+					voice.left = voice.right = 0.0f;
+					break;
+				case Command::STOP:
+					if (matches) voice.stopping = true;
+					break;
+				case Command::STOP_ALL:
+					for (auto& v : voices) v.stopping = true;
+					break;
+				case Command::SET_GAIN:
+					if (matches) voice.gain = command->gain;
+					break;
+				case Command::SET_PAN:
+					if (matches) voice.pan = command->pan;
+					break;
+				case Command::SET_PITCH:
+					if (matches)
+					{
+						voice.pitch = command->pitch;
+						voice.step = StepOf(voice);
+					}
+					break;
+				case Command::SET_POSITION:
+					if (matches) std::copy(command->position, command->position + 3, voice.source_position);
+					break;
+				case Command::SET_GLOBAL_VOLUME:
+					mix_global_volume = command->gain;
+					break;
+				case Command::SET_MAX_VOICES:
+					mix_max_voices = command->max_voices;
+					break;
+				case Command::SET_LISTENER_POSITION:
+					std::copy(command->position, command->position + 3, listener_position);
+					break;
+				case Command::SET_LISTENER_ORIENTATION:
+					SetListenerOrientation(command->position[0], command->position[1], command->position[2], command->up[0], command->up[1], command->up[2]);
+					break;
+				}
+
+				commands.PopFront();
+			}
+		}
+
+		// gain and pan at the listener, the distance gain and the pan along the listener's right for 3d voices
+		void Spatialize(Voice& voice) const
+		{
+			voice.audible_gain = voice.gain;
+			voice.audible_pan = voice.pan;
+
+			if (!voice.spatial) return;
+
+			const float x = voice.source_position[0] - listener_position[0];
+			const float y = voice.source_position[1] - listener_position[1];
+			const float z = voice.source_position[2] - listener_position[2];
+			const float distance = std::sqrt(x * x + y * y + z * z);
+
+			voice.audible_gain *= Attenuate(voice.attenuation, distance, voice.min_distance, voice.max_distance, voice.rolloff);
+
+			// centered on top of the listener
+			voice.audible_pan = distance > 0.0f ? (x * listener_right[0] + y * listener_right[1] + z * listener_right[2]) / distance : 0.0f;
+		}
+
+		void TargetGains(const Voice& voice, float& left, float& right) const
+		{
+			if (voice.stopping || voice.virtualized)
+			{
+				left = right = 0.0f;
+				return;
+			}
+
+			const float gain = voice.audible_gain;
+			const float pan = (std::max)(-1.0f, (std::min)(1.0f, voice.audible_pan));
+
+			if (voice.channels == 1)
+			{
+				const float angle = (pan + 1.0f) * (PI / 4.0f);
+				left = std::cos(angle) * gain;
+				right = std::sin(angle) * gain;
+			}
+			else
+			{
+				left = (std::min)(1.0f, 1.0f - pan) * gain;
+				right = (std::min)(1.0f, 1.0f + pan) * gain;
+			}
+		}
+
+		// fills source_left / source_right with one block of the voice, false once a one-shot has ended
+		bool Resample(Voice& voice)
+		{
+			const SoundBuffer& buffer = *voice.buffer;
+			const float* samples = buffer.GetSamples();
+			const unsigned int channels = buffer.GetChannels();
+			const std::uint64_t frame_count = buffer.GetFrameCount();
+			const std::uint64_t end = frame_count << FRACTION_BITS;
+
+			unsigned int i = 0;
+
+			if (voice.step == ONE_FRAME && (voice.position & (ONE_FRAME - 1)) == 0)
+			{
+				// same rate, straight copies of the runs up to the end of the buffer
+				while (i < BLOCK_FRAMES)
+				{
+					if (voice.position >= end)
+					{
+						if (!voice.loop) break;
+						voice.position = 0;
+					}
+
+					const std::uint64_t frame = voice.position >> FRACTION_BITS;
+					const unsigned int run = static_cast<unsigned int>((std::min)(static_cast<std::uint64_t>(BLOCK_FRAMES - i), frame_count - frame));
+					const float* source = samples + frame * channels;
+
+					if (channels == 1)
+					{
+						std::memcpy(source_left + i, source, run * sizeof(float));
+					}
+					else
+					{
+						for (unsigned int k = 0; k < run; ++k)
+						{
+							source_left[i + k] = source[k * 2];
+							source_right[i + k] = source[k * 2 + 1];
+						}
+					}
+
+					i += run;
+					voice.position += static_cast<std::uint64_t>(run) << FRACTION_BITS;
+				}
+			}
+			else
+			{
+				for (; i < BLOCK_FRAMES; ++i)
+				{
+					if (voice.position >= end)
+					{
+						if (!voice.loop) break;
+						voice.position %= end;
+					}
+
+					const std::uint64_t frame = voice.position >> FRACTION_BITS;
+					const float fraction = static_cast<float>(voice.position & (ONE_FRAME - 1)) * FRACTION_SCALE;
+
+					// the last frame of a one-shot holds instead of reading past the end
+					const std::uint64_t next = frame + 1 < frame_count ? frame + 1 : (voice.loop ? 0 : frame);
+					const float* a = samples + frame * channels;
+					const float* b = samples + next * channels;
+
+					source_left[i] = a[0] + (b[0] - a[0]) * fraction;
+					if (channels == 2) source_right[i] = a[1] + (b[1] - a[1]) * fraction;
+
+					voice.position += voice.step;
+				}
+			}
+
+			if (i == BLOCK_FRAMES) return true;
+
+			std::fill(source_left + i, source_left + BLOCK_FRAMES, 0.0f);
+			if (channels == 2) std::fill(source_right + i, source_right + BLOCK_FRAMES, 0.0f);
+			return false;
+		}
+
+		// fills source_left / source_right from what the stream has decoded, false once a one-shot stream has ended
+		bool ResampleStream(Voice& voice)
+		{
+			const unsigned int channels = voice.channels;
+			const std::uint64_t end = voice.position + voice.step * BLOCK_FRAMES;
+			const unsigned int advance = static_cast<unsigned int>(end >> FRACTION_BITS);
+			const unsigned int needed = advance + STREAM_CARRY;
+
+			std::copy(voice.carry, voice.carry + voice.carry_frames * channels, stream_frames);
+
+			// the end of a one-shot or a decoder that fell behind plays as silence
+			const unsigned int read = voice.carry_frames + voice.stream->Read(stream_frames + voice.carry_frames * channels, needed - voice.carry_frames);
+			std::fill(stream_frames + read * channels, stream_frames + needed * channels, 0.0f);
+
+			if (voice.step == ONE_FRAME && voice.position == 0)
+			{
+				if (channels == 1)
+				{
+					std::memcpy(source_left, stream_frames, BLOCK_FRAMES * sizeof(float));
+				}
+				else
+				{
+					for (unsigned int i = 0; i < BLOCK_FRAMES; ++i)
+					{
+						source_left[i] = stream_frames[i * 2];
+						source_right[i] = stream_frames[i * 2 + 1];
+					}
+				}
+			}
+			else
+			{
+				std::uint64_t position = voice.position;
+
+				for (unsigned int i = 0; i < BLOCK_FRAMES; ++i)
+				{
+					const float* a = stream_frames + (position >> FRACTION_BITS) * channels;
+					const float* b = a + channels;
+					const float fraction = static_cast<float>(position & (ONE_FRAME - 1)) * FRACTION_SCALE;
+
+					source_left[i] = a[0] + (b[0] - a[0]) * fraction;
+					if (channels == 2) source_right[i] = a[1] + (b[1] - a[1]) * fraction;
+
+					position += voice.step;
+				}
+			}
+
+			voice.position = end & (ONE_FRAME - 1);
+			voice.carry_frames = STREAM_CARRY;
+			std::copy(stream_frames + advance * channels, stream_frames + needed * channels, voice.carry);
+
+			return !(read < needed && voice.stream->IsFinished());
+		}
+
+		// the mix_max_voices first by priority and then by gain at the listener are mixed, the rest and the inaudible go virtual
+		void Prioritize(void)
+		{
+			unsigned int count = 0;
+
+			for (unsigned int i = 0; i < MAX_VOICES; ++i)
+			{
+				auto& voice = voices[i];
+				if (!voice.active) continue;
+
+				Spatialize(voice);
+
+				voice.virtualized = std::fabs(voice.audible_gain) < INAUDIBLE_GAIN;
+				if (!voice.virtualized) ranking[count++] = static_cast<std::uint16_t>(i);
+			}
+
+			if (count > mix_max_voices)
+			{
+				std::nth_element(ranking, ranking + mix_max_voices, ranking + count, [this](std::uint16_t a, std::uint16_t b)
+				{
+					if (voices[a].priority != voices[b].priority) return voices[a].priority > voices[b].priority;
+					return std::fabs(voices[a].audible_gain) > std::fabs(voices[b].audible_gain);
+				});
+
+				for (unsigned int i = mix_max_voices; i < count; ++i) voices[ranking[i]].virtualized = true;
+
+				count = mix_max_voices;
+			}
+
+			real_voices.store(count, std::memory_order_relaxed);
+		}
+
+		// a virtual voice moves on by a block without being resampled, streams are still read to stay in time
+		void AdvanceVoice(unsigned int index)
+		{
+			auto& voice = voices[index];
+
+			bool playing;
+
+			if (voice.stream)
+			{
+				playing = ResampleStream(voice);
+			}
+			else
+			{
+				const std::uint64_t end = static_cast<std::uint64_t>(voice.buffer->GetFrameCount()) << FRACTION_BITS;
+
+				voice.position += voice.step * BLOCK_FRAMES;
+				playing = voice.loop || voice.position < end;
+
+				if (voice.loop) voice.position %= end;
+			}
+
+			if (playing && !voice.stopping) return;
+
+			voice.active = false;
+			finished.Push(static_cast<std::uint16_t>(index));
+		}
+
+		void MixVoice(unsigned int index)
+		{
+			auto& voice = voices[index];
+
+			const bool playing = voice.stream ? ResampleStream(voice) : Resample(voice);
+
+			float left, right;
+			TargetGains(voice, left, right);
+
+			Accumulate(mix_left, source_left, voice.left, left);
+			Accumulate(mix_right, voice.channels == 2 ? source_right : source_left, voice.right, right);
+
+			voice.left = left;
+			voice.right = right;
+
+			if (playing && !voice.stopping) return;
+
+			voice.active = false;
+			finished.Push(static_cast<std::uint16_t>(index));
+		}
+
+		void MixBlock(void)
+		{
+			ProcessCommands();
+
+			std::fill(std::begin(mix_left), std::end(mix_left), 0.0f);
+			std::fill(std::begin(mix_right), std::end(mix_right), 0.0f);
+
+			Prioritize();
+
+			for (unsigned int i = 0; i < MAX_VOICES; ++i)
+			{
+				auto& voice = voices[i];
+				if (!voice.active) continue;
+
+				// no fade in for a voice mixed from its first block, one past the limit or inaudible stays silent
+				if (voice.starting)
+				{
+					voice.starting = false;
+					if (!voice.virtualized) TargetGains(voice, voice.left, voice.right);
+				}
+
+				// once faded out to nothing
+				if (voice.virtualized && voice.left == 0.0f && voice.right == 0.0f)
+					AdvanceVoice(i);
+				else
+					MixVoice(i);
+			}
+
+			Interleave(block, mix_left, mix_right, mix_applied_volume, mix_global_volume);
+			mix_applied_volume = mix_global_volume;
+
+			// skipped for this block rather than waiting on the game
+			std::unique_lock<std::mutex> lock(visualization_mutex, std::try_to_lock);
+			if (!lock.owns_lock()) return;
+
+			std::copy(history + BLOCK_FRAMES, history + FFT_SIZE, history);
+
+			float* latest = history + FFT_SIZE - BLOCK_FRAMES;
+			for (unsigned int i = 0; i < BLOCK_FRAMES; ++i)
+			{
+				latest[i] = (block[i * 2] + block[i * 2 + 1]) * 0.5f;
+			}
+		}
+
+		void Mix(float* output, unsigned int frames)
+		{
+			while (frames)
+			{
+				if (block_read == BLOCK_FRAMES)
+				{
+					MixBlock();
+					block_read = 0;
+				}
+
+				const unsigned int count = (std::min)(frames, BLOCK_FRAMES - block_read);
+				std::memcpy(output, block + block_read * CHANNELS, count * CHANNELS * sizeof(float));
+
+				output += count * CHANNELS;
+				frames -= count;
+				block_read += count;
+			}
+		}
+	};
+
+	static_assert(Sound::BLOCK_FRAMES % 4 == 0, "the SIMD loops run four frames at a time");
+	static_assert(Sound::BLOCK_FRAMES <= Sound::VISUALIZATION_SIZE * 2, "a block has to fit the visualization history");
+	static_assert(Sound::MAX_VOICES <= 0x10000, "the slot is the low 16 bits of a handle");
+
+	Sound::Sound() : _impl(std::make_unique<Impl>())
 	{
 
 	}
@@ -13,23 +976,194 @@ namespace Prizm
 
 	}
 
-	unsigned int Sound::Initialize(void)
+	unsigned int Sound::Initialize(unsigned int sample_rate)
 	{
-		return 0;
+		if (sample_rate == 0) return SOUND_INVALID_PARAMETER;
+
+		_impl->Reset();
+		_impl->sample_rate = sample_rate;
+
+		return SOUND_OK;
 	}
 
 	void Sound::Finalize(void)
 	{
+		_impl->Reset();
+	}
 
+	unsigned int Sound::GetSampleRate(void) const
+	{
+		return _impl->sample_rate;
 	}
 
-	void Sound::LockAudioMutex(void)
+	VoiceHandle Sound::Play(const std::shared_ptr<const SoundBuffer>& buffer, const PlayParameters& parameters)
 	{
+		if (!buffer || buffer->GetFrameCount() == 0 || buffer->GetChannels() < 1 || buffer->GetChannels() > 2) return INVALID_VOICE;
 
+		return _impl->Start(buffer, nullptr, parameters);
 	}
 
-	void Sound::UnlockAudioMutex(void)
+	VoiceHandle Sound::PlayStream(const std::shared_ptr<MusicStream>& stream, const PlayParameters& parameters)
+	{
+		if (!stream || stream->GetChannels() < 1 || stream->GetChannels() > 2) return INVALID_VOICE;
+
+		_impl->CollectFinished();
+
+		// a stream has one reader
+		for (const auto& slot : _impl->slots)
+		{
+			if (slot.in_use && slot.stream == stream) return INVALID_VOICE;
+		}
+
+		return _impl->Start(nullptr, stream, parameters);
+	}
+
+	void Sound::Stop(VoiceHandle handle)
+	{
+		if (!_impl->FindSlot(handle)) return;
+
+		_impl->StopSlot(HandleSlot(handle));
+	}
+
+	void Sound::StopAll(void)
+	{
+		_impl->StopAll();
+	}
+
+	void Sound::SetGain(VoiceHandle handle, float gain)
+	{
+		_impl->SendToVoice(handle, Impl::Command::SET_GAIN, gain);
+	}
+
+	void Sound::SetPan(VoiceHandle handle, float pan)
+	{
+		_impl->SendToVoice(handle, Impl::Command::SET_PAN, pan);
+	}
+
+	void Sound::SetPitch(VoiceHandle handle, float pitch)
+	{
+		_impl->SendToVoice(handle, Impl::Command::SET_PITCH, pitch);
+	}
+
+	void Sound::SetPosition(VoiceHandle handle, float x, float y, float z)
+	{
+		Impl::Command command = {};
+		command.type = Impl::Command::SET_POSITION;
+		command.position[0] = x;
+		command.position[1] = y;
+		command.position[2] = z;
+		_impl->SendToVoice(handle, command);
+	}
+
+	void Sound::SetListenerPosition(float x, float y, float z)
+	{
+		Impl::Command command = {};
+		command.type = Impl::Command::SET_LISTENER_POSITION;
+		command.position[0] = x;
+		command.position[1] = y;
+		command.position[2] = z;
+		_impl->Send(command);
+	}
+
+	void Sound::SetListenerOrientation(float at_x, float at_y, float at_z, float up_x, float up_y, float up_z)
+	{
+		Impl::Command command = {};
+		command.type = Impl::Command::SET_LISTENER_ORIENTATION;
+		command.position[0] = at_x;
+		command.position[1] = at_y;
+		command.position[2] = at_z;
+		command.up[0] = up_x;
+		command.up[1] = up_y;
+		command.up[2] = up_z;
+		_impl->Send(command);
+	}
+
+	void Sound::SetGlobalVolume(float volume)
+	{
+		Impl::Command command = {};
+		command.type = Impl::Command::SET_GLOBAL_VOLUME;
+		command.gain = volume;
+
+		if (_impl->Send(command)) _impl->global_volume = volume;
+	}
+
+	float Sound::GetGlobalVolume(void) const
+	{
+		return _impl->global_volume;
+	}
+
+	void Sound::SetMaxVoices(unsigned int count)
 	{
+		Impl::Command command = {};
+		command.type = Impl::Command::SET_MAX_VOICES;
+		command.max_voices = (std::min)(count, static_cast<unsigned int>(MAX_VOICES));
+
+		if (_impl->Send(command)) _impl->max_voices = command.max_voices;
+	}
+
+	unsigned int Sound::GetMaxVoices(void) const
+	{
+		return _impl->max_voices;
+	}
+
+	bool Sound::IsValidVoice(VoiceHandle handle) const
+	{
+		return _impl->FindSlot(handle) != nullptr;
+	}
 
+	unsigned int Sound::GetActiveVoiceCount(void) const
+	{
+		return _impl->active_slots;
+	}
+
+	unsigned int Sound::GetRealVoiceCount(void) const
+	{
+		return _impl->real_voices.load(std::memory_order_relaxed);
+	}
+
+	std::uint64_t Sound::GetDroppedCommandCount(void) const
+	{
+		return _impl->dropped_commands;
+	}
+
+	void Sound::Update(void)
+	{
+		_impl->CollectFinished();
+		_impl->SendPendingStops();
+		_impl->UpdateVisualization();
+	}
+
+	const float* Sound::GetWave(void) const
+	{
+		return _impl->wave;
+	}
+
+	const float* Sound::GetFFT(void) const
+	{
+		return _impl->fft;
+	}
+
+	void Sound::Mix(float* output, unsigned int frames)
+	{
+		std::lock_guard<std::mutex> lock(_impl->audio_mutex);
+		_impl->Mix(output, frames);
+	}
+
+	void Sound::Render(std::vector<float>& output, unsigned int frames)
+	{
+		const std::size_t offset = output.size();
+		output.resize(offset + static_cast<std::size_t>(frames) * CHANNELS);
+
+		Mix(output.data() + offset, frames);
+	}
+
+	void Sound::LockAudioMutex(void)
+	{
+		_impl->audio_mutex.lock();
+	}
+
+	void Sound::UnlockAudioMutex(void)
+	{
+		_impl->audio_mutex.unlock();
 	}
-}
\ No newline at end of file
+}
@@ -1,7 +1,38 @@
 #pragma once
 
+#include<vector>
+#include<memory>
+#include<cstdint>
+
+#include"SoundBuffer.h"
+#include"MusicStream.h"
+
+/*
+Software mixer, N voices into stereo float at a fixed block size.
+
+The game thread starts, stops and changes voices through a lock-free command queue,
+the audio thread pulls interleaved samples with Mix. Commands, listener and 3d source
+positions included, are applied at the start of a block and gain / pan changes are
+ramped across it, so the game never waits on the audio thread. Nothing on the audio path
+allocates, and the only lock it takes is the audio mutex the game holds on request.
+
+Every block the active voices are ranked by priority, then by how loud they reach the
+listener. Up to the voice limit are mixed, the rest and anything inaudible become virtual:
+they keep their play position without being resampled or mixed, and come back with a fade
+in once they rank again. Mixing cost follows the limit, not how many voices play.
+
+Music streams play as voices too, the mixer reads a block's worth from the stream's
+read-ahead instead of indexing a buffer.
+
+Render runs the same mixer on the calling thread and appends to a buffer,
+for offline output and the throughput numbers of MixerBench.
+*/
+
 namespace Prizm
 {
+	// 0 is never a valid handle
+	using VoiceHandle = std::uint32_t;
+
 	class Sound
 	{
 	public:
@@ -28,31 +59,124 @@ namespace Prizm
 		ASIO,
 		*/
 
-	private:
-		unsigned int _global_volume;
-		unsigned int _sample_rate;
-		unsigned int _channels;
-		unsigned int _backend_ID;
-		unsigned int _backend_string;
+		enum RESULT
+		{
+			SOUND_OK = 0,
+			SOUND_INVALID_PARAMETER,
+		};
+
+		static constexpr unsigned int BLOCK_FRAMES = 256;
+		static constexpr unsigned int MAX_VOICES = 256;
+		static constexpr unsigned int CHANNELS = 2;
+		static constexpr unsigned int DEFAULT_SAMPLE_RATE = 44100;
+		// voices mixed at once, see SetMaxVoices
+		static constexpr unsigned int DEFAULT_MAX_VOICES = 32;
+		// gain at the listener below which a voice is virtual, -60 dB
+		static constexpr float INAUDIBLE_GAIN = 0.001f;
+
+		// samples in GetWave, GetFFT has as many bins
+		static constexpr unsigned int VISUALIZATION_SIZE = 256;
+
+		static constexpr VoiceHandle INVALID_VOICE = 0;
+
+		// distance gain of 3d voices, the same models as SoLoud
+		enum ATTENUATION
+		{
+			NO_ATTENUATION = 0,
+			INVERSE_DISTANCE,
+			LINEAR_DISTANCE,
+			EXPONENTIAL_DISTANCE,
+		};
+
+		struct PlayParameters
+		{
+			float gain = 1.0f;
+			// -1 left to 1 right, constant power for mono sources, balance for stereo
+			float pan = 0.0f;
+			// playback rate, 2 is an octave up
+			float pitch = 1.0f;
+			bool loop = false;
 
-		float _visualizaion_data[256];
-		float _wav_data[256];
-		float _fft_data[256];
+			// 3d voices are panned from the listener and pan is ignored
+			bool spatial = false;
+			float position[3] = { 0.0f, 0.0f, 0.0f };
+			ATTENUATION attenuation = NO_ATTENUATION;
+			// distances are clamped to this range before attenuating
+			float min_distance = 1.0f;
+			float max_distance = 1000000.0f;
+			float rolloff = 1.0f;
 
-		float _3d_position[3];
-		float _3d_at[3];
-		float _3d_up[3];
-		float _3d_velosity[3];
+			// past the voice limit higher priorities are mixed first, the louder wins among equals
+			int priority = 0;
+			// voices of the same buffer or stream, 0 is unlimited, the oldest is stopped to make room
+			unsigned int max_instances = 0;
+		};
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> _impl;
 
 	public:
 		Sound(void);
 		~Sound(void);
 
 		// return result
-		unsigned int Initialize(void);
+		unsigned int Initialize(unsigned int sample_rate = DEFAULT_SAMPLE_RATE);
+		// no driver may be pulling anymore
 		void Finalize(void);
 
+		unsigned int GetSampleRate(void) const;
+		unsigned int GetChannels(void) const { return CHANNELS; }
+
+		// game thread
+		// the buffer is kept alive until the voice has finished, INVALID_VOICE when every voice is in use
+		VoiceHandle Play(const std::shared_ptr<const SoundBuffer>& buffer, const PlayParameters& parameters);
+		VoiceHandle Play(const std::shared_ptr<const SoundBuffer>& buffer) { return Play(buffer, PlayParameters()); }
+		// the stream is read by this voice alone and loops on its own, parameters.loop is not used
+		VoiceHandle PlayStream(const std::shared_ptr<MusicStream>& stream, const PlayParameters& parameters);
+		VoiceHandle PlayStream(const std::shared_ptr<MusicStream>& stream) { return PlayStream(stream, PlayParameters()); }
+		// fades out over one block
+		void Stop(VoiceHandle);
+		void StopAll(void);
+		void SetGain(VoiceHandle, float gain);
+		void SetPan(VoiceHandle, float pan);
+		void SetPitch(VoiceHandle, float pitch);
+		// 3d voices only
+		void SetPosition(VoiceHandle, float x, float y, float z);
+		// left handed, at is where the listener faces
+		void SetListenerPosition(float x, float y, float z);
+		void SetListenerOrientation(float at_x, float at_y, float at_z, float up_x, float up_y, float up_z);
+		void SetGlobalVolume(float volume);
+		float GetGlobalVolume(void) const;
+		// at most MAX_VOICES, the voices past it are virtual
+		void SetMaxVoices(unsigned int count);
+		unsigned int GetMaxVoices(void) const;
+
+		// false once the finished voice was collected by Update
+		bool IsValidVoice(VoiceHandle) const;
+		unsigned int GetActiveVoiceCount(void) const;
+		// voices mixed in the last block, the other active ones are virtual
+		unsigned int GetRealVoiceCount(void) const;
+
+		// commands lost to a full queue and plays without a free voice, stops are held back and sent on the next update instead
+		std::uint64_t GetDroppedCommandCount(void) const;
+
+		// once a frame, collects finished voices and refreshes the visualization, never waits on the mixer
+		void Update(void);
+
+		// the last mixed samples, mono
+		const float* GetWave(void) const;
+		// magnitudes, bin i is i * sample rate / (2 * VISUALIZATION_SIZE) Hz
+		const float* GetFFT(void) const;
+
+		// audio thread, interleaved stereo
+		void Mix(float* output, unsigned int frames);
+
+		// offline, appends frames to output on the calling thread, no driver may pull at the same time
+		void Render(std::vector<float>& output, unsigned int frames);
+
+		// Mix waits while the game holds it
 		void LockAudioMutex(void);
 		void UnlockAudioMutex(void);
 	};
-}
\ No newline at end of file
+}
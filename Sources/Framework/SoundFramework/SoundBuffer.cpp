@@ -0,0 +1,55 @@
+
+#include"SoundBuffer.h"
+#include"WavFile.h"
+#include"../../Utilities/Log.h"
+#include"../../Utilities/Platform.h"
+
+namespace Prizm
+{
+	SoundBuffer::SoundBuffer(void) : _channels(0), _sample_rate(0)
+	{
+
+	}
+
+	SoundBuffer::SoundBuffer(const float* samples, unsigned int frames, unsigned int channels, unsigned int sample_rate)
+		: _samples(samples, samples + static_cast<std::size_t>(frames) * channels), _channels(channels), _sample_rate(sample_rate)
+	{
+
+	}
+
+	std::shared_ptr<SoundBuffer> SoundBuffer::LoadWav(const std::string& file_path)
+	{
+		Platform::MappedFile file;
+
+		if (!file.Open(file_path))
+		{
+			Log::Error(PRIZM_FMT("Cannot open {}."), file_path);
+			return nullptr;
+		}
+
+		WavFile::Format format;
+
+		if (!WavFile::Parse(file.GetData(), file.GetSize(), format))
+		{
+			Log::Error(PRIZM_FMT("{} is not a RIFF WAVE file."), file_path);
+			return nullptr;
+		}
+
+		if (!format.IsSupported())
+		{
+			Log::Error(PRIZM_FMT("{}: unsupported format {} / {} bit / {} channels."), file_path, format.format, format.bits, format.channels);
+			return nullptr;
+		}
+
+		const std::size_t frame_count = format.GetFrameCount();
+
+		auto buffer = std::make_shared<SoundBuffer>();
+		buffer->_channels = format.channels;
+		buffer->_sample_rate = format.sample_rate;
+		buffer->_samples.resize(frame_count * format.channels);
+
+		WavFile::Decode(format, 0, frame_count, buffer->_samples.data());
+
+		return buffer;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include<string>
+#include<vector>
+#include<memory>
+
+namespace Prizm
+{
+	// decoded PCM the mixer plays from, float samples, interleaved when stereo
+	class SoundBuffer
+	{
+	private:
+		std::vector<float> _samples;
+		unsigned int _channels;
+		unsigned int _sample_rate;
+
+	public:
+		SoundBuffer(void);
+
+		// copies frames * channels samples
+		SoundBuffer(const float* samples, unsigned int frames, unsigned int channels, unsigned int sample_rate);
+
+		// RIFF WAVE, 8 / 16 / 24 / 32 bit integer or 32 bit float, mono or stereo
+		static std::shared_ptr<SoundBuffer> LoadWav(const std::string& file_path);
+
+		const float* GetSamples(void) const { return _samples.data(); }
+		unsigned int GetChannels(void) const { return _channels; }
+		unsigned int GetSampleRate(void) const { return _sample_rate; }
+		unsigned int GetFrameCount(void) const { return _channels ? static_cast<unsigned int>(_samples.size() / _channels) : 0; }
+		double GetLength(void) const { return _sample_rate ? static_cast<double>(GetFrameCount()) / _sample_rate : 0.0; }
+	};
+}
@@ -0,0 +1,108 @@
+#include<cstring>
+#include<algorithm>
+
+#include"WavFile.h"
+
+namespace Prizm
+{
+	namespace
+	{
+		constexpr std::uint16_t WAVE_FORMAT_PCM = 0x0001;
+		constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+		constexpr std::uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+		template<class _T>
+		_T ReadLE(const unsigned char* data)
+		{
+			_T value = 0;
+			for (std::size_t i = 0; i < sizeof(_T); ++i) value |= static_cast<_T>(data[i]) << (8 * i);
+			return value;
+		}
+
+		float DecodeSample(const unsigned char* data, std::uint16_t format, std::uint16_t bits)
+		{
+			if (format == WAVE_FORMAT_IEEE_FLOAT)
+			{
+				float value;
+				std::memcpy(&value, data, sizeof(float));
+				return value;
+			}
+
+			switch (bits)
+			{
+			case 8:
+				return (static_cast<int>(data[0]) - 128) * (1.0f / 128.0f);
+			case 16:
+				return static_cast<std::int16_t>(ReadLE<std::uint16_t>(data)) * (1.0f / 32768.0f);
+			case 24:
+				// sign extend through the top byte of a 32 bit value
+				return static_cast<std::int32_t>(std::uint32_t(data[0]) << 8 | std::uint32_t(data[1]) << 16 | std::uint32_t(data[2]) << 24) * (1.0f / 2147483648.0f);
+			default:
+				return static_cast<std::int32_t>(ReadLE<std::uint32_t>(data)) * (1.0f / 2147483648.0f);
+			}
+		}
+	}
+
+	bool WavFile::Format::IsSupported(void) const
+	{
+		const bool supported_bits = format == WAVE_FORMAT_PCM ? (bits == 8 || bits == 16 || bits == 24 || bits == 32) : (format == WAVE_FORMAT_IEEE_FLOAT && bits == 32);
+
+		return pcm && supported_bits && channels >= 1 && channels <= 2 && sample_rate != 0;
+	}
+
+	bool WavFile::Parse(const unsigned char* data, std::size_t size, Format& format)
+	{
+		format = Format();
+
+		if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) return false;
+
+		// chunks are word aligned
+		for (std::size_t offset = 12; offset + 8 <= size;)
+		{
+			const unsigned char* chunk = data + offset;
+			const std::size_t chunk_size = (std::min)(static_cast<std::size_t>(ReadLE<std::uint32_t>(chunk + 4)), size - offset - 8);
+
+			if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16)
+			{
+				format.format = ReadLE<std::uint16_t>(chunk + 8);
+				format.channels = ReadLE<std::uint16_t>(chunk + 10);
+				format.sample_rate = ReadLE<std::uint32_t>(chunk + 12);
+				format.bits = ReadLE<std::uint16_t>(chunk + 22);
+
+				// the sub format GUID starts with the plain format tag
+				if (format.format == WAVE_FORMAT_EXTENSIBLE && chunk_size >= 26) format.format = ReadLE<std::uint16_t>(chunk + 32);
+			}
+			else if (std::memcmp(chunk, "data", 4) == 0)
+			{
+				format.pcm = chunk + 8;
+				format.pcm_size = chunk_size;
+			}
+
+			offset += 8 + chunk_size + (chunk_size & 1);
+		}
+
+		return true;
+	}
+
+	void WavFile::Decode(const Format& format, std::size_t first_frame, std::size_t frames, float* output)
+	{
+		const std::size_t sample_size = format.bits / 8;
+		const unsigned char* pcm = format.pcm + first_frame * format.GetFrameSize();
+		const std::size_t sample_count = frames * format.channels;
+
+		if (format.format == WAVE_FORMAT_PCM && format.bits == 16)
+		{
+			// the common case without the per sample switch
+			for (std::size_t i = 0; i < sample_count; ++i)
+			{
+				output[i] = static_cast<std::int16_t>(ReadLE<std::uint16_t>(pcm + i * 2)) * (1.0f / 32768.0f);
+			}
+			return;
+		}
+
+		for (std::size_t i = 0; i < sample_count; ++i)
+		{
+			output[i] = DecodeSample(pcm + i * sample_size, format.format, format.bits);
+		}
+	}
+}
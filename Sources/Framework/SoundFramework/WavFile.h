@@ -0,0 +1,35 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+namespace Prizm
+{
+	// RIFF WAVE parsing shared by SoundBuffer and MusicStream, nothing is copied out of the file
+	namespace WavFile
+	{
+		struct Format
+		{
+			std::uint16_t format = 0;
+			std::uint16_t channels = 0;
+			std::uint16_t bits = 0;
+			std::uint32_t sample_rate = 0;
+
+			// the data chunk, inside the parsed bytes
+			const unsigned char* pcm = nullptr;
+			std::size_t pcm_size = 0;
+
+			// 8 / 16 / 24 / 32 bit integer or 32 bit float, mono or stereo
+			bool IsSupported(void) const;
+
+			std::size_t GetFrameSize(void) const { return bits / 8 * channels; }
+			std::size_t GetFrameCount(void) const { return GetFrameSize() ? pcm_size / GetFrameSize() : 0; }
+		};
+
+		// false when it is not a RIFF WAVE, a truncated data chunk is kept as far as it goes
+		bool Parse(const unsigned char* data, std::size_t size, Format& format);
+
+		// frames starting at first_frame to interleaved floats
+		void Decode(const Format& format, std::size_t first_frame, std::size_t frames, float* output);
+	}
+}
@@ -0,0 +1,266 @@
+
+#include<list>
+#include<cstring>
+#include<mutex>
+#include<unordered_map>
+
+#include"AssetCache.h"
+#include"Shader.h"
+#include"Texture.h"
+#include"..\Graphics\Graphics.h"
+#include"..\Utilities\Utils.h"
+#include"..\Utilities\Memory.h"
+#include"..\Utilities\Profiler.h"
+
+namespace Prizm
+{
+	namespace
+	{
+		// keys are hashed from the asset kind and everything that affects the loaded result
+		std::uint64_t TextureKey(const std::string& file_name)
+		{
+			const std::string kind = "Texture:";
+			auto key = HashUtils::Fnv1a64(kind.data(), kind.size());
+			return HashUtils::Fnv1a64(file_name.data(), file_name.size(), key);
+		}
+
+		std::uint64_t ShaderKey(const std::string& file_name,
+			const std::vector<ShaderType>& stages, const std::vector<D3D11_INPUT_ELEMENT_DESC>& element_desc)
+		{
+			const std::string kind = "Shader:";
+			auto key = HashUtils::Fnv1a64(kind.data(), kind.size());
+			key = HashUtils::Fnv1a64(file_name.data(), file_name.size(), key);
+
+			if (!stages.empty())
+				key = HashUtils::Fnv1a64(stages.data(), stages.size() * sizeof(ShaderType), key);
+
+			for (auto& element : element_desc)
+			{
+				if (element.SemanticName)
+					key = HashUtils::Fnv1a64(element.SemanticName, std::strlen(element.SemanticName), key);
+
+				const UINT values[] = { element.SemanticIndex, static_cast<UINT>(element.Format), element.InputSlot,
+					element.AlignedByteOffset, static_cast<UINT>(element.InputSlotClass), element.InstanceDataStepRate };
+				key = HashUtils::Fnv1a64(values, sizeof(values), key);
+			}
+
+			return key;
+		}
+	}
+
+	class AssetCache::Impl
+	{
+	public:
+		struct Entry
+		{
+			std::unique_ptr<CachedAsset> asset;
+			std::size_t size;
+			bool retained;								// unreferenced, linked in _lru
+			std::list<std::uint64_t>::iterator lru;
+		};
+
+		mutable std::mutex _mutex;
+		std::unordered_map<std::uint64_t, Entry> _entries;
+
+		// most recently released at the front
+		std::list<std::uint64_t> _lru;
+
+		std::size_t _budget = DEFAULT_BUDGET;
+		std::size_t _live_bytes = 0;
+		std::size_t _retained_bytes = 0;
+		unsigned int _hits = 0;
+		unsigned int _misses = 0;
+
+		// caller holds _mutex
+		CachedAsset* Find(std::uint64_t key)
+		{
+			auto it = _entries.find(key);
+			if (it == _entries.end()) return nullptr;
+
+			auto& entry = it->second;
+
+			if (entry.retained)
+			{
+				_lru.erase(entry.lru);
+				entry.retained = false;
+				_retained_bytes -= entry.size;
+				_live_bytes += entry.size;
+			}
+
+			++entry.asset->_cache_refs;
+			++_hits;
+
+			return entry.asset.get();
+		}
+
+		// caller holds _mutex, returns the entry that ended up in the cache
+		CachedAsset* Insert(std::uint64_t key, std::unique_ptr<CachedAsset> asset)
+		{
+			// another thread may have loaded the same asset meanwhile, keep the first one
+			if (auto existing = Find(key)) return existing;
+
+			asset->_cache_key = key;
+			asset->_cache_refs = 1;
+			++_misses;
+
+			Entry entry;
+			entry.size = asset->GetMemorySize();
+			entry.asset = std::move(asset);
+			entry.retained = false;
+
+			_live_bytes += entry.size;
+
+			auto result = entry.asset.get();
+			_entries.emplace(key, std::move(entry));
+			return result;
+		}
+
+		// caller holds _mutex, evicted assets are moved out so they are destroyed after unlock
+		void Trim(std::size_t bytes, std::vector<std::unique_ptr<CachedAsset>>& evicted)
+		{
+			while (_retained_bytes > bytes && !_lru.empty())
+			{
+				auto it = _entries.find(_lru.back());
+				_lru.pop_back();
+
+				_retained_bytes -= it->second.size;
+				evicted.emplace_back(std::move(it->second.asset));
+				_entries.erase(it);
+			}
+		}
+	};
+
+	AssetCache::AssetCache(void) : _impl(std::make_unique<Impl>()) {}
+
+	AssetCache::~AssetCache(void) = default;
+
+	void AssetCache::Release(CachedAsset* asset)
+	{
+		std::vector<std::unique_ptr<CachedAsset>> evicted;
+
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+
+		if (--asset->_cache_refs > 0) return;
+
+		auto& entry = _impl->_entries[asset->_cache_key];
+
+		_impl->_lru.push_front(asset->_cache_key);
+		entry.lru = _impl->_lru.begin();
+		entry.retained = true;
+
+		_impl->_live_bytes -= entry.size;
+		_impl->_retained_bytes += entry.size;
+
+		_impl->Trim(_impl->_budget, evicted);
+	}
+
+	std::shared_ptr<Texture> AssetCache::AcquireTexture(const std::string& file_name)
+	{
+		const auto key = TextureKey(file_name);
+		CachedAsset* asset = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(_impl->_mutex);
+			asset = _impl->Find(key);
+		}
+
+		if (!asset)
+		{
+			// load outside the lock, scene loads run on the loader thread
+			PRIZM_ZONE("AssetCache::LoadTexture");
+			Memory::TagScope tag(Memory::ASSETS);
+			auto texture = std::make_unique<Texture>();
+			texture->LoadTexture(Graphics::GetDevice(), file_name);
+
+			std::lock_guard<std::mutex> lock(_impl->_mutex);
+			asset = _impl->Insert(key, std::move(texture));
+		}
+
+		return std::shared_ptr<Texture>(static_cast<Texture*>(asset), [this](Texture* t) { Release(t); });
+	}
+
+	std::shared_ptr<Shader> AssetCache::AcquireShader(const std::string& file_name,
+		const std::vector<ShaderType>& stages, const std::vector<D3D11_INPUT_ELEMENT_DESC>& element_desc)
+	{
+		const auto key = ShaderKey(file_name, stages, element_desc);
+		CachedAsset* asset = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock(_impl->_mutex);
+			asset = _impl->Find(key);
+		}
+
+		if (!asset)
+		{
+			PRIZM_ZONE("AssetCache::LoadShader");
+			Memory::TagScope tag(Memory::ASSETS);
+			auto shader = std::make_unique<Shader>(file_name);
+
+			for (auto stage : stages)
+				shader->CompileAndCreateFromFile(Graphics::GetDevice(), stage, element_desc);
+
+			std::lock_guard<std::mutex> lock(_impl->_mutex);
+			asset = _impl->Insert(key, std::move(shader));
+		}
+
+		return std::shared_ptr<Shader>(static_cast<Shader*>(asset), [this](Shader* s) { Release(s); });
+	}
+
+	void AssetCache::SetBudget(std::size_t bytes)
+	{
+		std::vector<std::unique_ptr<CachedAsset>> evicted;
+
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+		_impl->_budget = bytes;
+		_impl->Trim(bytes, evicted);
+	}
+
+	std::size_t AssetCache::GetBudget(void) const
+	{
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+		return _impl->_budget;
+	}
+
+	std::size_t AssetCache::GetLiveBytes(void) const
+	{
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+		return _impl->_live_bytes;
+	}
+
+	std::size_t AssetCache::GetRetainedBytes(void) const
+	{
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+		return _impl->_retained_bytes;
+	}
+
+	unsigned int AssetCache::GetHitCount(void) const
+	{
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+		return _impl->_hits;
+	}
+
+	unsigned int AssetCache::GetMissCount(void) const
+	{
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+		return _impl->_misses;
+	}
+
+	void AssetCache::Trim(std::size_t bytes)
+	{
+		std::vector<std::unique_ptr<CachedAsset>> evicted;
+
+		std::lock_guard<std::mutex> lock(_impl->_mutex);
+		_impl->Trim(bytes, evicted);
+	}
+
+	void AssetCache::Clear(void)
+	{
+		Trim(0);
+	}
+
+	AssetCache& AssetCache::Global(void)
+	{
+		static AssetCache cache;
+		return cache;
+	}
+}
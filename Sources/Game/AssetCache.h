@@ -0,0 +1,76 @@
+#pragma once
+
+#include<memory>
+#include<string>
+#include<vector>
+#include<cstdint>
+#include<cstddef>
+
+#include<d3d11.h>
+
+#include"..\Graphics\GraphicsEnums.h"
+
+namespace Prizm
+{
+	class Shader;
+	class Texture;
+
+	// intrusive base for assets shared through AssetCache
+	class CachedAsset
+	{
+	private:
+		friend class AssetCache;
+
+		// number of outstanding AssetCache handles, guarded by the cache mutex
+		unsigned int _cache_refs = 0;
+		std::uint64_t _cache_key = 0;
+
+	public:
+		virtual ~CachedAsset(void) = default;
+
+		// approximate resident size in bytes, used for the retention budget
+		virtual std::size_t GetMemorySize(void) const = 0;
+	};
+
+	// global asset cache shared by all scenes
+	// assets stay alive while referenced, unreferenced assets are kept in a LRU list
+	// until the retained bytes go over the budget
+	class AssetCache
+	{
+	private:
+		class Impl;
+		std::unique_ptr<Impl> _impl;
+
+		void Release(CachedAsset*);
+
+	public:
+		static constexpr std::size_t DEFAULT_BUDGET = 64 * 1024 * 1024;
+
+		AssetCache(void);
+		~AssetCache(void);
+
+		// file name relative to Resources/Textures/
+		std::shared_ptr<Texture> AcquireTexture(const std::string& file_name);
+
+		// file name relative to Resources/Shaders/, compiles every stage in stages
+		std::shared_ptr<Shader> AcquireShader(const std::string& file_name,
+			const std::vector<ShaderType>& stages, const std::vector<D3D11_INPUT_ELEMENT_DESC>& element_desc);
+
+		// bytes of unreferenced assets kept around for reuse
+		void SetBudget(std::size_t bytes);
+		std::size_t GetBudget(void) const;
+
+		std::size_t GetLiveBytes(void) const;
+		std::size_t GetRetainedBytes(void) const;
+		unsigned int GetHitCount(void) const;
+		unsigned int GetMissCount(void) const;
+
+		// evict unreferenced assets until the retained bytes fit in bytes
+		void Trim(std::size_t bytes);
+
+		// evict every unreferenced asset
+		void Clear(void);
+
+		static AssetCache& Global(void);
+	};
+}
@@ -0,0 +1,91 @@
+
+#include<algorithm>
+
+#include"AudioDriver.h"
+#include"AudioDriver_Null.h"
+#include"AudioDriver_RtAudio.h"
+#include"../../Utilities/Log.h"
+
+#ifdef _WIN32
+#include"AudioDriver_WASAPI.h"
+#endif
+
+namespace Prizm
+{
+	AudioDriver* AudioDriver::_self = nullptr;
+	AudioDriver::Options AudioDriver::_options;
+
+	namespace
+	{
+		std::unique_ptr<AudioDriver> CreateBackend(const AudioDriver::Options& options)
+		{
+			if (options.backend == "null" || !options.file_path.empty())
+				return std::make_unique<AudioDriver_Null>(options.file_path, options.realtime);
+
+#if PRIZM_AUDIO_RTAUDIO
+			if (options.backend == "alsa" || options.backend == "pulse" || options.backend == "jack" || options.backend == "rtaudio")
+				return std::make_unique<AudioDriver_RtAudio>(options.backend);
+#endif
+
+#ifdef _WIN32
+			if (options.backend.empty() || options.backend == "wasapi") return std::make_unique<AudioDriver_WASAPI>();
+#elif PRIZM_AUDIO_RTAUDIO
+			if (options.backend.empty()) return std::make_unique<AudioDriver_RtAudio>();
+#endif
+
+			Log::Warning(PRIZM_FMT("Audio backend \"{}\" is not available."), options.backend);
+			return nullptr;
+		}
+	}
+
+	std::unique_ptr<AudioDriver> AudioDriver::Create(MixCallback callback, int mix_rate)
+	{
+		auto driver = CreateBackend(_options);
+
+		if (driver)
+		{
+			driver->SetMixCallback(callback);
+			driver->SetMixRate(mix_rate);
+
+			if (driver->Initialize()) return driver;
+
+			// the failed driver has to let go of _self first
+			driver.reset();
+		}
+
+		Log::Warning("No audio output, falling back to the null driver.");
+
+		driver = std::make_unique<AudioDriver_Null>();
+		driver->SetMixCallback(callback);
+		driver->SetMixRate(mix_rate);
+
+		if (!driver->Initialize()) return nullptr;
+		return driver;
+	}
+
+	AudioDriver::AudioDriver(void)
+		: _input_position(0)
+		, _input_size(0)
+		, _underrun_count(0)
+		, _glitch_count(0)
+		, _mix_rate(DEFAULT_MIX_RATE)
+		, _channels(2)
+		, _output_latency(DEFAULT_OUTPUT_LATENCY)
+		, _actual_latency(0.0)
+	{
+		if (!_self) _self = this;
+	}
+
+	AudioDriver::~AudioDriver(void)
+	{
+		if (_self == this) _self = nullptr;
+	}
+
+	void AudioDriver::MixAudio(float* output, unsigned int frames)
+	{
+		if (_mix_callback)
+			_mix_callback(output, frames);
+		else
+			std::fill(output, output + frames * 2, 0.0f);
+	}
+}
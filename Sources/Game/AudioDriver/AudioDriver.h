@@ -1,18 +1,60 @@
 #pragma once
 
+#include<atomic>
+#include<memory>
+#include<string>
 #include<vector>
+#include<cstdint>
+#include<functional>
 
 namespace Prizm
 {
+	// output device, pulls the mix on its own audio thread
 	class AudioDriver
 	{
+	public:
+		// fills frames of interleaved stereo float, called on the audio thread
+		using MixCallback = std::function<void(float* output, unsigned int frames)>;
+
+		// --audio, --audio-file, --audio-fast
+		struct Options
+		{
+			// wasapi, rtaudio, alsa, pulse, jack or null, empty for the platform default
+			std::string backend;
+			// the null driver writes the mix here as a float WAV
+			std::string file_path;
+			// the null driver pulls in real time, false as fast as the mixer goes
+			bool realtime = true;
+		};
+
 	private:
 		static AudioDriver * _self;
+		static Options _options;
 
 		std::vector<int32_t> _input_buffer;
 		unsigned int _input_position;
 		unsigned int _input_size;
 
+		MixCallback _mix_callback;
+
+		std::atomic<std::uint64_t> _underrun_count;
+		std::atomic<std::uint64_t> _glitch_count;
+
+	protected:
+		int _mix_rate;
+		unsigned int _channels;
+		// requested, the device may round it up
+		unsigned int _output_latency;
+		std::atomic<double> _actual_latency;
+
+		// audio thread, silence without a callback
+		void MixAudio(float* output, unsigned int frames);
+
+		// the device played out everything it had
+		void AddUnderrun(void) { _underrun_count.fetch_add(1, std::memory_order_relaxed); }
+		// a period was late, the device was not waiting on us or the mix took longer than a period
+		void AddGlitch(void) { _glitch_count.fetch_add(1, std::memory_order_relaxed); }
+
 	public:
 		enum SpeakerMode
 		{
@@ -23,8 +65,37 @@ namespace Prizm
 		};
 
 		static const int DEFAULT_MIX_RATE = 44100;
-		static const int DEFAULT_OUTPUT_LATENCY = 15;
+		// milliseconds
+		static const int DEFAULT_OUTPUT_LATENCY = 10;
 
 		static AudioDriver* GetAudioDriver() { return _self; }
+
+		// the backend Create opens, set once at launch
+		static void Configure(const Options& options) { _options = options; }
+
+		// the configured backend, the null driver when it can not be opened
+		static std::unique_ptr<AudioDriver> Create(MixCallback callback, int mix_rate = DEFAULT_MIX_RATE);
+
+		AudioDriver(void);
+		virtual ~AudioDriver(void);
+
+		// before Initialize
+		void SetMixCallback(MixCallback callback) { _mix_callback = std::move(callback); }
+		void SetMixRate(int mix_rate) { _mix_rate = mix_rate; }
+		void SetOutputLatency(unsigned int milliseconds) { _output_latency = milliseconds; }
+
+		// opens the device and starts the audio thread
+		virtual bool Initialize(void) = 0;
+		virtual void Finalize(void) = 0;
+
+		int GetMixRate(void) const { return _mix_rate; }
+		unsigned int GetChannels(void) const { return _channels; }
+
+		// from the mix to the speaker as far as the device reports it, any thread
+		double GetOutputLatencyMs(void) const { return _actual_latency.load(std::memory_order_relaxed); }
+
+		// any thread
+		std::uint64_t GetUnderrunCount(void) const { return _underrun_count.load(std::memory_order_relaxed); }
+		std::uint64_t GetGlitchCount(void) const { return _glitch_count.load(std::memory_order_relaxed); }
 	};
-}
\ No newline at end of file
+}
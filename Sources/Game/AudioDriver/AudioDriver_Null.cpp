@@ -0,0 +1,146 @@
+
+#include<chrono>
+#include<algorithm>
+#include<cstdint>
+
+#include"AudioDriver_Null.h"
+#include"../../Utilities/Log.h"
+#include"../../Utilities/PerfTimer.h"
+
+namespace Prizm
+{
+	namespace
+	{
+		constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+		constexpr std::uint32_t WAV_HEADER_SIZE = 44;
+
+		template<class _T>
+		void WriteLE(std::ofstream& file, _T value)
+		{
+			for (std::size_t i = 0; i < sizeof(_T); ++i) file.put(static_cast<char>(value >> (8 * i) & 0xFF));
+		}
+
+		// the sizes are patched once the stream ends
+		void WriteWavHeader(std::ofstream& file, std::uint32_t sample_rate, std::uint16_t channels, std::uint32_t data_bytes)
+		{
+			const std::uint16_t block_align = channels * sizeof(float);
+
+			file.write("RIFF", 4);
+			WriteLE<std::uint32_t>(file, WAV_HEADER_SIZE - 8 + data_bytes);
+			file.write("WAVE", 4);
+			file.write("fmt ", 4);
+			WriteLE<std::uint32_t>(file, 16);
+			WriteLE<std::uint16_t>(file, WAVE_FORMAT_IEEE_FLOAT);
+			WriteLE<std::uint16_t>(file, channels);
+			WriteLE<std::uint32_t>(file, sample_rate);
+			WriteLE<std::uint32_t>(file, sample_rate * block_align);
+			WriteLE<std::uint16_t>(file, block_align);
+			WriteLE<std::uint16_t>(file, 32);
+			file.write("data", 4);
+			WriteLE<std::uint32_t>(file, data_bytes);
+		}
+	}
+
+	AudioDriver_Null::AudioDriver_Null(const std::string& file_path, bool realtime)
+		: _file_path(file_path)
+		, _realtime(realtime)
+		, _data_bytes(0)
+		, _period_frames(0)
+		, _thread_terminated(true)
+		, _rendered_frames(0)
+	{
+
+	}
+
+	AudioDriver_Null::~AudioDriver_Null(void)
+	{
+		this->Finalize();
+	}
+
+	bool AudioDriver_Null::Initialize(void)
+	{
+		if (_mix_rate <= 0) return false;
+
+		if (!_file_path.empty())
+		{
+			_file.open(_file_path, std::ios::binary | std::ios::trunc);
+
+			if (!_file)
+			{
+				Log::Error(PRIZM_FMT("Null audio : cannot open {}."), _file_path);
+				return false;
+			}
+
+			_data_bytes = 0;
+			WriteWavHeader(_file, _mix_rate, 2, 0);
+		}
+
+		_channels = 2;
+		_period_frames = (std::max)(1u, static_cast<unsigned int>(_mix_rate) * _output_latency / 1000);
+		_samples.resize(_period_frames * 2);
+		_actual_latency = _period_frames * 1000.0 / _mix_rate;
+		_rendered_frames = 0;
+
+		_thread_terminated = false;
+		_thread = std::thread(&AudioDriver_Null::ThreadFunc, this);
+
+		Log::Info(PRIZM_FMT("Null audio output, {} Hz, {} frames per pull, {}{}."), _mix_rate, _period_frames
+			, _realtime ? "real time" : "maximum speed", _file_path.empty() ? "" : ", writing " + _file_path);
+
+		return true;
+	}
+
+	void AudioDriver_Null::ThreadFunc(void)
+	{
+		const PerfTimer::Nanoseconds period = static_cast<PerfTimer::Nanoseconds>(_period_frames) * 1000000000 / _mix_rate;
+		PerfTimer::Nanoseconds deadline = PerfTimer::Now();
+
+		while (!_thread_terminated)
+		{
+			MixAudio(_samples.data(), _period_frames);
+			_rendered_frames.fetch_add(_period_frames, std::memory_order_relaxed);
+
+			if (_file.is_open())
+			{
+				// little endian targets only, like the rest of the file formats
+				_file.write(reinterpret_cast<const char*>(_samples.data()), _samples.size() * sizeof(float));
+				_data_bytes += _samples.size() * sizeof(float);
+			}
+
+			if (!_realtime) continue;
+
+			deadline += period;
+			const PerfTimer::Nanoseconds now = PerfTimer::Now();
+
+			// a sound card would have run dry, start over from now instead of catching up
+			if (now > deadline + period)
+			{
+				AddGlitch();
+				deadline = now;
+				continue;
+			}
+
+			if (deadline > now) std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now));
+		}
+	}
+
+	void AudioDriver_Null::Finalize(void)
+	{
+		if (!_thread.joinable()) return;
+
+		_thread_terminated = true;
+		_thread.join();
+
+		if (_file.is_open())
+		{
+			// RIFF sizes are 32 bit, a longer capture keeps the data but not the size
+			const auto data_bytes = static_cast<std::uint32_t>((std::min)(_data_bytes, static_cast<std::uint64_t>(UINT32_MAX - WAV_HEADER_SIZE)));
+
+			_file.seekp(0);
+			WriteWavHeader(_file, _mix_rate, 2, data_bytes);
+			_file.close();
+		}
+
+		Log::Info(PRIZM_FMT("Null audio closed, {} frames, {} glitches."), GetRenderedFrames(), GetGlitchCount());
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include<string>
+#include<vector>
+#include<atomic>
+#include<thread>
+#include<fstream>
+
+#include"AudioDriver.h"
+
+namespace Prizm
+{
+	// no device, a thread pulls one latency worth of frames at a time and drops them or writes them to a WAV file
+	// real time paces the pulls to the clock like a sound card, otherwise it runs as fast as the mixer goes
+	class AudioDriver_Null : public AudioDriver
+	{
+	private:
+		std::string _file_path;
+		bool _realtime;
+
+		std::ofstream _file;
+		std::uint64_t _data_bytes;
+
+		unsigned int _period_frames;
+		std::vector<float> _samples;
+
+		std::thread _thread;
+		std::atomic<bool> _thread_terminated;
+		std::atomic<std::uint64_t> _rendered_frames;
+
+		void ThreadFunc(void);
+
+	public:
+		explicit AudioDriver_Null(const std::string& file_path = "", bool realtime = true);
+		~AudioDriver_Null(void);
+
+		bool Initialize(void) override;
+		void Finalize(void) override;
+
+		// any thread
+		std::uint64_t GetRenderedFrames(void) const { return _rendered_frames.load(std::memory_order_relaxed); }
+	};
+}
@@ -1,7 +1,134 @@
-
 #include"AudioDriver_RtAudio.h"
 
+#if PRIZM_AUDIO_RTAUDIO
+
+#include<algorithm>
+
+#ifdef _MSC_VER
+#include"RtAudio/RtAudio.h"
+#else
+// from the include directory pkg-config rtaudio gives
+#include<RtAudio.h>
+#endif
+
+#include"../../Utilities/Log.h"
+#include"../../Utilities/PerfTimer.h"
+
+#ifdef _MSC_VER
+#pragma comment(lib, "RtAudio/rtaudio_static.lib")
+#endif
+
 namespace Prizm
 {
+	namespace
+	{
+		RtAudio::Api ApiOf(const std::string& name)
+		{
+			if (name == "alsa") return RtAudio::LINUX_ALSA;
+			if (name == "pulse") return RtAudio::LINUX_PULSE;
+			if (name == "jack") return RtAudio::UNIX_JACK;
+			return RtAudio::UNSPECIFIED;
+		}
+	}
+
+	AudioDriver_RtAudio::AudioDriver_RtAudio(const std::string& api)
+		: _api(api)
+		, _buffer_frames(0)
+	{
+
+	}
+
+	AudioDriver_RtAudio::~AudioDriver_RtAudio(void)
+	{
+		this->Finalize();
+	}
+
+	int AudioDriver_RtAudio::Callback(void* output, void* input, unsigned int frames, double stream_time, unsigned int status, void* user_data)
+	{
+		auto driver = static_cast<AudioDriver_RtAudio*>(user_data);
+
+		if (status & RTAUDIO_OUTPUT_UNDERFLOW) driver->AddUnderrun();
+
+		const auto begin = PerfTimer::Now();
+		driver->MixAudio(static_cast<float*>(output), frames);
+
+		// longer than the buffer plays for, the next one is late
+		if ((PerfTimer::Now() - begin) * driver->_mix_rate > static_cast<PerfTimer::Nanoseconds>(frames) * 1000000000) driver->AddGlitch();
+
+		return 0;
+	}
+
+	bool AudioDriver_RtAudio::Initialize(void)
+	{
+		try
+		{
+			_rtaudio = std::make_unique<RtAudio>(ApiOf(_api));
+		}
+		catch (RtAudioError& error)
+		{
+			Log::Error(PRIZM_FMT("RtAudio : {}"), error.getMessage());
+			return false;
+		}
+
+		if (_rtaudio->getDeviceCount() == 0)
+		{
+			Log::Error(PRIZM_FMT("RtAudio : no output device through {}."), RtAudio::getApiName(_rtaudio->getCurrentApi()));
+			_rtaudio.reset();
+			return false;
+		}
+
+		RtAudio::StreamParameters parameters;
+		parameters.deviceId = _rtaudio->getDefaultOutputDevice();
+		parameters.nChannels = 2;
+		parameters.firstChannel = 0;
+
+		RtAudio::StreamOptions options;
+		options.flags = RTAUDIO_MINIMIZE_LATENCY | RTAUDIO_SCHEDULE_REALTIME;
+		options.streamName = "Prizm";
+
+		// RtAudio rounds it to what the API takes
+		_buffer_frames = (std::max)(64u, static_cast<unsigned int>(_mix_rate) * _output_latency / 1000);
+
+		try
+		{
+			_rtaudio->openStream(&parameters, nullptr, RTAUDIO_FLOAT32, _mix_rate, &_buffer_frames, &AudioDriver_RtAudio::Callback, this, &options);
+			_rtaudio->startStream();
+		}
+		catch (RtAudioError& error)
+		{
+			Log::Error(PRIZM_FMT("RtAudio : {}"), error.getMessage());
+			if (_rtaudio->isStreamOpen()) _rtaudio->closeStream();
+			_rtaudio.reset();
+			return false;
+		}
+
+		_channels = 2;
+		_actual_latency = (_rtaudio->getStreamLatency() + _buffer_frames) * 1000.0 / _mix_rate;
+
+		Log::Info(PRIZM_FMT("RtAudio output through {}, {} Hz, {} frames per buffer, latency {} ms."),
+			RtAudio::getApiName(_rtaudio->getCurrentApi()), _mix_rate, _buffer_frames, GetOutputLatencyMs());
+
+		return true;
+	}
+
+	void AudioDriver_RtAudio::Finalize(void)
+	{
+		if (!_rtaudio) return;
+
+		try
+		{
+			if (_rtaudio->isStreamRunning()) _rtaudio->stopStream();
+			if (_rtaudio->isStreamOpen()) _rtaudio->closeStream();
+		}
+		catch (RtAudioError& error)
+		{
+			Log::Error(PRIZM_FMT("RtAudio : {}"), error.getMessage());
+		}
+
+		_rtaudio.reset();
+
+		Log::Info(PRIZM_FMT("RtAudio closed, {} underruns, {} glitches."), GetUnderrunCount(), GetGlitchCount());
+	}
+}
 
-}
\ No newline at end of file
+#endif
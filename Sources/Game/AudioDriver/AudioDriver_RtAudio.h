@@ -1,13 +1,36 @@
 #pragma once
 
+#include<string>
+#include<memory>
+
 #include"AudioDriver.h"
 
+// set by the build where RtAudio is linked, the CMake build does so when pkg-config finds rtaudio
+// RtAudio is not in ThirdParty/Lib, so Windows builds use WASAPI unless it is added
+#ifndef PRIZM_AUDIO_RTAUDIO
+#define PRIZM_AUDIO_RTAUDIO 0
+#endif
+
+class RtAudio;
+
 namespace Prizm
 {
+	// ALSA, PulseAudio or JACK through RtAudio, the stream callback pulls the mix on the RtAudio thread
 	class AudioDriver_RtAudio : public AudioDriver
 	{
 	private:
+		// alsa, pulse or jack, anything else lets RtAudio pick the first API with an output device
+		std::string _api;
+		unsigned int _buffer_frames;
+		std::unique_ptr<RtAudio> _rtaudio;
+
+		static int Callback(void* output, void* input, unsigned int frames, double stream_time, unsigned int status, void* user_data);
 
 	public:
+		explicit AudioDriver_RtAudio(const std::string& api = "");
+		~AudioDriver_RtAudio(void);
+
+		bool Initialize(void) override;
+		void Finalize(void) override;
 	};
-}
\ No newline at end of file
+}
@@ -1,12 +1,16 @@
-
 #include "AudioDriver_WASAPI.h"
 
 //#include <audiopolicy.h>
 //#include <endpointvolume.h>
 #include <functiondiscoverykeys.h>
+#include <avrt.h>
+#include <ksmedia.h>
+#include <memory>
+#include <algorithm>
 
 #include"..\..\Utilities\Utils.h"
 #include"..\..\Utilities\Log.h"
+#include"..\..\Utilities\PerfTimer.h"
 
 #pragma comment(lib, "Avrt.lib")
 
@@ -18,8 +22,12 @@ namespace Prizm
 	const IID IID_IAudioRenderClient = __uuidof(IAudioRenderClient);
 	const IID IID_IAudioCaptureClient = __uuidof(IAudioCaptureClient);
 
-	static bool default_render_device_changed = false;
-	static bool default_capture_device_changed = false;
+	// set on the notification thread, taken by the render thread
+	static std::atomic<bool> default_render_device_changed(false);
+	static std::atomic<bool> default_capture_device_changed(false);
+
+	// a device that does not come back is retried at this interval
+	static const DWORD DEVICE_RETRY_INTERVAL = 1000;
 
 	class NotificationClient : public IMMNotificationClient
 	{
@@ -38,7 +46,7 @@ namespace Prizm
 				_enumerator.Reset();
 		}
 
-		unsigned long __stdcall AddRef(void) 
+		unsigned long __stdcall AddRef(void)
 		{
 			return _InterlockedIncrement(&_ref);
 		}
@@ -82,7 +90,7 @@ namespace Prizm
 			return S_OK;
 		}
 
-		HRESULT __stdcall OnDeviceStateChanged(LPCWSTR device_id, DWORD new_state) 
+		HRESULT __stdcall OnDeviceStateChanged(LPCWSTR device_id, DWORD new_state)
 		{
 			return S_OK;
 		}
@@ -108,96 +116,62 @@ namespace Prizm
 
 	static NotificationClient noti_client;
 
-	bool AudioDriver_WASAPI::InitializeAudioDevice(WASAPI_Device* w_device, bool do_capture)
+	AudioDriver_WASAPI::AudioDriver_WASAPI(void)
+		: _enumerator(nullptr)
+		, _buffer_frames(0)
+		, _period_frames(0)
+		, _buffer_event(nullptr)
+		, _thread_terminated(true)
 	{
-		WAVEFORMATEX* wave_format;
-		Microsoft::WRL::ComPtr<IMMDeviceEnumerator> d_enumerator = nullptr;
-		Microsoft::WRL::ComPtr<IMMDevice> device = nullptr;
 
-		::CoInitialize(nullptr);
+	}
 
-		if (failed(::CoCreateInstance(CLSID_MMDeviceEnumerator, nullptr, CLSCTX_ALL
-			, IID_IMMDeviceEnumerator, reinterpret_cast<void**>(d_enumerator.GetAddressOf()))))
-		{
-			Log::Error("Unable to create WASAPI instance.");
-			return false;
-		}
+	AudioDriver_WASAPI::~AudioDriver_WASAPI(void)
+	{
+		this->Finalize();
+	}
 
-		Microsoft::WRL::ComPtr<IMMDeviceCollection> devices = nullptr;
-		if (failed(d_enumerator->EnumAudioEndpoints(do_capture ? eCapture : eRender, DEVICE_STATEMASK_ALL, &devices)))
-		{
-			Log::Error("Unable to enumerate audio endpoints.");
-			return false;
-		}
+	bool AudioDriver_WASAPI::InitializeAudioDevice(WASAPI_Device* w_device, bool do_capture)
+	{
+		Microsoft::WRL::ComPtr<IMMDevice> device = nullptr;
 
-		unsigned int device_count = 0;
-		if (failed(devices->GetCount(&device_count)))
+		if (failed(_enumerator->GetDefaultAudioEndpoint(do_capture ? eCapture : eRender, eConsole, device.GetAddressOf())))
 		{
-			Log::Error("Unable to get IMM device count.");
+			Log::Error("WASAPI : no default audio endpoint.");
 			return false;
 		}
 
-		std::wstring device_descriptions;
-		bool found = false;
-
-		for (unsigned int i = 0; i < device_count && !found; ++i)
+		Microsoft::WRL::ComPtr<IPropertyStore> props = nullptr;
+		if (succeeded(device->OpenPropertyStore(STGM_READ, props.GetAddressOf())))
 		{
-			Microsoft::WRL::ComPtr<IMMDevice> device_temp = nullptr;
-	
-			if (failed(devices->Item(i, device_temp.GetAddressOf())))
-			{
-				Log::Error("Unable to get IMM device data.");
-				return false;
-			}
-
-			Microsoft::WRL::ComPtr<IPropertyStore> props = nullptr;
-			if (failed(device_temp->OpenPropertyStore(STGM_READ, props.GetAddressOf())))
-			{
-				Log::Error("Unable to open device property.");
-				return false;
-			}
-
 			// get device property to propvar
 			PROPVARIANT propvar;
 			PropVariantInit(&propvar);
-			if (failed(props->GetValue(PKEY_Device_FriendlyName, &propvar)))
-			{
-				Log::Error("Unable to get device property to propvar.");
-				return false;
-			}
 
-			device_descriptions.push_back(*propvar.pwszVal);
+			if (succeeded(props->GetValue(PKEY_Device_FriendlyName, &propvar)) && propvar.vt == VT_LPWSTR)
+				w_device->device_name = StrUtils::UnicodeToAscii(propvar.pwszVal);
 
 			PropVariantClear(&propvar);
-			props->Release();
-			device_temp->Release();
-		}
-
-		for (auto& device_description : device_descriptions)
-		{
-			CoTaskMemFree(&device_description);
 		}
-		
-		device_descriptions.clear();
 
-		if (failed(d_enumerator->RegisterEndpointNotificationCallback(&noti_client)))
+		if (failed(device->Activate(IID_IAudioClient, CLSCTX_ALL, nullptr
+			, reinterpret_cast<void**>(w_device->audio_client.GetAddressOf()))))
 		{
-			Log::Error("WASAPI : RegisterEndpointNotificationCallback error.");
+			Log::Error("WASAPI : unable to activate the audio client.");
+			return false;
 		}
 
-		d_enumerator.Reset();
-
-		device->Activate(IID_IAudioClient, CLSCTX_ALL, nullptr
-			, reinterpret_cast<void**>(w_device->audio_client.GetAddressOf()));
-
 		device.Reset();
 
-		if (failed(w_device->audio_client->GetMixFormat(&wave_format)))
+		WAVEFORMATEX* mix_format = nullptr;
+		if (failed(w_device->audio_client->GetMixFormat(&mix_format)))
 		{
-			Log::Error("");
+			Log::Error("WASAPI : unable to get the mix format.");
 			return false;
 		}
 
+		std::unique_ptr<WAVEFORMATEX, decltype(&CoTaskMemFree)> wave_format(mix_format, &CoTaskMemFree);
+
 		w_device->format_tag = wave_format->wFormatTag;
 		w_device->bps = wave_format->wBitsPerSample;
 		w_device->channels = wave_format->nChannels;
@@ -205,7 +179,7 @@ namespace Prizm
 
 		if (w_device->format_tag == WAVE_FORMAT_EXTENSIBLE)
 		{
-			WAVEFORMATEXTENSIBLE* wave_form_ex = reinterpret_cast<WAVEFORMATEXTENSIBLE*>(wave_format);
+			WAVEFORMATEXTENSIBLE* wave_form_ex = reinterpret_cast<WAVEFORMATEXTENSIBLE*>(wave_format.get());
 
 			if (wave_form_ex->SubFormat == KSDATAFORMAT_SUBTYPE_PCM)
 				w_device->format_tag = WAVE_FORMAT_PCM;
@@ -223,20 +197,38 @@ namespace Prizm
 			return false;
 		}
 
-		DWORD stream_flag;
-		if (_mix_rate != wave_format->nSamplesPerSec)
+		if ((w_device->format_tag == WAVE_FORMAT_IEEE_FLOAT && w_device->bps != 32)
+			|| (w_device->format_tag == WAVE_FORMAT_PCM && w_device->bps != 16 && w_device->bps != 24 && w_device->bps != 32))
 		{
-			stream_flag |= AUDCLNT_STREAMFLAGS_RATEADJUST;
+			Log::Error(PRIZM_FMT("WASAPI {} bit samples not supported."), w_device->bps);
+			return false;
+		}
+
+		DWORD stream_flag = do_capture ? 0 : AUDCLNT_STREAMFLAGS_EVENTCALLBACK;
+
+		// the engine converts when the mixer runs at another rate than the device
+		if (static_cast<DWORD>(_mix_rate) != wave_format->nSamplesPerSec)
+		{
+			stream_flag |= AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM | AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY;
 			wave_format->nSamplesPerSec = _mix_rate;
-			wave_format->nAvgBytesPerSec = wave_format->nSamplesPerSec * wave_format->nChannels * (wave_format->wBitsPerSample / 8);
+			wave_format->nAvgBytesPerSec = wave_format->nSamplesPerSec * wave_format->nBlockAlign;
 		}
 
-		if (failed(w_device->audio_client->Initialize(AUDCLNT_SHAREMODE_SHARED, stream_flag, do_capture ? 10000000 : 0, 0, wave_format, nullptr)))
+		// 100 ns units
+		const REFERENCE_TIME buffer_duration = do_capture ? 10000000 : static_cast<REFERENCE_TIME>(_output_latency) * 10000;
+
+		if (failed(w_device->audio_client->Initialize(AUDCLNT_SHAREMODE_SHARED, stream_flag, buffer_duration, 0, wave_format.get(), nullptr)))
 		{
 			Log::Error("WASAPI audio client initialize failed.");
 			return false;
 		}
 
+		if (!do_capture && failed(w_device->audio_client->SetEventHandle(_buffer_event)))
+		{
+			Log::Error("WASAPI : unable to set the buffer event.");
+			return false;
+		}
+
 		HRESULT hr;
 		if (do_capture)
 			hr = w_device->audio_client->GetService(IID_IAudioCaptureClient, reinterpret_cast<void **>(w_device->capture_client.GetAddressOf()));
@@ -249,15 +241,27 @@ namespace Prizm
 			return false;
 		}
 
-		CoTaskMemFree(wave_format);
-		device.Reset();
-
 		return true;
 	}
 
+	void AudioDriver_WASAPI::FinalizeAudioDevice(WASAPI_Device* w_device)
+	{
+		if (w_device->active && w_device->audio_client)
+			w_device->audio_client->Stop();
+
+		w_device->render_client.Reset();
+		w_device->capture_client.Reset();
+		w_device->audio_client.Reset();
+		w_device->active = false;
+	}
+
 	bool AudioDriver_WASAPI::InitializeRenderDevice(void)
 	{
-		if (!InitializeAudioDevice(&_wasapi_device, false)) return false;
+		if (!InitializeAudioDevice(&_wasapi_device, false))
+		{
+			FinalizeAudioDevice(&_wasapi_device);
+			return false;
+		}
 
 		switch (_wasapi_device.channels)
 		{
@@ -266,42 +270,236 @@ namespace Prizm
 		case 6:
 		case 8:
 			_channels = _wasapi_device.channels;
+			break;
 		default:
-			_channels = 2;
-			Log::Warning("WASAPI unsupported number of channels.");
+			Log::Error(PRIZM_FMT("WASAPI unsupported number of channels {}."), _wasapi_device.channels);
+			FinalizeAudioDevice(&_wasapi_device);
+			return false;
 		}
 
-		unsigned int max_frames;
+		UINT32 max_frames;
 		if (failed(_wasapi_device.audio_client->GetBufferSize(&max_frames)))
 		{
 			Log::Error("Failed get audio client frame buffer");
+			FinalizeAudioDevice(&_wasapi_device);
 			return false;
 		}
 
+		REFERENCE_TIME default_period = 0, stream_latency = 0;
+		_wasapi_device.audio_client->GetDevicePeriod(&default_period, nullptr);
+		_wasapi_device.audio_client->GetStreamLatency(&stream_latency);
+
 		_buffer_frames = max_frames;
+		_period_frames = static_cast<int>(default_period * _mix_rate / 10000000);
+		if (_period_frames <= 0) _period_frames = _buffer_frames / 2;
+
+		// a pull never asks for more than the whole buffer
+		_samples.resize(_buffer_frames * 2);
+
+		// the buffer is kept full, what is in it plus what the engine holds back
+		_actual_latency = _buffer_frames * 1000.0 / _mix_rate + stream_latency / 10000.0;
+
+		Log::Info(PRIZM_FMT("WASAPI output \"{}\", {} channels, {} Hz."), _wasapi_device.device_name, _channels, _mix_rate);
+		Log::Info(PRIZM_FMT("WASAPI audio buffer {} frames, period {} frames, latency {} ms."), _buffer_frames, _period_frames, GetOutputLatencyMs());
+
+		return true;
+	}
+
+	bool AudioDriver_WASAPI::ResetRenderDevice(void)
+	{
+		FinalizeAudioDevice(&_wasapi_device);
 
-		_samples.resize(_buffer_frames * _channels);
+		if (!InitializeRenderDevice()) return false;
 
-		Log::Info("WASAPI detected " + std::to_string(_channels) + " channels.");
-		Log::Info("WASAPI audio buffer " + std::to_string(_buffer_frames) 
-			+ " frames, and calculated latency " + std::to_string(_buffer_frames * 1000 / _mix_rate) + "ms.");
+		// start on a full buffer so the first period after the switch does not underrun
+		BYTE* data = nullptr;
+		if (succeeded(_wasapi_device.render_client->GetBuffer(_buffer_frames, &data)))
+		{
+			WriteFrames(data, _buffer_frames);
+			_wasapi_device.render_client->ReleaseBuffer(_buffer_frames, 0);
+		}
 
+		if (failed(_wasapi_device.audio_client->Start()))
+		{
+			Log::Error("WASAPI : unable to start the audio client.");
+			FinalizeAudioDevice(&_wasapi_device);
+			return false;
+		}
+
+		_wasapi_device.active = true;
 		return true;
 	}
 
+	void AudioDriver_WASAPI::WriteFrames(BYTE* data, unsigned int frames)
+	{
+		MixAudio(_samples.data(), frames);
+
+		const unsigned int channels = _wasapi_device.channels;
+
+		// stereo goes to the front pair, the other speakers stay silent
+		for (unsigned int frame = 0; frame < frames; ++frame)
+		{
+			for (unsigned int channel = 0; channel < channels; ++channel)
+			{
+				const float sample = channel < 2 ? _samples[frame * 2 + channel] : 0.0f;
+				const unsigned int index = frame * channels + channel;
+
+				if (_wasapi_device.format_tag == WAVE_FORMAT_IEEE_FLOAT)
+				{
+					reinterpret_cast<float*>(data)[index] = sample;
+					continue;
+				}
+
+				const float clipped = (std::max)(-1.0f, (std::min)(1.0f, sample));
+
+				switch (_wasapi_device.bps)
+				{
+				case 16:
+					reinterpret_cast<int16_t*>(data)[index] = static_cast<int16_t>(clipped * 32767.0f);
+					break;
+				case 24:
+				{
+					const int32_t value = static_cast<int32_t>(clipped * 8388607.0f);
+					data[index * 3 + 0] = static_cast<BYTE>(value);
+					data[index * 3 + 1] = static_cast<BYTE>(value >> 8);
+					data[index * 3 + 2] = static_cast<BYTE>(value >> 16);
+					break;
+				}
+				default:
+					reinterpret_cast<int32_t*>(data)[index] = static_cast<int32_t>(clipped * 2147483520.0f);
+					break;
+				}
+			}
+		}
+	}
+
+	void AudioDriver_WASAPI::ThreadFunc(void)
+	{
+		::CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+		// the mix runs ahead of the game thread, MMCSS keeps it from being starved
+		DWORD task_index = 0;
+		HANDLE task = ::AvSetMmThreadCharacteristicsW(L"Pro Audio", &task_index);
+		if (!task) Log::Warning("WASAPI : unable to register the render thread with MMCSS.");
+
+		while (!_thread_terminated)
+		{
+			if (default_render_device_changed.exchange(false) || !_wasapi_device.active)
+			{
+				if (!ResetRenderDevice())
+				{
+					::WaitForSingleObject(_buffer_event, DEVICE_RETRY_INTERVAL);
+					continue;
+				}
+			}
+
+			const PerfTimer::Nanoseconds period = static_cast<PerfTimer::Nanoseconds>(_period_frames) * 1000000000 / _mix_rate;
+
+			// twice the period, a timeout means the engine is not pulling
+			if (::WaitForSingleObject(_buffer_event, static_cast<DWORD>(period * 2 / 1000000) + 1) != WAIT_OBJECT_0)
+			{
+				if (_thread_terminated) break;
+				AddGlitch();
+			}
+
+			UINT32 padding = 0;
+			HRESULT hr = _wasapi_device.audio_client->GetCurrentPadding(&padding);
+
+			if (hr == AUDCLNT_E_DEVICE_INVALIDATED)
+			{
+				Log::Warning("WASAPI : output device lost, reopening the default device.");
+				FinalizeAudioDevice(&_wasapi_device);
+				continue;
+			}
+
+			if (failed(hr)) continue;
+
+			// the engine had nothing left to play when it signaled
+			if (padding == 0) AddUnderrun();
+
+			const UINT32 frames = _buffer_frames - padding;
+			if (frames == 0) continue;
+
+			BYTE* data = nullptr;
+			hr = _wasapi_device.render_client->GetBuffer(frames, &data);
+
+			if (hr == AUDCLNT_E_DEVICE_INVALIDATED)
+			{
+				FinalizeAudioDevice(&_wasapi_device);
+				continue;
+			}
+
+			if (failed(hr)) continue;
+
+			const auto begin = PerfTimer::Now();
+			WriteFrames(data, frames);
+
+			if (PerfTimer::Now() - begin > period) AddGlitch();
+
+			_wasapi_device.render_client->ReleaseBuffer(frames, 0);
+		}
+
+		FinalizeAudioDevice(&_wasapi_device);
+
+		if (task) ::AvRevertMmThreadCharacteristics(task);
+
+		::CoUninitialize();
+	}
+
 	bool AudioDriver_WASAPI::Initialize(void)
 	{
-		_mix_rate = DEFAULT_MIX_RATE;
+		::CoInitialize(nullptr);
+
+		if (failed(::CoCreateInstance(CLSID_MMDeviceEnumerator, nullptr, CLSCTX_ALL
+			, IID_IMMDeviceEnumerator, reinterpret_cast<void**>(_enumerator.GetAddressOf()))))
+		{
+			Log::Error("Unable to create WASAPI instance.");
+			::CoUninitialize();
+			return false;
+		}
 
-		//if (!InitializeRenderDevice()) return false;
+		_buffer_event = ::CreateEvent(nullptr, FALSE, FALSE, nullptr);
 
-		// mutex and thread registration
+		if (!InitializeRenderDevice())
+		{
+			::CloseHandle(_buffer_event);
+			_buffer_event = nullptr;
+			_enumerator.Reset();
+			::CoUninitialize();
+			return false;
+		}
+
+		if (failed(_enumerator->RegisterEndpointNotificationCallback(&noti_client)))
+		{
+			Log::Error("WASAPI : RegisterEndpointNotificationCallback error.");
+		}
+
+		// the render thread prefills and starts the client
+		FinalizeAudioDevice(&_wasapi_device);
+		default_render_device_changed = false;
+
+		_thread_terminated = false;
+		_thread = std::thread(&AudioDriver_WASAPI::ThreadFunc, this);
 
 		return true;
 	}
 
 	void AudioDriver_WASAPI::Finalize(void)
 	{
+		if (!_thread.joinable()) return;
+
+		_thread_terminated = true;
+		::SetEvent(_buffer_event);
+		_thread.join();
+
+		_enumerator->UnregisterEndpointNotificationCallback(&noti_client);
+		_enumerator.Reset();
+
+		::CloseHandle(_buffer_event);
+		_buffer_event = nullptr;
+
+		Log::Info(PRIZM_FMT("WASAPI closed, {} underruns, {} glitches."), GetUnderrunCount(), GetGlitchCount());
+
 		::CoUninitialize();
 	}
-}
\ No newline at end of file
+}
@@ -2,6 +2,8 @@
 
 #include<string>
 #include<vector>
+#include<atomic>
+#include<thread>
 
 #include<audioclient.h>
 #include<mmdeviceapi.h>
@@ -12,6 +14,7 @@
 
 namespace Prizm
 {
+	// shared mode, event driven, the render thread fills what the engine consumed each period
 	class AudioDriver_WASAPI : public AudioDriver
 	{
 	private:
@@ -41,18 +44,33 @@ namespace Prizm
 		};
 
 		WASAPI_Device _wasapi_device;
-		unsigned int _channels;
+		Microsoft::WRL::ComPtr<IMMDeviceEnumerator> _enumerator;
 		int _buffer_frames;
-		int _mix_rate;
-		std::vector<int> _samples;
-		bool _thread_terminated;
+		int _period_frames;
+		// stereo mix of one pull
+		std::vector<float> _samples;
 
-		//static void thread_func(void);
+		// signaled by the engine every period
+		HANDLE _buffer_event;
+		std::thread _thread;
+		std::atomic<bool> _thread_terminated;
+
+		void ThreadFunc(void);
+
+		// mixes frames and converts them to the device format
+		void WriteFrames(BYTE* data, unsigned int frames);
+
+		// after the default device changed or the current one went away
+		bool ResetRenderDevice(void);
 
 	public:
+		AudioDriver_WASAPI(void);
+		~AudioDriver_WASAPI(void);
+
 		bool InitializeAudioDevice(WASAPI_Device* w_device, bool do_capture);
+		void FinalizeAudioDevice(WASAPI_Device* w_device);
 		bool InitializeRenderDevice(void);
-		bool Initialize(void);
-		void Finalize(void);
+		bool Initialize(void) override;
+		void Finalize(void) override;
 	};
-}
\ No newline at end of file
+}
@@ -1,11 +1,15 @@
 
-#include <Windows.h>
+#include<cstdlib>
 
 #include"BaseSystem.h"
 #include"GameManager.h"
+#include"GameTime.h"
 #include"..\Input\Input.h"
+#include"..\Input\InputRecorder.h"
 #include"..\Utilities\Utils.h"
 #include"..\Utilities\Log.h"
+#include"..\Utilities\Platform.h"
+#include"..\Utilities\PerfTimer.h"
 #include"..\Graphics\Window.h"
 
 #pragma comment(lib, "Input.lib")
@@ -13,7 +17,9 @@
 #pragma comment(lib, "Framework.lib")
 #pragma comment(lib, "Graphics.lib")
 
+#ifdef _MSC_VER
 #include <crtdbg.h>
+#endif
 
 namespace Prizm
 {
@@ -21,34 +27,47 @@ namespace Prizm
 	{
 	public:
 		Impl() : _app_exit(false)
-			   , _input_module(nullptr)
+			   , _options{ false, 0 }
 			   , _game_manager(std::make_unique<GameManager>()){}
 
 		bool _app_exit;
-		HMODULE _input_module;
+		LaunchOptions _options;
 		std::unique_ptr<GameManager> _game_manager;
 
 		void MessageLoop(void)
 		{
-			MSG msg = {};
+			unsigned int frame_count = 0;
+			const auto begin_time = PerfTimer::Now();
 
 			while (!_app_exit)
 			{
-				if (PeekMessageA(&msg, nullptr, 0, 0, PM_REMOVE))
+				// the wait comes before the pump and PreStateUpdate, input is not latched and then slept on
+				_game_manager->WaitForNextFrame();
+
+				if (!Window::PumpMessages())
 				{
-					TranslateMessage(&msg);
-					DispatchMessageA(&msg);
+					_app_exit = true;
+					break;
 				}
 
-				if (Input::IsKeyTriggered("escape"))
+				Input::PreStateUpdate();
+
+				if (InputRecorder::IsReplayFinished())
+				{
+					_app_exit = true;
+					break;
+				}
+
+				if (Input::IsKeyTriggered(PRIZM_KEY("escape")))
 				{
 					if (Input::IsMouseCaptured())
 					{
-						Input::CaptureMouse(Window::GetWindowHandle(), false);
+						Input::CaptureMouse(Window::GetNativeHandle(), false);
 					}
 					else
 					{
-						if (MessageBoxA(Window::GetWindowHandle(), "Quit ?", "User Notification", MB_YESNO | MB_DEFBUTTON2) == IDYES)
+						// the recorded session quit here, nobody is there to answer
+						if (InputRecorder::IsReplaying() || Platform::Confirm(Window::GetNativeHandle(), "User Notification", "Quit ?"))
 						{
 							Log::Info("[EXIT] KEY DOWN ESC");
 							_app_exit = true;
@@ -56,39 +75,97 @@ namespace Prizm
 					}
 				}
 
-				if (msg.message == WM_QUIT)
+				_app_exit |= _game_manager->Run();
+
+				++frame_count;
+
+				if (_options.frame_limit && frame_count >= _options.frame_limit)
 				{
+					Log::Info(PRIZM_FMT("[EXIT] frame limit {} reached"), _options.frame_limit);
 					_app_exit = true;
 				}
-				else
-				{
-					_app_exit |= _game_manager->Run();
-				}
 
 				Input::PostStateUpdate();
 			}
+
+			if (InputRecorder::IsReplaying())
+			{
+				const double seconds = (PerfTimer::Now() - begin_time) * 1e-9;
+
+				Log::Info(PRIZM_FMT("[REPLAY] {} frames in {:.3f} s, {:.3f} ms per frame, {} steps at {:.4f} ms each."),
+					frame_count, seconds, frame_count ? seconds * 1000.0 / frame_count : 0.0,
+					GameTime::GetStepCount(), GameTime::GetStepStats().GetMeanMs());
+			}
 		}
 	};
 
+	LaunchOptions ParseLaunchOptions(int argc, char** argv)
+	{
+		LaunchOptions options = { false, 0 };
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+
+			if (arg == "--headless") options.headless = true;
+			else if (arg == "--frames" && i + 1 < argc) options.frame_limit = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+			else if (arg == "--record" && i + 1 < argc) options.record_path = argv[++i];
+			else if (arg == "--replay" && i + 1 < argc) options.replay_path = argv[++i];
+			else if (arg == "--audio" && i + 1 < argc) options.audio.backend = argv[++i];
+			else if (arg == "--audio-file" && i + 1 < argc) options.audio.file_path = argv[++i];
+			else if (arg == "--audio-fast") options.audio.realtime = false;
+		}
+
+		return options;
+	}
+
 	BaseSystem::BaseSystem() : _impl(std::make_unique<Impl>()) {}
 
 	BaseSystem::~BaseSystem() { Log::Info("~BaseSystem()"); }
 	// = default;
 
-	bool BaseSystem::Initialize(void)
+	bool BaseSystem::Initialize(const LaunchOptions& options)
 	{
+#ifdef _MSC_VER
 		_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
 
-		std::string workspace_directory = DirectoryUtils::GetSpecialFolderPath(DirectoryUtils::FolderType::APPDATA) + "\\PrizmEngine";
+		_impl->_options = options;
+
+		std::string workspace_directory = DirectoryUtils::GetSpecialFolderPath(DirectoryUtils::FolderType::APPDATA) + Platform::PATH_SEPARATOR + "PrizmEngine";
 
 #ifdef _DEBUG
 		Log::Initialize(Log::LogMode::CONSOLE, workspace_directory);
+#else
+		// structured and cheap enough to leave on, Tools\LogDecoder turns it back into text
+		Log::Initialize(Log::LogMode::BINARY_FILE, workspace_directory);
 #endif
 		Input::Initialize();
 
-		if (!Window::Initialize()) return false;
+		// a replay has no use for a window, the recording is the only input
+		const bool headless = options.headless || !options.replay_path.empty();
+
+		if (!Window::Initialize(headless ? Window::HEADLESS : Window::WINDOWED)) return false;
 
-		if (!_impl->_game_manager->Initialize(Window::GetWindowHandle())) return false;
+		// no window, no listener, a machine without a sound card should run the same
+		AudioDriver::Options audio_options = options.audio;
+		if (headless && audio_options.backend.empty()) audio_options.backend = "null";
+		AudioDriver::Configure(audio_options);
+
+		if (!_impl->_game_manager->Initialize(Window::GetNativeHandle())) return false;
+
+		// started last so loading is not part of the recording
+		if (!options.replay_path.empty())
+		{
+			double simulation_hz;
+			if (!InputRecorder::BeginReplay(options.replay_path, simulation_hz)) return false;
+
+			GameTime::SetSimulationRate(simulation_hz);
+		}
+		else if (!options.record_path.empty())
+		{
+			InputRecorder::BeginRecording(options.record_path, GameTime::GetSimulationRate());
+		}
 
 		return true;
 	}
@@ -100,6 +177,9 @@ namespace Prizm
 
 	void BaseSystem::Finalize(void)
 	{
+		InputRecorder::EndRecording();
+		InputRecorder::EndReplay();
+
 		Log::Finalize();
 
 		Window::Finalize();
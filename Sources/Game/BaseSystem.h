@@ -3,8 +3,23 @@
 #include<memory>
 #include<string>
 
+#include"AudioDriver\AudioDriver.h"
+
 namespace Prizm
 {
+	struct LaunchOptions
+	{
+		bool headless;				// no visible window and no input, see Window::HEADLESS
+		unsigned int frame_limit;	// quit after this many frames, 0 = run until asked to quit
+		std::string record_path;	// input recording written while playing, see Input/InputRecorder.h
+		std::string replay_path;	// input recording played back headless at full speed, quits at its end
+		AudioDriver::Options audio;	// output backend, headless runs default to the null driver
+	};
+
+	// --headless, --frames N, --record path, --replay path,
+	// --audio wasapi|rtaudio|alsa|pulse|jack|null, --audio-file path, --audio-fast
+	LaunchOptions ParseLaunchOptions(int argc, char** argv);
+
 	class BaseSystem final
 	{
 	private:
@@ -15,7 +30,7 @@ namespace Prizm
 		BaseSystem();
 		~BaseSystem();
 
-		bool Initialize(void);
+		bool Initialize(const LaunchOptions&);
 		void Run(void);
 		void Finalize(void);
 	};
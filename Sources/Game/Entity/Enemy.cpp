@@ -6,7 +6,8 @@
 #include"..\..\Graphics\Geometry.h"
 #include"..\..\Graphics\GeometryGenerator.h"
 #include"..\..\Graphics\Window.h"
-#include"..\..\Input\Input.h"
+#include"..\..\Input\InputAction.h"
+#include"..\GameTime.h"
 
 namespace Prizm
 {
@@ -18,9 +19,19 @@ namespace Prizm
 		std::shared_ptr<Shader> _shader;
 		std::shared_ptr<Texture> _texture;
 
+		// simulation state, rendered in between by GameTime::GetInterpolation
 		DirectX::SimpleMath::Vector2 _position;
+		DirectX::SimpleMath::Vector2 _prev_position;
+		DirectX::SimpleMath::Vector2 _drawn_position;	// where the geometry currently is
+
+		// bound in GameManager or Resources\input_bindings.txt
+		Input::ActionId _move_x;
+		Input::ActionId _move_y;
 	};
 
+	// pixels per second
+	constexpr float ENEMY_MOVE_SPEED = 240.0f;
+
 	Enemy::Enemy(void) : _impl(std::make_unique<Impl>()) {}
 	Enemy::~Enemy(void) = default;
 
@@ -28,28 +39,32 @@ namespace Prizm
 	{
 		_impl->_geometry = std::make_unique<Geometry>(GeometryGenerator::Quad2D(64.f, 64.f, 0, 0));
 		_impl->_position = DirectX::SimpleMath::Vector2(0, 0);
+		_impl->_prev_position = _impl->_position;
+		_impl->_drawn_position = _impl->_position;
+
+		_impl->_move_x = Input::RegisterAction("EnemyMoveX");
+		_impl->_move_y = Input::RegisterAction("EnemyMoveY");
 
 		return true;
 	}
 
 	void Enemy::Run(void)
 	{
-		if (Input::IsKeyPress("Up"))
-			MovePosition(0, 1);
+	}
 
-		if (Input::IsKeyPress("Left"))
-			MovePosition(-1, 0);
+	void Enemy::FixedRun(float dt)
+	{
+		_impl->_prev_position = _impl->_position;
 
-		if (Input::IsKeyPress("Down"))
-			MovePosition(0, -1);
+		const float distance = ENEMY_MOVE_SPEED * dt;
 
-		if (Input::IsKeyPress("Right"))
-			MovePosition(1, 0);
+		_impl->_position.x += distance * Input::ActionAxis(_impl->_move_x);
+		_impl->_position.y += distance * Input::ActionAxis(_impl->_move_y);
 	}
 
 	void Enemy::Draw(void)
 	{
-		Microsoft::WRL::ComPtr<ID3D11DeviceContext> device_context = Graphics::GetDeviceContext();
+		auto& device_context = Graphics::GetDeviceContext();
 
 		_impl->_shader->SetInputLayout(device_context);
 		_impl->_shader->SetShader(device_context, ShaderType::VS);
@@ -63,6 +78,16 @@ namespace Prizm
 
 		device_context->PSSetSamplers(0, 1, Graphics::GetSamplerState(SamplerStateType::LINEAR_FILTER_SAMPLER).GetAddressOf());
 
+		// render between the last two simulation states
+		DirectX::SimpleMath::Vector2 render_position;
+		DirectX::SimpleMath::Vector2::Lerp(_impl->_prev_position, _impl->_position, GameTime::GetInterpolation(), render_position);
+
+		if (render_position != _impl->_drawn_position)
+		{
+			_impl->_geometry->MovePosition2DScreenToRatio(render_position.x - _impl->_drawn_position.x, render_position.y - _impl->_drawn_position.y);
+			_impl->_drawn_position = render_position;
+		}
+
 		_impl->_geometry->Draw(device_context);
 	}
 
@@ -85,9 +110,12 @@ namespace Prizm
 
 	void Enemy::MovePosition(float x, float y)
 	{
-		_impl->_geometry->MovePosition2DScreenToRatio(x, y);
 		_impl->_position.x += x;
 		_impl->_position.y += y;
+
+		_impl->_geometry->MovePosition2DScreenToRatio(_impl->_position.x - _impl->_drawn_position.x, _impl->_position.y - _impl->_drawn_position.y);
+		_impl->_prev_position = _impl->_position;
+		_impl->_drawn_position = _impl->_position;
 	}
 	DirectX::SimpleMath::Vector2 & Enemy::GetPosition(void)
 	{
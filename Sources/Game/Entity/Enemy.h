@@ -22,12 +22,14 @@ namespace Prizm
 
 		bool Initialize() override;
 		void Run(void) override;
+		void FixedRun(float) override;
 		void Draw(void) override;
 		void Finalize(void) override;
 
 		void LoadShader(const std::shared_ptr<Shader>&);
 		void LoadTexture(const std::shared_ptr<Texture>&);
 
+		// teleport, not interpolated
 		void MovePosition(float x, float y);
 		DirectX::SimpleMath::Vector2& GetPosition(void);
 	};
@@ -38,7 +38,7 @@ namespace Prizm
 
 	void UI::Draw(void)
 	{
-		Microsoft::WRL::ComPtr<ID3D11DeviceContext> device_context = Graphics::GetDeviceContext();
+		auto& device_context = Graphics::GetDeviceContext();
 
 		_impl->_shader->SetInputLayout(device_context);
 		_impl->_shader->SetShader(device_context, ShaderType::VS);
@@ -1,11 +1,27 @@
+#include"BaseSystem.h"
+
+namespace
+{
+	int Run(int argc, char** argv)
+	{
+		Prizm::BaseSystem app;
+		if (app.Initialize(Prizm::ParseLaunchOptions(argc, argv))) app.Run();
+		app.Finalize();
+		return 0;
+	}
+}
 
+#ifdef _WIN32
 #include<windows.h>
-#include"BaseSystem.h"
+#include<cstdlib>
 
 int __stdcall WinMain(HINSTANCE, HINSTANCE, LPSTR, int)
 {
-	Prizm::BaseSystem app;
-	if (app.Initialize()) app.Run();
-	app.Finalize();
-	return 0;
-}
\ No newline at end of file
+	return Run(__argc, __argv);
+}
+#else
+int main(int argc, char** argv)
+{
+	return Run(argc, argv);
+}
+#endif
\ No newline at end of file
@@ -3,69 +3,238 @@
 #include"ImguiManager.h"
 #include"..\Graphics\Graphics.h"
 #include"SceneManager.h"
+#include"AssetCache.h"
+#include"GameTime.h"
 #include"Scenes\MainGameScene.h"
 //#include"Adx2le\AudioDriver_Adx2le.h"
 #include"..\Graphics\Window.h"
 
 #include"..\Utilities\Log.h"
+#include"..\Utilities\Utils.h"
+#include"..\Utilities\AssetManifest.h"
+#include"..\Utilities\FrameArena.h"
+#include"..\Utilities\Memory.h"
+#include"..\Utilities\Profiler.h"
+#include"..\Utilities\FramePacer.h"
 #include"..\Input\Input.h"
+#include"..\Input\InputAction.h"
+#include"..\Input\InputRecorder.h"
+#include"Resource.h"
 
 namespace Prizm
 {
+	// heap budgets per subsystem, exceeding one logs a warning
+	constexpr std::uint64_t GRAPHICS_MEMORY_BUDGET = 64 * 1024 * 1024;
+	constexpr std::uint64_t AUDIO_MEMORY_BUDGET = 32 * 1024 * 1024;
+	constexpr std::uint64_t SCENE_MEMORY_BUDGET = 32 * 1024 * 1024;
+	constexpr std::uint64_t ASSETS_MEMORY_BUDGET = 128 * 1024 * 1024;
+	constexpr std::uint64_t IMGUI_MEMORY_BUDGET = 8 * 1024 * 1024;
+
+	// fixed simulation rate, rendering runs as fast as it can and interpolates
+	constexpr double SIMULATION_HZ = 60.0;
+
+	// optional render cap toggled with F3, off by default
+	constexpr double FRAME_RATE_CAP = 120.0;
+
+	// a bindings file next to the resources replaces these, see Input/InputAction.h
+	const std::string INPUT_BINDINGS_FILE_NAME = "input_bindings.txt";
+
+	void BindDefaultInput(void)
+	{
+		const auto player_x = Input::RegisterAction("PlayerMoveX");
+		const auto player_y = Input::RegisterAction("PlayerMoveY");
+		const auto enemy_x = Input::RegisterAction("EnemyMoveX");
+		const auto enemy_y = Input::RegisterAction("EnemyMoveY");
+
+		Input::BindAxis(player_x, PRIZM_KEY("A"), PRIZM_KEY("D"));
+		Input::BindAxis(player_y, PRIZM_KEY("S"), PRIZM_KEY("W"));
+		Input::BindAnalog(player_x, Input::PAD_LEFT_X, 1.0f);
+		Input::BindAnalog(player_y, Input::PAD_LEFT_Y, 1.0f);
+
+		Input::BindAxis(enemy_x, PRIZM_KEY("Left"), PRIZM_KEY("Right"));
+		Input::BindAxis(enemy_y, PRIZM_KEY("Down"), PRIZM_KEY("Up"));
+		Input::BindAnalog(enemy_x, Input::PAD_RIGHT_X, 1.0f);
+		Input::BindAnalog(enemy_y, Input::PAD_RIGHT_Y, 1.0f);
+
+		if (!Input::LoadBindings(RESOURCE_DIR + INPUT_BINDINGS_FILE_NAME))
+			Log::Info("No input bindings file, using the defaults.");
+	}
+
 	class GameManager::Impl
 	{
 	public:
 		bool want_exit_;
 		std::unique_ptr<SceneManager> _scene_manager;
 		std::unique_ptr<ImguiManager> _imgui_manager;
+		FramePacer _frame_pacer;
 
-		Impl() : want_exit_(false){}
+		// heap allocations per frame, averaged over ALLOCATION_REPORT_FRAMES
+		static constexpr unsigned int ALLOCATION_REPORT_FRAMES = 600;
+		std::uint64_t _allocations_at_report;
+		unsigned int _frames_since_report;
+
+		Impl() : want_exit_(false), _allocations_at_report(0), _frames_since_report(0){}
+
+		void ReportAllocations(void)
+		{
+			if (++_frames_since_report < ALLOCATION_REPORT_FRAMES) return;
+
+			const auto allocations = Memory::GetAllocationCount();
+			const double per_frame = static_cast<double>(allocations - _allocations_at_report) / _frames_since_report;
+
+			Log::Info(PRIZM_FMT("Heap allocations per frame: {:.2f} (frame arena {}, {} KB high water)"),
+				per_frame, FrameArena::IsEnabled() ? "on" : "off", FrameArena::ThreadLocal().GetHighWater() / 1024);
+
+			_allocations_at_report = allocations;
+			_frames_since_report = 0;
+		}
 	};
 
 	GameManager::GameManager() : _impl(std::make_unique<Impl>()){}
 
 	GameManager::~GameManager() = default;
 
-	bool GameManager::Initialize(HWND window_handle)
+	bool GameManager::Initialize(void* native_window)
 	{
-		if (!Graphics::Initialize(window_width<int>, window_height<int>, false, window_handle, false))
-			return false;
+		Profiler::SetThreadName("Main");
+
+		{
+			Memory::TagScope tag(Memory::GRAPHICS);
+
+			if (!Graphics::Initialize(window_width<int>, window_height<int>, false, static_cast<HWND>(native_window), false))
+				return false;
+		}
+
+		Memory::SetBudget(Memory::GRAPHICS, GRAPHICS_MEMORY_BUDGET);
+		Memory::SetBudget(Memory::AUDIO, AUDIO_MEMORY_BUDGET);
+		Memory::SetBudget(Memory::SCENE, SCENE_MEMORY_BUDGET);
+		Memory::SetBudget(Memory::ASSETS, ASSETS_MEMORY_BUDGET);
+		Memory::SetBudget(Memory::IMGUI, IMGUI_MEMORY_BUDGET);
+
+		// cooked assets are optional, loaders fall back to the raw sources
+		if (AssetManifest::Runtime().Load(RESOURCE_DIR + COOKED_DIR_NAME + MANIFEST_FILE_NAME))
+			Log::Info("Asset manifest loaded, " + std::to_string(AssetManifest::Runtime().Size()) + " cooked assets.");
+		else
+			Log::Info("No asset manifest found, assets are loaded from sources.");
+
+		BindDefaultInput();
 
 		_impl->_scene_manager = std::make_unique<SceneManager>();
 		_impl->_scene_manager->SetNextScene<MainGameScene>();
 
 		_impl->_imgui_manager = std::make_unique<ImguiManager>();
 		_impl->_imgui_manager->Initialize();
+		_impl->_imgui_manager->SetFramePacer(&_impl->_frame_pacer);
+		Input::SetFramePacer(&_impl->_frame_pacer);
+
+		// start the clock last so loading time is not simulated
+		GameTime::Initialize(SIMULATION_HZ);
 
 		return true;
 	}
 
+	void GameManager::WaitForNextFrame(void)
+	{
+		PRIZM_ZONE("FramePacer::Wait");
+
+		// sleep first, then sample, the input is as fresh as possible at present
+		Graphics::WaitForFrameLatency();
+
+		// a replay is a benchmark, no cap
+		if (!InputRecorder::IsReplaying()) _impl->_frame_pacer.WaitForNextFrame();
+	}
+
 	bool GameManager::Run(void)
 	{
-		if (Input::IsKeyTriggered("F9"))
+		if (Input::IsKeyTriggered(PRIZM_KEY("F3")))
+		{// frame rate cap on / off
+			_impl->_frame_pacer.SetTargetFrameRate(_impl->_frame_pacer.GetTargetFrameRate() > 0.0 ? 0.0 : FRAME_RATE_CAP);
+		}
+
+		if (Input::IsKeyTriggered(PRIZM_KEY("F6")))
+		{// profiler capture on / off, written next to the executable
+			if (Profiler::IsCapturing())
+				Profiler::EndCapture("profile_" + StrUtils::Time::GetCurrentTimeAsString());
+			else
+				Profiler::BeginCapture();
+		}
+
+		if (Input::IsKeyTriggered(PRIZM_KEY("F8")))
+		{// compare heap allocations with and without the frame arena
+			FrameArena::SetEnabled(!FrameArena::IsEnabled());
+		}
+
+		if (Input::IsKeyTriggered(PRIZM_KEY("F9")))
 		{// change fullscreen
 			//Graphics::ChangeWindowMode();
 		}
 
-		// scene update
-		_impl->_imgui_manager->BeginFrame();
-
-		if (_impl->_scene_manager->Update())
 		{
-			// scene draw
-			Graphics::BeginFrame();
-			_impl->_scene_manager->Draw();
-			_impl->_imgui_manager->EndFrame();
-			Graphics::EndFrame();
+			PRIZM_ZONE("GameManager::Run");
+
+			{
+				PRIZM_ZONE("ImGui::BeginFrame");
+				_impl->_imgui_manager->BeginFrame();
+			}
+
+			// scene update
+			bool updated = false;
+			{
+				PRIZM_ZONE("Scene::Update");
+				Memory::TagScope tag(Memory::SCENE);
+
+				const auto steps = GameTime::Advance();
+				for (unsigned int i = 0; i < steps; ++i)
+				{
+					ScopedTimer step_timer(GameTime::GetStepStats());
+					_impl->_scene_manager->FixedUpdate(GameTime::GetFixedDeltaTime());
+				}
+
+				updated = _impl->_scene_manager->Update();
+			}
+
+			if (updated)
+			{
+				// scene draw
+				Memory::TagScope tag(Memory::GRAPHICS);
+
+				{
+					PRIZM_ZONE("Scene::Draw");
+					Graphics::BeginFrame();
+					_impl->_scene_manager->Draw();
+				}
+
+				{
+					PRIZM_ZONE("ImGui::EndFrame");
+					_impl->_imgui_manager->EndFrame();
+				}
+
+				{
+					PRIZM_ZONE("Graphics::EndFrame");
+					Graphics::EndFrame();
+					_impl->_frame_pacer.MarkPresented();
+				}
+			}
+
+			Memory::NextFrame();
+			_impl->ReportAllocations();
 		}
 
+		Profiler::NextFrame();
+
 		return _impl->want_exit_;
 	}
 
 	void GameManager::Finalize(void)
 	{
+		Input::SetFramePacer(nullptr);
+
 		_impl->_imgui_manager->Finalize();
 		_impl->_scene_manager->Finalize();
+		_impl->_scene_manager.reset();
+
+		// unreferenced assets hold device objects, drop them before the device
+		AssetCache::Global().Clear();
 		Graphics::Finalize();
 	}
 }
\ No newline at end of file
@@ -1,6 +1,5 @@
 #pragma once
 
-#include<windows.h>
 #include<memory>
 
 namespace Prizm
@@ -17,7 +16,12 @@ namespace Prizm
 		GameManager(void);
 		~GameManager(void);
 
-		bool Initialize(HWND);
+		// native_window is Window::GetNativeHandle()
+		bool Initialize(void* native_window);
+
+		// frame cap and swap chain wait, before the loop pumps messages and samples input
+		void WaitForNextFrame(void);
+
 		bool Run(void);
 		void Finalize(void);
 	};
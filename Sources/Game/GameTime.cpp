@@ -0,0 +1,108 @@
+
+#include<algorithm>
+
+#include"GameTime.h"
+#include"../Utilities/PerfTimer.h"
+#include"../Utilities/Log.h"
+#include"../Input/InputRecorder.h"
+
+namespace Prizm
+{
+	namespace GameTime
+	{
+		// nanoseconds, integer so the accumulator does not drift over long sessions
+		using Nanoseconds = PerfTimer::Nanoseconds;
+
+		PerfTimer     _timer;
+		TimerStats    _step_stats;
+		double        _simulation_hz = DEFAULT_SIMULATION_HZ;
+		Nanoseconds   _step = static_cast<Nanoseconds>(1e9 / DEFAULT_SIMULATION_HZ);
+		Nanoseconds   _accumulator = 0;
+		Nanoseconds   _dropped_time = 0;
+		Nanoseconds   _delta_time = 0;
+		float         _interpolation = 0.0f;
+		std::uint64_t _step_count = 0;
+
+		void Initialize(double simulation_hz)
+		{
+			SetSimulationRate(simulation_hz);
+
+			_accumulator = 0;
+			_dropped_time = 0;
+			_delta_time = 0;
+			_interpolation = 0.0f;
+			_step_count = 0;
+			_step_stats.Reset();
+
+			_timer.Reset();
+			_timer.Start();
+
+			Log::Info("Simulation rate " + std::to_string(_simulation_hz) + " Hz.");
+		}
+
+		void SetSimulationRate(double hz)
+		{
+			if (hz <= 0.0)
+			{
+				Log::Warning("Invalid simulation rate " + std::to_string(hz) + ", keeping " + std::to_string(_simulation_hz) + " Hz.");
+				return;
+			}
+
+			_simulation_hz = hz;
+			_step = static_cast<Nanoseconds>(1e9 / hz);
+		}
+
+		double GetSimulationRate(void) { return _simulation_hz; }
+
+		unsigned int Advance(void)
+		{
+			_delta_time = _timer.TickNanoseconds();
+
+			if (InputRecorder::IsReplaying())
+			{// the recorded step count instead of the clock, the replay runs as fast as the machine allows
+				const unsigned int steps = InputRecorder::ReadSteps();
+
+				_step_count += steps;
+				_interpolation = 1.0f;
+				return steps;
+			}
+
+			_accumulator += _delta_time;
+
+			const Nanoseconds max_accumulated = _step * MAX_STEPS_PER_FRAME;
+
+			if (_accumulator > max_accumulated)
+			{// too slow to catch up (or a hitch such as a blocking load), let the simulation fall behind
+				_dropped_time += _accumulator - max_accumulated;
+				_accumulator = max_accumulated;
+			}
+
+			unsigned int steps = 0;
+
+			while (_accumulator >= _step)
+			{
+				_accumulator -= _step;
+				++steps;
+			}
+
+			_step_count += steps;
+			_interpolation = static_cast<float>(static_cast<double>(_accumulator) / _step);
+
+			if (InputRecorder::IsRecording()) InputRecorder::WriteSteps(steps);
+
+			return steps;
+		}
+
+		float GetFixedDeltaTime(void) { return static_cast<float>(_step * 1e-9); }
+
+		float GetDeltaTime(void) { return static_cast<float>(_delta_time * 1e-9); }
+
+		float GetInterpolation(void) { return _interpolation; }
+
+		std::uint64_t GetStepCount(void) { return _step_count; }
+
+		double GetDroppedTime(void) { return _dropped_time * 1e-9; }
+
+		TimerStats& GetStepStats(void) { return _step_stats; }
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include<cstdint>
+
+#include"../Utilities/PerfTimer.h"
+
+namespace Prizm
+{
+	// fixed timestep clock, the simulation runs at a fixed rate independent of the render rate
+	// GameManager calls Advance once per frame and runs the returned number of fixed steps
+	namespace GameTime
+	{
+		constexpr double DEFAULT_SIMULATION_HZ = 60.0;
+
+		// spiral-of-death guard, time beyond this many steps per frame is dropped
+		constexpr unsigned int MAX_STEPS_PER_FRAME = 5;
+
+		void Initialize(double simulation_hz = DEFAULT_SIMULATION_HZ);
+
+		void SetSimulationRate(double hz);
+		double GetSimulationRate(void);
+
+		// measure the frame, return the number of fixed steps to run this frame
+		// while an input recording is replayed the recorded count is returned instead
+		unsigned int Advance(void);
+
+		// seconds per fixed step
+		float GetFixedDeltaTime(void);
+
+		// seconds since the last frame, before clamping
+		float GetDeltaTime(void);
+
+		// 0 - 1, how far the render time is between the previous and the current simulation state
+		float GetInterpolation(void);
+
+		std::uint64_t GetStepCount(void);
+
+		// seconds discarded by the spiral-of-death guard since Initialize
+		double GetDroppedTime(void);
+
+		// cost of one fixed step, fed by GameManager
+		TimerStats& GetStepStats(void);
+	}
+}
@@ -1,11 +1,22 @@
 ﻿
+#include<array>
+#include<cstdio>
+#include<vector>
+#include<algorithm>
+
 #include"ImguiManager.h"
 #include"ImGui/imgui.h"
 #include"ImGui/imgui_impl_win32.h"
 #include"ImGui/imgui_impl_dx11.h"
 #include"Resource.h"
+#include"GameTime.h"
 #include"..\Graphics\Graphics.h"
 #include"..\Input\Input.h"
+#include"..\Input\InputAction.h"
+#include"..\Utilities\Memory.h"
+#include"..\Utilities\Profiler.h"
+#include"..\Utilities\FramePacer.h"
+#include"..\Utilities\Utils.h"
 
 namespace Prizm
 {
@@ -17,6 +28,194 @@ namespace Prizm
 		{}
 
 		ImVec4 _clear_color;
+		bool _show_memory = false;
+		bool _show_hud = false;
+		const FramePacer* _frame_pacer = nullptr;
+
+		// frame times in ms, ring written every frame so the graph is full when the HUD opens
+		static constexpr std::size_t FRAME_HISTORY = 240;
+		std::array<float, FRAME_HISTORY> _frame_times = {};
+		std::size_t _frame_cursor = 0;
+
+		void RecordFrameTime(float ms)
+		{
+			_frame_times[_frame_cursor] = ms;
+			_frame_cursor = (_frame_cursor + 1) % FRAME_HISTORY;
+		}
+
+		void DrawPerformanceHud(void)
+		{
+			ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+			ImGui::SetNextWindowBgAlpha(0.6f);
+			ImGui::Begin("Performance", &_show_hud, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing);
+
+			// percentiles over the history, sorted copy only while visible
+			auto sorted = _frame_times;
+			auto percentile = [&sorted](float p)
+			{
+				auto nth = sorted.begin() + static_cast<std::size_t>(p * (FRAME_HISTORY - 1));
+				std::nth_element(sorted.begin(), nth, sorted.end());
+				return *nth;
+			};
+
+			const float p50 = percentile(0.50f);
+			const float p95 = percentile(0.95f);
+			const float p99 = percentile(0.99f);
+			const float max_ms = *std::max_element(sorted.begin(), sorted.end());
+
+			char overlay[64];
+			snprintf(overlay, sizeof(overlay), "%.2f ms", _frame_times[(_frame_cursor + FRAME_HISTORY - 1) % FRAME_HISTORY]);
+			ImGui::PlotLines("##frame_times", _frame_times.data(), static_cast<int>(FRAME_HISTORY), static_cast<int>(_frame_cursor),
+				overlay, 0.0f, (std::max)(max_ms, 33.3f), ImVec2(480, 80));
+			ImGui::Text("p50 %.2f ms  p95 %.2f ms  p99 %.2f ms  max %.2f ms", p50, p95, p99, max_ms);
+			ImGui::Text("Simulation %.0f Hz  steps %llu  dropped %.2f s", GameTime::GetSimulationRate(), GameTime::GetStepCount(), GameTime::GetDroppedTime());
+
+			const auto& step_stats = GameTime::GetStepStats();
+			ImGui::Text("Step cost mean %.3f ms  ema %.3f ms  max %.3f ms", step_stats.GetMeanMs(), step_stats.GetEmaMs(), step_stats.GetMaxMs());
+
+			const double frame_ms = Profiler::GetFrameMs();
+			const auto& zones = Profiler::GetFrameStats();
+			const auto main_thread = Profiler::GetThreadIndex();
+
+			if (ImGui::CollapsingHeader("Stages", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				for (auto& zone : zones)
+				{
+					if (zone.thread_id != main_thread) continue;
+
+					ImGui::Text("%*s%-24s %7.3f ms  x%u", zone.depth * 2, "", zone.name, zone.total_ms, zone.calls);
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Threads", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				// busy time is the sum of outermost zones, so uninstrumented work counts as idle
+				std::vector<std::pair<std::uint32_t, double>> busy;
+
+				for (auto& zone : zones)
+				{
+					if (zone.depth != 0) continue;
+
+					auto it = std::find_if(busy.begin(), busy.end(), [&zone](const std::pair<std::uint32_t, double>& entry)
+					{
+						return entry.first == zone.thread_id;
+					});
+
+					if (it == busy.end())
+						busy.emplace_back(zone.thread_id, zone.total_ms);
+					else
+						it->second += zone.total_ms;
+				}
+
+				for (auto& entry : busy)
+				{
+					const float utilization = frame_ms > 0.0 ? static_cast<float>((std::min)(entry.second / frame_ms, 1.0)) : 0.0f;
+
+					snprintf(overlay, sizeof(overlay), "%.0f%%", utilization * 100.0f);
+					ImGui::ProgressBar(utilization, ImVec2(200, 0), overlay);
+					ImGui::SameLine();
+					ImGui::Text("%s", Profiler::GetThreadName(entry.first).c_str());
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Render", ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				const auto& render_stats = Graphics::GetRenderStats();
+				ImGui::Text("Draw calls %u  State changes %u", render_stats.draw_calls, render_stats.state_changes);
+				ImGui::Text("%s swap chain, max frame latency %u", Graphics::IsFlipModel() ? "Flip" : "Blt", Graphics::GetMaximumFrameLatency());
+
+				if (_frame_pacer)
+				{
+					const double cap = _frame_pacer->GetTargetFrameRate();
+
+					ImGui::Text("Input to present %.2f ms (avg %.2f ms)", _frame_pacer->GetLastLatencyMs(), _frame_pacer->GetAverageLatencyMs());
+
+					const auto& action_latency = Input::GetActionLatencyStats();
+					ImGui::Text("Input to simulation %.2f ms (avg %.2f ms, max %.2f ms)", action_latency.GetLastMs(), action_latency.GetMeanMs(), action_latency.GetMaxMs());
+					if (cap > 0.0)
+						ImGui::Text("Frame cap %.0f Hz, waited %.2f ms", cap, _frame_pacer->GetLastWaitMs());
+					else
+						ImGui::Text("Frame cap off");
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Memory"))
+			{
+				for (unsigned int i = 0; i < Memory::TAG_MAX; ++i)
+				{
+					auto tag = static_cast<Memory::Tag>(i);
+					auto stats = Memory::GetTagStats(tag);
+
+					ImGui::Text("%-10s %8llu KB  %5llu allocs/frame", Memory::GetTagName(tag), stats.live_bytes / 1024, stats.frame_allocations);
+				}
+			}
+
+			ImGui::End();
+		}
+
+		void DrawMemoryWindow(void)
+		{
+			ImGui::SetNextWindowSize(ImVec2(900, 520), ImGuiCond_FirstUseEver);
+			ImGui::Begin("Memory", &_show_memory);
+
+			ImGui::Columns(6, "memory_tags");
+			ImGui::Text("Tag"); ImGui::NextColumn();
+			ImGui::Text("Live KB"); ImGui::NextColumn();
+			ImGui::Text("Peak KB"); ImGui::NextColumn();
+			ImGui::Text("Allocs/frame"); ImGui::NextColumn();
+			ImGui::Text("KB/frame"); ImGui::NextColumn();
+			ImGui::Text("Budget KB"); ImGui::NextColumn();
+			ImGui::Separator();
+
+			for (unsigned int i = 0; i < Memory::TAG_MAX; ++i)
+			{
+				auto tag = static_cast<Memory::Tag>(i);
+				auto stats = Memory::GetTagStats(tag);
+				bool over_budget = stats.budget && stats.live_bytes > stats.budget;
+
+				if (over_budget) ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.3f, 0.3f, 1.0f));
+
+				ImGui::Text("%s", Memory::GetTagName(tag)); ImGui::NextColumn();
+				ImGui::Text("%llu", stats.live_bytes / 1024); ImGui::NextColumn();
+				ImGui::Text("%llu", stats.peak_bytes / 1024); ImGui::NextColumn();
+				ImGui::Text("%llu", stats.frame_allocations); ImGui::NextColumn();
+				ImGui::Text("%llu", stats.frame_bytes / 1024); ImGui::NextColumn();
+				ImGui::Text("%llu", stats.budget / 1024); ImGui::NextColumn();
+
+				if (over_budget) ImGui::PopStyleColor();
+			}
+
+			ImGui::Columns(1);
+			ImGui::Separator();
+
+			if (ImGui::Button("Dump CSV"))
+			{
+				Memory::DumpCsv("memory_" + StrUtils::Time::GetCurrentTimeAsString() + ".csv");
+			}
+
+			if (ImGui::CollapsingHeader("Top callsites"))
+			{
+				for (auto& callsite : Memory::GetTopCallsites(CALLSITE_ROWS))
+				{
+					ImGui::Text("%p  %10llu allocs  %10llu KB", callsite.address, callsite.allocation_count, callsite.bytes / 1024);
+				}
+			}
+
+			ImGui::End();
+		}
+
+		static constexpr std::size_t CALLSITE_ROWS = 20;
+
+		// ImGui allocates with malloc by default, route it through the tracker
+		static void* Allocate(size_t size, void*)
+		{
+			return Memory::Allocate(size, Memory::IMGUI, nullptr);
+		}
+
+		static void Free(void* ptr, void*)
+		{
+			Memory::Free(ptr);
+		}
 	};
 
 	ImguiManager::ImguiManager() : _impl(std::make_unique<Impl>()){}
@@ -25,6 +224,7 @@ namespace Prizm
 	void ImguiManager::Initialize(void)
 	{
 		// Setup ImGui binding
+		ImGui::SetAllocatorFunctions(&Impl::Allocate, &Impl::Free);
 		ImGui::CreateContext();
 
 		ImGuiIO& io = ImGui::GetIO();
@@ -43,6 +243,14 @@ namespace Prizm
 
 	void ImguiManager::BeginFrame(void)
 	{
+		if (Input::IsKeyTriggered(PRIZM_KEY("F2")))
+			_impl->_show_hud = !_impl->_show_hud;
+
+		if (Input::IsKeyTriggered(PRIZM_KEY("F7")))
+			_impl->_show_memory = !_impl->_show_memory;
+
+		_impl->RecordFrameTime(static_cast<float>(Profiler::GetFrameMs()));
+
 		ImGui_ImplDX11_NewFrame();
 		ImGui_ImplWin32_NewFrame();
 		ImGui::NewFrame();
@@ -50,6 +258,13 @@ namespace Prizm
 
 	void ImguiManager::EndFrame(void)
 	{
+		// hidden HUD costs only the frame time store above
+		if (_impl->_show_hud)
+			_impl->DrawPerformanceHud();
+
+		if (_impl->_show_memory)
+			_impl->DrawMemoryWindow();
+
 		ImGui::Render();
 		ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 	}
@@ -70,4 +285,9 @@ namespace Prizm
 		ImGui_ImplWin32_Shutdown();
 		ImGui::DestroyContext();
 	}
+
+	void ImguiManager::SetFramePacer(const FramePacer* frame_pacer)
+	{
+		_impl->_frame_pacer = frame_pacer;
+	}
 }
\ No newline at end of file
@@ -6,6 +6,8 @@
 
 namespace Prizm
 {
+	class FramePacer;
+
 	class ImguiManager
 	{
 	private:
@@ -22,5 +24,8 @@ namespace Prizm
 		void ResizeBegin(void);
 		void ResizeEnd(void);
 		void Finalize(void);
+
+		// latency shown in the performance HUD
+		void SetFramePacer(const FramePacer*);
 	};
 }
\ No newline at end of file
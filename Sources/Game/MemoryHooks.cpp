@@ -0,0 +1,74 @@
+
+#include<new>
+
+#include"../Utilities/Memory.h"
+
+// global operator new / delete replacement, lives in the executable so the linker always picks it up
+// plain standard C++, the same file works for the Linux build
+
+#ifdef _MSC_VER
+#include<intrin.h>
+#define PRIZM_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define PRIZM_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace
+{
+	void* Allocate(std::size_t size, const void* callsite)
+	{
+		return Prizm::Memory::Allocate(size ? size : 1, callsite);
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	if (void* ptr = Allocate(size, PRIZM_RETURN_ADDRESS())) return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	if (void* ptr = Allocate(size, PRIZM_RETURN_ADDRESS())) return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size, PRIZM_RETURN_ADDRESS());
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size, PRIZM_RETURN_ADDRESS());
+}
+
+void operator delete(void* ptr) noexcept
+{
+	Prizm::Memory::Free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	Prizm::Memory::Free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	Prizm::Memory::Free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+	Prizm::Memory::Free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	Prizm::Memory::Free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	Prizm::Memory::Free(ptr);
+}
@@ -1,9 +1,17 @@
 #pragma once
 
 #include<memory>
+#include<atomic>
+#include<thread>
+
+#include<Windows.h>
 
 #include"Scenes\BaseScene.h"
+#include"AssetCache.h"
+#include"SceneTransition.h"
 #include"..\Utilities\Log.h"
+#include"..\Utilities\Memory.h"
+#include"..\Utilities\Profiler.h"
 
 namespace Prizm
 {
@@ -11,44 +19,159 @@ namespace Prizm
 	{
 	private:
 		std::unique_ptr<BaseScene> _cur_scene;
+		std::unique_ptr<BaseScene> _next_scene;
+
+		std::thread _loader;
+		std::atomic<bool> _next_scene_ready;
+		std::atomic<BaseScene*> _loading_scene;		// published by the loader once constructed, for progress queries
+
+		// on fixed steps and recorded, see SceneTransition
+		SceneTransition _transition;
+
+		void SwapScene(void)
+		{
+			PRIZM_ZONE("SceneManager::SwapScene");
+
+			if (_loader.joinable())
+				_loader.join();
+
+			_cur_scene->Finalize();
+			_cur_scene = std::move(_next_scene);
+			_loading_scene = nullptr;
+			_cur_scene->LoadScene();
+
+			auto& cache = AssetCache::Global();
+			Log::Info(PRIZM_FMT("Scene changed. Asset cache {} hits, {} misses, {} KB retained."),
+				cache.GetHitCount(), cache.GetMissCount(), cache.GetRetainedBytes() / 1024);
+		}
+
+		// called before the scene update, so the swap never happens mid update / draw
+		// a replay may reach the swap before the loader has finished, SwapScene joins it
+		void UpdateTransition(void)
+		{
+			if (_transition.Update(_next_scene_ready))
+				SwapScene();
+		}
 
 	public:
-		SceneManager(void)
+		SceneManager(void) : _next_scene_ready(false), _loading_scene(nullptr)
 		{
 			_cur_scene = std::make_unique<BaseScene>();
 			_cur_scene->SetSceneManager(this);
 		}
 
-		~SceneManager(void) = default;
+		~SceneManager(void)
+		{
+			if (_loader.joinable())
+				_loader.join();
+		}
 
+		// blocking scene change
 		template<class SceneTypes>
 		void SetNextScene(void)
 		{
+			if (_transition.IsActive())
+			{
+				Log::Warning("SetNextScene() ignored, a scene transition is in progress.");
+				return;
+			}
+
 			if (_cur_scene)
 			{
 				_cur_scene->Finalize();
 				_cur_scene.reset();
 			}
-			
+
 			_cur_scene = std::make_unique<SceneTypes>();
+			_cur_scene->LoadResources();
 			_cur_scene->LoadScene();
 
 			Log::Info("Scene changed.");
 		}
 
+		// background scene change, the current scene keeps running until the next one is loaded
+		template<class SceneTypes>
+		bool RequestNextScene(void)
+		{
+			if (_transition.IsActive())
+			{
+				Log::Warning("RequestNextScene() ignored, a scene transition is in progress.");
+				return false;
+			}
+
+			_next_scene_ready = false;
+			_loading_scene = nullptr;
+			_transition.Begin();
+
+			_loader = std::thread([this]()
+			{
+				// WIC decoders need COM on this thread
+				CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+				Memory::TagScope tag(Memory::SCENE);
+				Profiler::SetThreadName("Scene Loader");
+				PRIZM_ZONE("SceneManager::LoadNextScene");
+
+				_next_scene = std::make_unique<SceneTypes>();
+				_loading_scene = _next_scene.get();
+				_next_scene->LoadResources();
+
+				CoUninitialize();
+
+				_next_scene_ready = true;
+			});
+
+			return true;
+		}
+
+		bool IsTransitioning(void) const
+		{
+			return _transition.IsActive();
+		}
+
+		// 0 - 1, progress of the scene being loaded in the background
+		float GetLoadProgress(void) const
+		{
+			if (_transition.GetState() != SceneTransition::LOADING) return 1.0f;
+
+			auto scene = _loading_scene.load();
+			return scene ? scene->GetLoadProgress() : 0.0f;
+		}
+
 		bool Update(void)
 		{
+			UpdateTransition();
+
 			return _cur_scene->Update();
 		}
 
+		void FixedUpdate(float dt)
+		{
+			_cur_scene->FixedUpdate(dt);
+		}
+
 		void Draw(void)
 		{
 			_cur_scene->Draw();
+
+			if (_transition.GetState() == SceneTransition::FADE_OUT)
+				_cur_scene->FadeOut(_transition.GetFadeElapsed(), SceneTransition::FADE_TIME);
+			else if (_transition.GetState() == SceneTransition::FADE_IN)
+				_cur_scene->FadeIn(_transition.GetFadeElapsed(), SceneTransition::FADE_TIME);
 		}
 
 		void Finalize(void)
 		{
+			if (_loader.joinable())
+				_loader.join();
+
+			if (_next_scene)
+			{
+				_next_scene->Finalize();
+				_next_scene.reset();
+			}
+
+			_transition.Reset();
 			_cur_scene->Finalize();
 		}
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,72 @@
+#include<cmath>
+#include<algorithm>
+
+#include"SceneTransition.h"
+#include"GameTime.h"
+#include"../Input/InputRecorder.h"
+
+namespace Prizm
+{
+	SceneTransition::SceneTransition(void) : _state(NONE), _fade_start(0) {}
+
+	std::uint64_t SceneTransition::FadeSteps(void) const
+	{
+		const double steps = std::ceil(FADE_TIME * GameTime::GetSimulationRate() / 1000.0);
+		return (std::max)(static_cast<std::uint64_t>(steps), std::uint64_t(1));
+	}
+
+	void SceneTransition::Begin(void)
+	{
+		_state = LOADING;
+	}
+
+	void SceneTransition::Reset(void)
+	{
+		_state = NONE;
+	}
+
+	bool SceneTransition::Update(bool loaded)
+	{
+		const auto elapsed = GameTime::GetStepCount() - _fade_start;
+
+		switch (_state)
+		{
+		case LOADING:
+			if (InputRecorder::SyncCondition(loaded))
+			{
+				_state = FADE_OUT;
+				_fade_start = GameTime::GetStepCount();
+			}
+			break;
+
+		case FADE_OUT:
+			if (elapsed >= FadeSteps())
+			{
+				_state = FADE_IN;
+				_fade_start = GameTime::GetStepCount();
+				return true;
+			}
+			break;
+
+		case FADE_IN:
+			if (elapsed >= FadeSteps())
+				_state = NONE;
+			break;
+
+		default:
+			break;
+		}
+
+		return false;
+	}
+
+	unsigned int SceneTransition::GetFadeElapsed(void) const
+	{
+		if (_state != FADE_OUT && _state != FADE_IN) return 0;
+
+		const double steps = static_cast<double>(GameTime::GetStepCount() - _fade_start) + GameTime::GetInterpolation();
+		const double milliseconds = steps * GameTime::GetFixedDeltaTime() * 1000.0;
+
+		return static_cast<unsigned int>((std::min)(milliseconds, static_cast<double>(FADE_TIME)));
+	}
+}
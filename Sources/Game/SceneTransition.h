@@ -0,0 +1,46 @@
+#pragma once
+
+#include<cstdint>
+
+namespace Prizm
+{
+	// timing of a background scene change: wait for the load, fade out, swap, fade in
+	// fades run on fixed steps and the frame the load is seen finished is part of an input recording,
+	// so a replay swaps on the same frame as the session it came from however long the load takes now
+	class SceneTransition
+	{
+	public:
+		enum State
+		{
+			NONE,
+			LOADING,	// next scene loads on the loader thread, current scene keeps running
+			FADE_OUT,	// next scene is ready, current scene fades out
+			FADE_IN,	// scenes swapped, new scene fades in
+		};
+
+		// milliseconds
+		static constexpr unsigned int FADE_TIME = 300;
+
+	private:
+		State _state;
+		std::uint64_t _fade_start;
+
+		std::uint64_t FadeSteps(void) const;
+
+	public:
+		SceneTransition(void);
+
+		void Begin(void);
+		void Reset(void);
+
+		// once a frame after the fixed steps, true on the frame the scenes have to be swapped
+		// during a replay the recorded load state replaces loaded, the swap has to wait for the loader then
+		bool Update(bool loaded);
+
+		State GetState(void) const { return _state; }
+		bool IsActive(void) const { return _state != NONE; }
+
+		// milliseconds into the current fade, interpolated between steps for drawing
+		unsigned int GetFadeElapsed(void) const;
+	};
+}
@@ -1,20 +1,21 @@
 
 #include<unordered_map>
+#include<algorithm>
 #include"BaseScene.h"
+#include"..\AssetCache.h"
 #include"..\..\Graphics\Graphics.h"
 #include"..\..\Graphics\GeometryGenerator.h"
 #include"..\SceneManager.h"
 #include"..\..\Graphics\Window.h"
+#include"..\..\Utilities\Profiler.h"
 
 namespace Prizm
 {
 	SceneManager* BaseScene::_scene_manager = nullptr;
 
-	BaseScene::BaseScene(void) 
+	BaseScene::BaseScene(void) : _load_progress(0.0f)
 	{
 		// 2D shader
-		_quad_shader = CreateShader("2D.hlsl");
-
 		std::vector<D3D11_INPUT_ELEMENT_DESC> ui_element =
 		{
 			{ "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT,		 0, 0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
@@ -22,37 +23,64 @@ namespace Prizm
 			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,		 0, 24, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 		};
 
-		CompileShader(_quad_shader, ShaderType::VS, ui_element);
-		CompileShader(_quad_shader, ShaderType::PS, ui_element);
+		_quad_shader = LoadShader("2D.hlsl", { ShaderType::VS, ShaderType::PS }, ui_element);
 
 		_screen_quad = std::make_unique<Geometry>(GeometryGenerator::Quad2D(window_width<float>, window_height<float>, 0, 0));
+
+		// opaque white, the fade color comes from the vertex color
+		_fade_texture = std::make_unique<Texture>();
+		_fade_texture->CreateSolidColor(Graphics::GetDevice(), 0xffffffff);
 	}
 
-	void BaseScene::FadeIn(unsigned int curr_time)
+	void BaseScene::DrawFade(float alpha)
 	{
+		if (alpha <= 0.0f) return;
+
+		auto& device_context = Graphics::GetDeviceContext();
+
+		auto& shader = _shaders.Get(_quad_shader);
+		shader->SetInputLayout(device_context);
+		shader->SetShader(device_context, ShaderType::VS);
+		shader->SetShader(device_context, ShaderType::PS);
+
+		Graphics::SetRasterizerState(RasterizerStateType::CULL_NONE);
+		Graphics::SetDepthStencilState(DepthStencilStateType::DEPTH_STENCIL_DISABLED);
+		Graphics::SetBlendState(BlendStateType::ALIGNMENT_BLEND);
+
+		Graphics::SetPSTexture(0, 1, _fade_texture->GetSRV());
+		device_context->PSSetSamplers(0, 1, Graphics::GetSamplerState(SamplerStateType::LINEAR_FILTER_SAMPLER).GetAddressOf());
 
+		_screen_quad->SetColor2D(DirectX::SimpleMath::Vector4(0.0f, 0.0f, 0.0f, (std::min)(alpha, 1.0f)));
+		_screen_quad->Draw(device_context);
 	}
 
-	void BaseScene::FadeOut(unsigned int curr_time)
+	bool BaseScene::FadeIn(unsigned int curr_time, unsigned int fade_time)
 	{
+		if (curr_time >= fade_time) return true;
 
+		DrawFade(1.0f - static_cast<float>(curr_time) / fade_time);
+		return false;
 	}
 
-	unsigned int BaseScene::CreateShader(const std::string& file_name)
+	bool BaseScene::FadeOut(unsigned int curr_time, unsigned int fade_time)
 	{
-		return _shaders.Load(std::make_shared<Shader>(file_name));
+		DrawFade(fade_time ? static_cast<float>(curr_time) / fade_time : 1.0f);
+		return curr_time >= fade_time;
 	}
 
-	void BaseScene::CompileShader(const unsigned int index, const ShaderType type, const std::vector<D3D11_INPUT_ELEMENT_DESC>& element_desc)
+	void BaseScene::SetLoadProgress(unsigned int done, unsigned int total)
 	{
-		_shaders.Get(index)->CompileAndCreateFromFile(Graphics::GetDevice(), type, element_desc);
+		_load_progress = total ? static_cast<float>(done) / total : 1.0f;
+	}
+
+	unsigned int BaseScene::LoadShader(const std::string& file_name, const std::vector<ShaderType>& stages, const std::vector<D3D11_INPUT_ELEMENT_DESC>& element_desc)
+	{
+		return _shaders.Load(AssetCache::Global().AcquireShader(file_name, stages, element_desc));
 	}
 
 	unsigned int BaseScene::LoadTexture(const std::string& tex_name)
 	{
-		auto index = _textures.Load(std::make_shared<Texture>());
-		_textures.Get(index)->LoadTexture(Graphics::GetDevice(), tex_name);
-		return index;
+		return _textures.Load(AssetCache::Global().AcquireTexture(tex_name));
 	}
 
 	const std::shared_ptr<Shader>& BaseScene::GetShader(const unsigned int index)
@@ -75,8 +103,27 @@ namespace Prizm
 		_textures.Release(index);
 	}
 
+	void BaseScene::RemoveGameObject(ResourcePool<Entity>& pool, const std::type_index& type, unsigned int index)
+	{
+		if (!pool.Get(index)) return;
+
+		pool.Get(index)->Finalize();
+		pool.Release(index);
+
+		auto& indices = _game_object_indices[type];
+		auto it = std::find(indices.begin(), indices.end(), index);
+
+		if (it != indices.end())
+		{
+			*it = indices.back();
+			indices.pop_back();
+		}
+	}
+
 	void BaseScene::RunEntities(void)
 	{
+		PRIZM_ZONE("BaseScene::RunEntities");
+
 		for (unsigned int i = 0; i < _back_ground.Size(); ++i)
 		{
 			if (_back_ground.Get(i))
@@ -102,8 +149,39 @@ namespace Prizm
 		}
 	}
 
+	void BaseScene::FixedRunEntities(float dt)
+	{
+		PRIZM_ZONE("BaseScene::FixedRunEntities");
+
+		for (unsigned int i = 0; i < _back_ground.Size(); ++i)
+		{
+			if (_back_ground.Get(i))
+				_back_ground.Get(i)->FixedRun(dt);
+		}
+
+		for (auto&& game_object : _game_objects_3d)
+		{
+			for (auto index : _game_object_indices[game_object.first])
+			{
+				if (game_object.second.Get(index))
+					game_object.second.Get(index)->FixedRun(dt);
+			}
+		}
+
+		for (auto&& game_object : _game_objects_2d)
+		{
+			for (auto index : _game_object_indices[game_object.first])
+			{
+				if (game_object.second.Get(index))
+					game_object.second.Get(index)->FixedRun(dt);
+			}
+		}
+	}
+
 	void BaseScene::DrawEntities(void)
 	{
+		PRIZM_ZONE("BaseScene::DrawEntities");
+
 		for (unsigned int i = 0; i < _back_ground.Size(); ++i)
 		{
 			if (_back_ground.Get(i))
@@ -1,14 +1,18 @@
 #pragma once
 
 #include<memory>
+#include<atomic>
 #include<vector>
 #include<unordered_map>
+#include<typeindex>
+#include<algorithm>
 #include<string>
 
 #include"..\Shader.h"
 #include"..\Texture.h"
 #include"..\..\Framework\Entity.h"
 #include"..\..\Utilities\ResourcePool.h"
+#include"..\..\Utilities\PoolAllocator.h"
 #include"..\..\Graphics\Geometry.h"
 
 namespace Prizm
@@ -19,30 +23,37 @@ namespace Prizm
 	{
 	private:
 		ResourcePool<Entity> _back_ground;
-		std::unordered_map<std::string, ResourcePool<Entity>> _game_objects_2d;		// UI
-		std::unordered_map<std::string, ResourcePool<Entity>> _game_objects_3d;		// objects
+		std::unordered_map<std::type_index, ResourcePool<Entity>> _game_objects_2d;		// UI
+		std::unordered_map<std::type_index, ResourcePool<Entity>> _game_objects_3d;		// objects
 
 		ResourcePool<Shader> _shaders;
 		ResourcePool<Texture> _textures;
 
 		std::unique_ptr<Geometry> _screen_quad;
+		std::unique_ptr<Texture> _fade_texture;
+
+		// written by the loader thread, read by the game thread
+		std::atomic<float> _load_progress;
+
+		void DrawFade(float);
+
+		// finalize, release the slot for reuse and stop iterating the index
+		void RemoveGameObject(ResourcePool<Entity>&, const std::type_index&, unsigned int);
 		
 	protected:
 		static SceneManager* _scene_manager;
-		std::unordered_map<std::string, std::vector<unsigned int>> _game_object_indices;
+		std::unordered_map<std::type_index, std::vector<unsigned int>> _game_object_indices;
 		int _score;
 
 		unsigned int _quad_shader;
 
 		SceneManager* GetSceneManager(void) { return _scene_manager; }
 
-		void FadeIn(unsigned int);
-
-		void FadeOut(unsigned int);
+		// report LoadResources progress, done / total
+		void SetLoadProgress(unsigned int, unsigned int);
 
-		unsigned int CreateShader(const std::string&);
-
-		void CompileShader(const unsigned int, const ShaderType, const std::vector<D3D11_INPUT_ELEMENT_DESC>&);
+		// shaders and textures come from AssetCache::Global(), the pools only hold this scene's handles
+		unsigned int LoadShader(const std::string&, const std::vector<ShaderType>&, const std::vector<D3D11_INPUT_ELEMENT_DESC>&);
 
 		unsigned int LoadTexture(const std::string&);
 
@@ -57,16 +68,30 @@ namespace Prizm
 	public:
 		BaseScene(void);
 		virtual ~BaseScene(void) = default;
+
+		// device-only loading (textures, shaders), runs on the loader thread during transitions
+		virtual void LoadResources(void) {}
+		// context and audio setup, runs on the game thread when the scene becomes current
 		virtual void LoadScene(void) {}
 		virtual bool Update(void) { return false; }
+		// zero or more times per frame at GameTime's simulation rate, before Update
+		virtual void FixedUpdate(float) {}
 		virtual void Draw(void) {}
 		virtual void Finalize(void) {}
 
+		float GetLoadProgress(void) const { return _load_progress; }
+
+		// draw the fade overlay, curr_time / fade_time in milliseconds
+		// return true when the fade is done
+		bool FadeIn(unsigned int curr_time, unsigned int fade_time);
+		bool FadeOut(unsigned int curr_time, unsigned int fade_time);
+
+		// game objects and their control blocks come from a per-type pool, see PoolAllocator
 		template<class _Type>
 		unsigned int AddBackGround(void)
 		{
-			auto game_object_index = _back_ground.Load(std::make_shared<_Type>());
-			_game_object_indices[typeid(_Type).name()].emplace_back(game_object_index);
+			auto game_object_index = _back_ground.Load(std::allocate_shared<_Type>(PoolAllocator<_Type>()));
+			_game_object_indices[typeid(_Type)].emplace_back(game_object_index);
 			_back_ground.Get(game_object_index)->Initialize();
 			return game_object_index;
 		}
@@ -81,37 +106,52 @@ namespace Prizm
 		template<class _Type>
 		unsigned int AddGameObject2D(void)
 		{
-			auto game_object_index = _game_objects_2d[typeid(_Type).name()].Load(std::make_shared<_Type>());
-			_game_object_indices[typeid(_Type).name()].emplace_back(game_object_index);
-			_game_objects_2d[typeid(_Type).name()].Get(game_object_index)->Initialize();
+			auto& pool = _game_objects_2d[typeid(_Type)];
+			auto game_object_index = pool.Load(std::allocate_shared<_Type>(PoolAllocator<_Type>()));
+			_game_object_indices[typeid(_Type)].emplace_back(game_object_index);
+			pool.Get(game_object_index)->Initialize();
 			return game_object_index;
 		}
 		
 		template<class _Type>
 		std::shared_ptr<_Type> GetGameObject2D(unsigned int index)
 		{
-			auto game_object = _game_objects_2d[typeid(_Type).name()].Get(index);
+			auto game_object = _game_objects_2d[typeid(_Type)].Get(index);
 			return std::static_pointer_cast<_Type>(game_object);
 		}
 
+		template<class _Type>
+		void RemoveGameObject2D(unsigned int index)
+		{
+			RemoveGameObject(_game_objects_2d[typeid(_Type)], typeid(_Type), index);
+		}
+
 		template<class _Type>
 		unsigned int AddGameObject3D(void)
 		{
-			auto game_object_index = _game_objects_3d[typeid(_Type).name()].Load(std::make_shared<_Type>());
-			_game_object_indices[typeid(_Type).name()].emplace_back(game_object_index);
-			_game_objects_3d[typeid(_Type).name()].Get(game_object_index)->Initialize();
+			auto& pool = _game_objects_3d[typeid(_Type)];
+			auto game_object_index = pool.Load(std::allocate_shared<_Type>(PoolAllocator<_Type>()));
+			_game_object_indices[typeid(_Type)].emplace_back(game_object_index);
+			pool.Get(game_object_index)->Initialize();
 			return game_object_index;
 		}
 
 		template<class _Type>
 		std::shared_ptr<_Type> GetGameObject3D(unsigned int index)
 		{
-			auto game_object = _game_objects_3d[typeid(_Type).name()].Get(index);
+			auto game_object = _game_objects_3d[typeid(_Type)].Get(index);
 			return std::static_pointer_cast<_Type>(game_object);
 		}
 
+		template<class _Type>
+		void RemoveGameObject3D(unsigned int index)
+		{
+			RemoveGameObject(_game_objects_3d[typeid(_Type)], typeid(_Type), index);
+		}
+
 		// all game objects function
 		void RunEntities(void);
+		void FixedRunEntities(float);
 		void DrawEntities(void);
 		void FinalizeEntities(void);
 
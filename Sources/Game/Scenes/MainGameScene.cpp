@@ -1,9 +1,12 @@
 
+#include<vector>
+#include<algorithm>
+
 #include"MainGameScene.h"
 #include"..\GameManager.h"
 #include"..\SceneManager.h"
 #include"..\ImguiManager.h"
-#include"..\AudioDriver\AudioDriver_WASAPI.h"
+#include"..\AudioDriver\AudioDriver.h"
 #include"..\Entity\BackGround.h"
 #include"..\Entity\UI.h"
 #include"..\Entity\Player2D.h"
@@ -11,18 +14,75 @@
 #include"..\..\Input\Input.h"
 #include"..\..\Graphics\Window.h"
 #include"..\..\Framework\Entity.h"
+#include"..\..\Framework\SoundFramework\Sound.h"
+#include"..\..\Framework\SoundFramework\SoundBuffer.h"
+#include"..\..\Utilities\Memory.h"
 
 #include "SoLoud\soloud.h"
-#include "SoLoud\soloud_wav.h"
 #include "SoLoud\soloud_sfxr.h"
 #include "SoLoud\soloud_speech.h"
-#include "SoLoud\soloud_biquadresonantfilter.h"
 #pragma comment(lib, "SoLoud/soloud_static.lib")
 
 #include"ImGui/imgui.h"
 
 namespace Prizm
 {
+	namespace
+	{
+		// speech stays mixed over the enemy loops when there are more voices than the mixer takes
+		constexpr int SPEECH_PRIORITY = 1;
+		constexpr int SFX_PRIORITY = 0;
+		constexpr unsigned int SFX_INSTANCES = 8;
+
+		// generated sounds are rendered once through a bare SoLoud instance, no SoLoud mixer runs
+		std::shared_ptr<SoundBuffer> Bake(SoLoud::AudioSource& source, float max_seconds)
+		{
+			std::unique_ptr<SoLoud::AudioSourceInstance> instance(source.createInstance());
+			if (!instance) return nullptr;
+
+			instance->init(source, 0);
+
+			const unsigned int chunk = 512;
+			const unsigned int channels = (std::min)(source.mChannels, 2u);
+			const unsigned int sample_rate = static_cast<unsigned int>(source.mBaseSamplerate);
+			const unsigned int max_frames = static_cast<unsigned int>(max_seconds * sample_rate);
+
+			// SoLoud hands out one channel after the other
+			std::vector<float> planar(chunk * source.mChannels);
+			std::vector<float> samples;
+
+			while (!instance->hasEnded() && samples.size() < max_frames * channels)
+			{
+				const unsigned int frames = instance->getAudio(planar.data(), chunk, chunk);
+				if (frames == 0) break;
+
+				for (unsigned int i = 0; i < frames; ++i)
+					for (unsigned int c = 0; c < channels; ++c)
+						samples.push_back(planar[c * chunk + i]);
+			}
+
+			if (samples.empty()) return nullptr;
+
+			return std::make_shared<SoundBuffer>(samples.data(), static_cast<unsigned int>(samples.size() / channels), channels, sample_rate);
+		}
+
+		Sound::PlayParameters Emitter(float max_distance, float rolloff, float x, float y, int priority, unsigned int max_instances)
+		{
+			Sound::PlayParameters parameters;
+			parameters.loop = true;
+			parameters.spatial = true;
+			parameters.position[0] = x;
+			parameters.position[1] = y;
+			parameters.attenuation = Sound::EXPONENTIAL_DISTANCE;
+			parameters.min_distance = 1.0f;
+			parameters.max_distance = max_distance;
+			parameters.rolloff = rolloff;
+			parameters.priority = priority;
+			parameters.max_instances = max_instances;
+			return parameters;
+		}
+	}
+
 	class MainGameScene::Impl
 	{
 	public:
@@ -39,28 +99,41 @@ namespace Prizm
 		unsigned int _enemy1_obj;
 		unsigned int _enemy2_obj;
 
-		SoLoud::Soloud _soloud;
 		SoLoud::Sfxr _sfx_enemy1, _sfx_enemy2;
 		SoLoud::Speech _sfx_speech;
-		SoLoud::BiquadResonantFilter _filter;
 
-		int _sound_handle_enemy1 = 0;
-		int _sound_handle_enemy2 = 0;
-		int _sound_handle_speech = 0;
+		std::shared_ptr<SoundBuffer> _buffer_enemy1;
+		std::shared_ptr<SoundBuffer> _buffer_enemy2;
+		std::shared_ptr<SoundBuffer> _buffer_speech;
+
+		VoiceHandle _sound_handle_enemy1 = Sound::INVALID_VOICE;
+		VoiceHandle _sound_handle_enemy2 = Sound::INVALID_VOICE;
+		VoiceHandle _sound_handle_speech = Sound::INVALID_VOICE;
 
-		std::unique_ptr<AudioDriver_WASAPI> _wasapi;
+		// mixed by the driver thread
+		Sound _sound;
+		std::unique_ptr<AudioDriver> _audio_driver;
 	};
 
 	MainGameScene::MainGameScene(void) : _impl(std::make_unique<Impl>()){}
 	MainGameScene::~MainGameScene(void) = default;
 
-	void MainGameScene::LoadScene(void)
+	void MainGameScene::LoadResources(void)
 	{
+		const unsigned int texture_count = 4;
+
 		_impl->_bg_tex = this->LoadTexture("simple_bg00.jpg");
+		this->SetLoadProgress(1, texture_count);
 		_impl->_player_tex = this->LoadTexture("green.png");
+		this->SetLoadProgress(2, texture_count);
 		_impl->_enemy1_tex = this->LoadTexture("yellow.png");
+		this->SetLoadProgress(3, texture_count);
 		_impl->_enemy2_tex = this->LoadTexture("skyblue.png");
+		this->SetLoadProgress(4, texture_count);
+	}
 
+	void MainGameScene::LoadScene(void)
+	{
 		// game object initialize
 		auto bg_id = this->AddBackGround<BackGround>();
 		this->GetBackGround<BackGround>(bg_id)->LoadShader(this->GetShader(this->_quad_shader));
@@ -83,60 +156,66 @@ namespace Prizm
 
 		//_impl->_soloud.Initialize();
 
-		_impl->_soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF | SoLoud::Soloud::ENABLE_VISUALIZATION | SoLoud::Soloud::LEFT_HANDED_3D);
-		_impl->_soloud.setGlobalVolume(4);
+		Memory::TagScope audio_tag(Memory::AUDIO);
+
+		_impl->_sound.Initialize(AudioDriver::DEFAULT_MIX_RATE);
+		_impl->_sound.SetGlobalVolume(4);
 
 		_impl->_sfx_enemy1.loadPreset(SoLoud::Sfxr::COIN, 3);
-		_impl->_sfx_enemy1.setLooping(1);
-		_impl->_sfx_enemy1.set3dMinMaxDistance(1, 200);
-		_impl->_sfx_enemy1.set3dAttenuation(SoLoud::AudioSource::EXPONENTIAL_DISTANCE, 0.5);
-		//_impl->_sound_handle_enemy1 = _impl->_soloud.play3d(_impl->_sfx_enemy1, 50, 0, 0);
+		_impl->_buffer_enemy1 = Bake(_impl->_sfx_enemy1, 10.0f);
+		//_impl->_sound_handle_enemy1 = _impl->_sound.Play(_impl->_buffer_enemy1, Emitter(200, 0.5f, 50, 0, SFX_PRIORITY, SFX_INSTANCES));
 
 		_impl->_sfx_enemy2.loadPreset(SoLoud::Sfxr::LASER, 3);
-		_impl->_sfx_enemy2.setLooping(1);
-		_impl->_sfx_enemy2.set3dMinMaxDistance(1, 200);
-		_impl->_sfx_enemy2.set3dAttenuation(SoLoud::AudioSource::EXPONENTIAL_DISTANCE, 0.5);
-		_impl->_sound_handle_enemy2 = _impl->_soloud.play3d(_impl->_sfx_enemy2, 100, 0, 0);
+		_impl->_buffer_enemy2 = Bake(_impl->_sfx_enemy2, 10.0f);
+		_impl->_sound_handle_enemy2 = _impl->_sound.Play(_impl->_buffer_enemy2, Emitter(200, 0.5f, 100, 0, SFX_PRIORITY, SFX_INSTANCES));
 
 		_impl->_sfx_speech.setText("Default speech.");
-		_impl->_sfx_speech.setLooping(1);
-		_impl->_sfx_speech.set3dMinMaxDistance(1, 400);
-		_impl->_sfx_speech.set3dAttenuation(SoLoud::AudioSource::EXPONENTIAL_DISTANCE, 0.25);
-		_impl->_sound_handle_speech = _impl->_soloud.play3d(_impl->_sfx_speech, 50, 0, 0);
+		_impl->_buffer_speech = Bake(_impl->_sfx_speech, 30.0f);
+		_impl->_sound_handle_speech = _impl->_sound.Play(_impl->_buffer_speech, Emitter(400, 0.25f, 50, 0, SPEECH_PRIORITY, 1));
 
-		_impl->_wasapi = std::make_unique<AudioDriver_WASAPI>();
-		_impl->_wasapi->Initialize();
+		_impl->_audio_driver = AudioDriver::Create([this](float* output, unsigned int frames) { _impl->_sound.Mix(output, frames); });
 	}
 
 	bool MainGameScene::Update(void)
 	{
-		auto& player_pos = this->GetGameObject2D<Player2D>(_impl->_player_obj)->GetPosition();
-
-		_impl->_soloud.set3dListenerPosition(player_pos.x, player_pos.y, 0);
+		if (Input::IsKeyTriggered(PRIZM_KEY("F5")))
+		{// reload the scene in the background
+			this->GetSceneManager()->RequestNextScene<MainGameScene>();
+		}
 
-		//_impl->_soloud.set3dSourceAttenuation(_impl->_sound_handle_speech, );
+		// queued for the next audio block, nothing here waits on the mixer
+		auto& player_pos = this->GetGameObject2D<Player2D>(_impl->_player_obj)->GetPosition();
+		_impl->_sound.SetListenerPosition(player_pos.x, player_pos.y, 0);
 
 		auto enemy_pos = this->GetGameObject2D<Enemy>(_impl->_enemy1_obj)->GetPosition();
-		_impl->_soloud.set3dSourceParameters(_impl->_sound_handle_speech, enemy_pos.x, enemy_pos.y, 0, 5, 0, 0);
+		_impl->_sound.SetPosition(_impl->_sound_handle_speech, enemy_pos.x, enemy_pos.y, 0);
 
-		//_impl->_soloud.set3dSourceParameters(_impl->_sound_handle_enemy1, enemy_pos.x, enemy_pos.y, 0, 5, 0, 0);
+		//_impl->_sound.SetPosition(_impl->_sound_handle_enemy1, enemy_pos.x, enemy_pos.y, 0);
 
 		enemy_pos = this->GetGameObject2D<Enemy>(_impl->_enemy2_obj)->GetPosition();
-		_impl->_soloud.set3dSourceParameters(_impl->_sound_handle_enemy2, enemy_pos.x, enemy_pos.y, 0, 5, 0, 0);
+		_impl->_sound.SetPosition(_impl->_sound_handle_enemy2, enemy_pos.x, enemy_pos.y, 0);
 
-		_impl->_soloud.update3dAudio();
+		_impl->_sound.Update();
 
 		this->RunEntities();
 
-		float *buf = _impl->_soloud.getWave();
-		float *fft = _impl->_soloud.calcFFT();
+		const float* buf = _impl->_sound.GetWave();
+		const float* fft = _impl->_sound.GetFFT();
 
 		ImGui::SetNextWindowPos(ImVec2(50, 20));
 		ImGui::Begin("Listener");
 		ImGui::SetWindowSize(ImVec2(420, 420));
-		ImGui::PlotLines("Wave", buf, 256, 0, "Wave", -1, 1, ImVec2(300, 160));
-		ImGui::PlotHistogram("FFT", fft, 256 / 2, 0, "FFT", 0, 10, ImVec2(300, 160), 8);
-		ImGui::Text("Active voices    : %d", _impl->_soloud.getActiveVoiceCount());
+		ImGui::PlotLines("Wave", buf, Sound::VISUALIZATION_SIZE, 0, "Wave", -1, 1, ImVec2(300, 160));
+		ImGui::PlotHistogram("FFT", fft, Sound::VISUALIZATION_SIZE / 2, 0, "FFT", 0, 1, ImVec2(300, 160), 4);
+		ImGui::Text("Active voices    : %u (%u mixed)", _impl->_sound.GetActiveVoiceCount(), _impl->_sound.GetRealVoiceCount());
+		ImGui::Text("Dropped commands : %llu", _impl->_sound.GetDroppedCommandCount());
+		if (_impl->_audio_driver)
+		{
+			ImGui::Text("Output latency   : %.1f ms", _impl->_audio_driver->GetOutputLatencyMs());
+			ImGui::Text("Underruns        : %llu / glitches %llu", _impl->_audio_driver->GetUnderrunCount(), _impl->_audio_driver->GetGlitchCount());
+		}
+		if (this->GetSceneManager()->IsTransitioning())
+			ImGui::Text("Scene loading    : %.0f%%", this->GetSceneManager()->GetLoadProgress() * 100.0f);
 		ImGui::End();
 
 		static char text[256] = "";
@@ -148,7 +227,11 @@ namespace Prizm
 		if (ImGui::Button("join"))
 		{
 			_impl->_sfx_speech.setText(text);
-			_impl->_sound_handle_speech = _impl->_soloud.play3d(_impl->_sfx_speech, 50, 0, 0);
+			_impl->_buffer_speech = Bake(_impl->_sfx_speech, 30.0f);
+
+			// a new buffer is a new sound to the instance limit, the old voice holds on to its own buffer until it has faded out
+			_impl->_sound.Stop(_impl->_sound_handle_speech);
+			_impl->_sound_handle_speech = _impl->_sound.Play(_impl->_buffer_speech, Emitter(400, 0.25f, 50, 0, SPEECH_PRIORITY, 1));
 		}
 
 		ImGui::End();
@@ -156,6 +239,11 @@ namespace Prizm
 		return true;
 	}
 
+	void MainGameScene::FixedUpdate(float dt)
+	{
+		this->FixedRunEntities(dt);
+	}
+
 	void MainGameScene::Draw(void)
 	{
 		this->DrawEntities();
@@ -163,6 +251,10 @@ namespace Prizm
 
 	void MainGameScene::Finalize(void)
 	{
+		// the driver thread mixes until it is stopped
+		if (_impl->_audio_driver) _impl->_audio_driver->Finalize();
+		_impl->_sound.Finalize();
+
 		this->FinalizeEntities();
 	}
 }
\ No newline at end of file
@@ -14,8 +14,10 @@ namespace Prizm
 		MainGameScene(void);
 		~MainGameScene(void);
 
+		void LoadResources(void) override;
 		void LoadScene(void) override;
 		bool Update(void) override;
+		void FixedUpdate(float) override;
 		void Draw(void) override;
 		void Finalize(void) override;
 	};
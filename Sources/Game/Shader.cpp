@@ -5,6 +5,7 @@
 #include"Resource.h"
 #include"..\Utilities\Utils.h"
 #include"..\Utilities\Log.h"
+#include"..\Utilities\AssetManifest.h"
 #include"..\Graphics\Graphics.h"
 
 #pragma comment(lib, "d3dcompiler.lib")
@@ -13,8 +14,10 @@ namespace Prizm
 {
 	// Resource directory from Shader.cpp
 	const std::string SHADER_RESOURCE_DIR = RESOURCE_DIR + "Shaders/";
-	constexpr const char* SHADER_COMPILER_VERSIONS[] = { "vs_5_0", "gs_5_0", "hs_5_0", "ds_5_0", "cs_5_0", "ps_5_0" };
+	constexpr const char* SHADER_COMPILER_VERSIONS[] = { "vs_5_0", "gs_5_0", "ds_5_0", "hs_5_0", "cs_5_0", "ps_5_0" };
 	constexpr const char* SHADER_ENTRY_POINTS[] = { "VSMain", "GSMain", "DSMain", "HSMain", "CSMain", "PSMain" };
+	// output suffixes written by AssetCooker, same order as ShaderType
+	constexpr const char* SHADER_COOKED_SUFFIXES[] = { ".vs.cso", ".gs.cso", ".ds.cso", ".hs.cso", ".cs.cso", ".ps.cso" };
 #ifdef _DEBUG
 	constexpr UINT SHADER_COMPILE_FLAGS = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_DEBUG;
 #else
@@ -35,6 +38,7 @@ namespace Prizm
 		Microsoft::WRL::ComPtr<ID3D11InputLayout>    _input_layput;
 
 		std::vector<ShaderTexture> _textures;
+		std::size_t _memory_size = 0;
 
 		Impl()
 			: name_("")
@@ -56,6 +60,61 @@ namespace Prizm
 			, _cs(nullptr)
 			, _input_layput(nullptr){}
 
+		// precompiled bytecode from the asset manifest, runtime compile as fallback
+		bool LoadBlob(const ShaderType type, Microsoft::WRL::ComPtr<ID3DBlob>& blob)
+		{
+			const CookedAsset* asset = AssetManifest::Runtime().Find("Shaders/" + name_);
+
+			if (asset && AssetManifest::IsUpToDate(RESOURCE_DIR, *asset))
+			{
+				const std::string output = asset->FindOutput(SHADER_COOKED_SUFFIXES[type]);
+
+				if (!output.empty())
+				{
+					const std::string cooked_path = RESOURCE_DIR + COOKED_DIR_NAME + output;
+					const std::wstring path = StrUtils::AsciiToUnicode(cooked_path.c_str());
+
+					if (succeeded(D3DReadFileToBlob(path.c_str(), blob.GetAddressOf())))
+						return true;
+
+					Log::Warning("Failed to read cooked shader " + cooked_path + ", compiling at runtime.");
+				}
+			}
+			else if (asset)
+			{
+				Log::Warning("Cooked shader " + name_ + " is out of date, compiling at runtime.");
+			}
+
+			std::string dir_path = SHADER_RESOURCE_DIR + name_;
+			const std::wstring path = StrUtils::AsciiToUnicode(dir_path.c_str());
+
+			Microsoft::WRL::ComPtr<ID3DBlob> error_blob;
+
+			if (failed(D3DCompileFromFile(
+				path.c_str(),
+				nullptr,
+				D3D_COMPILE_STANDARD_FILE_INCLUDE,
+				SHADER_ENTRY_POINTS[type],
+				SHADER_COMPILER_VERSIONS[type],
+				SHADER_COMPILE_FLAGS,
+				0,
+				blob.GetAddressOf(),
+				error_blob.GetAddressOf())))
+			{
+				if (error_blob) Log::Error(static_cast<char*>(error_blob->GetBufferPointer()));
+				else Log::Error("Cannot open shader file " + dir_path);
+				return false;
+			}
+
+			if (!blob)
+			{
+				Log::Error("ID3DBlob is nullptr.");
+				return false;
+			}
+
+			return true;
+		}
+
 		bool CreateShader(Microsoft::WRL::ComPtr<ID3D11Device>& device,
 			ShaderType type, void* buffer, const size_t shader_binary_size)
 		{
@@ -104,6 +163,8 @@ namespace Prizm
 				}
 				break;
 			}
+
+			_memory_size += shader_binary_size;
 			return true;
 		}
 
@@ -127,48 +188,27 @@ namespace Prizm
 
 	Shader::~Shader() = default;
 
+	std::size_t Shader::GetMemorySize(void) const
+	{
+		return _impl->_memory_size;
+	}
+
 	bool Shader::CompileAndCreateFromFile(Microsoft::WRL::ComPtr<ID3D11Device>& device,
 		const ShaderType& type, const std::vector<D3D11_INPUT_ELEMENT_DESC>& element_desc)
 	{
-		std::string dir_path = SHADER_RESOURCE_DIR + _impl->name_;
-		const std::wstring path = StrUtils::AsciiToUnicode(dir_path.c_str());
-
 		Microsoft::WRL::ComPtr<ID3DBlob> blob;
-		Microsoft::WRL::ComPtr<ID3DBlob> error_blob;
-
-		if (failed(D3DCompileFromFile(
-			path.c_str(),
-			nullptr,
-			D3D_COMPILE_STANDARD_FILE_INCLUDE,
-			SHADER_ENTRY_POINTS[type],
-			SHADER_COMPILER_VERSIONS[type],
-			SHADER_COMPILE_FLAGS,
-			0,
-			blob.GetAddressOf(),
-			error_blob.GetAddressOf())))
-		{
-			Log::Error(static_cast<char*>(error_blob->GetBufferPointer()));
-			return false;
-		}
 
-		if (blob)
-		{
-			if (failed(_impl->CreateShader(device, type, blob->GetBufferPointer(), blob->GetBufferSize())))
-			{
-				Log::Error("Do not create shader.");
-				return false;
-			}
-		}
-		else
+		if (!_impl->LoadBlob(type, blob)) return false;
+
+		if (!_impl->CreateShader(device, type, blob->GetBufferPointer(), blob->GetBufferSize()))
 		{
-			Log::Error("ID3DBlob is nullptr.");
-			Log::Error(static_cast<char*>(error_blob->GetBufferPointer()));
+			Log::Error("Do not create shader.");
 			return false;
 		}
 
 		if (type == ShaderType::VS)
 		{
-			if (failed(_impl->CreateInputLayout(device, element_desc, blob)))
+			if (!_impl->CreateInputLayout(device, element_desc, blob))
 			{
 				Log::Error("Do not create shader.");
 			}
@@ -181,45 +221,19 @@ namespace Prizm
 	{
 		_impl->name_ = filepath;
 
-		std::string dir_path = SHADER_RESOURCE_DIR + _impl->name_;
-		const std::wstring path = StrUtils::AsciiToUnicode(dir_path.c_str());
-
 		Microsoft::WRL::ComPtr<ID3DBlob> blob;
-		Microsoft::WRL::ComPtr<ID3DBlob> error_blob;
-
-		if (failed(D3DCompileFromFile(
-			path.c_str(),
-			nullptr,
-			D3D_COMPILE_STANDARD_FILE_INCLUDE,
-			SHADER_ENTRY_POINTS[type],
-			SHADER_COMPILER_VERSIONS[type],
-			SHADER_COMPILE_FLAGS,
-			0,
-			blob.GetAddressOf(),
-			error_blob.GetAddressOf())))
-		{
-			Log::Error(static_cast<char*>(error_blob->GetBufferPointer()));
-			return false;
-		}
 
-		if (blob)
-		{
-			if (failed(_impl->CreateShader(device, type, blob->GetBufferPointer(), blob->GetBufferSize())))
-			{
-				Log::Error("Do not create shader.");
-				return false;
-			}
-		}
-		else
+		if (!_impl->LoadBlob(type, blob)) return false;
+
+		if (!_impl->CreateShader(device, type, blob->GetBufferPointer(), blob->GetBufferSize()))
 		{
-			Log::Error("ID3DBlob is nullptr.");
-			Log::Error(static_cast<char*>(error_blob->GetBufferPointer()));
+			Log::Error("Do not create shader.");
 			return false;
 		}
 
 		if (type == ShaderType::VS)
 		{
-			if (failed(_impl->CreateInputLayout(device, element_desc, blob)))
+			if (!_impl->CreateInputLayout(device, element_desc, blob))
 			{
 				Log::Error("Do not create shader.");
 			}
@@ -229,6 +243,8 @@ namespace Prizm
 
 	void Shader::SetShader(Microsoft::WRL::ComPtr<ID3D11DeviceContext>& device_context, const ShaderType& type)
 	{
+		Graphics::CountStateChange();
+
 		switch (type)
 		{
 		case ShaderType::VS:
@@ -259,6 +275,7 @@ namespace Prizm
 
 	void Shader::SetInputLayout(Microsoft::WRL::ComPtr<ID3D11DeviceContext>& device_context)
 	{
+		Graphics::CountStateChange();
 		device_context->IASetInputLayout(_impl->_input_layput.Get());
 	}
 
@@ -9,6 +9,7 @@
 
 #include"..\Graphics\Buffer.h"
 #include"..\Graphics\GraphicsEnums.h"
+#include"AssetCache.h"
 
 namespace Prizm
 {
@@ -40,7 +41,7 @@ namespace Prizm
 		LayoutFormat	format;
 	};
 
-	class Shader
+	class Shader : public CachedAsset
 	{
 	private:
 		class Impl;
@@ -53,6 +54,9 @@ namespace Prizm
 
 		~Shader(void);
 
+		// size of the bytecode of every created stage
+		std::size_t GetMemorySize(void) const override;
+
 		bool CompileAndCreateFromFile(Microsoft::WRL::ComPtr<ID3D11Device>& device,
 			const ShaderType& type, const std::vector<D3D11_INPUT_ELEMENT_DESC>& element_desc);
 		
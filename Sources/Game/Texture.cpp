@@ -3,6 +3,7 @@
 #include"Resource.h"
 #include"..\Utilities\Utils.h"
 #include"..\Utilities\Log.h"
+#include"..\Utilities\AssetManifest.h"
 
 #include"..\..\ThirdParty\Includes\DirectXTex\DirectXTex.h"
 //#include"..\..\ThirdParty\Includes\stb\stb_image.h"
@@ -30,10 +31,11 @@ namespace Prizm
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> _srv;
 		Microsoft::WRL::ComPtr<ID3D11Texture2D> _tex_2d;
 		unsigned _width, _height;
+		std::size_t _memory_size;
 
 		std::string _file_name;
 
-		Impl(void){}
+		Impl(void) : _width(0), _height(0), _memory_size(0){}
 	};
 
 	Texture::Texture(void) : _impl(std::make_unique<Impl>()){}
@@ -45,62 +47,96 @@ namespace Prizm
 
 		_impl->_file_name = filename;
 		std::string path = TEXTURE_DIR + filename;
-		std::wstring wpath(path.begin(), path.end());
 
 		std::unique_ptr<DirectX::ScratchImage> img = std::make_unique<DirectX::ScratchImage>();
 
-		std::string extension = path.substr(path.find_last_of("."), path.size());
+		// cooked textures are already decoded, DDS load is a plain copy
+		bool loaded = false;
+		const CookedAsset* asset = AssetManifest::Runtime().Find("Textures/" + filename);
 
-		if(extension == ".tga" || extension == ".TGA")
+		if (asset && AssetManifest::IsUpToDate(RESOURCE_DIR, *asset))
 		{
-			if (succeeded(LoadFromTGAFile(wpath.c_str(), nullptr, *img)))
-			{
-				CreateShaderResourceView(device.Get(), img->GetImages(), img->GetImageCount(), img->GetMetadata(), &_impl->_srv);
+			const std::string output = asset->FindOutput(".dds");
 
-				// get srv from img
-				D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-				_impl->_srv->GetDesc(&srvDesc);
+			if (!output.empty())
+			{
+				const std::string cooked_path = RESOURCE_DIR + COOKED_DIR_NAME + output;
+				std::wstring wpath(cooked_path.begin(), cooked_path.end());
 
-				// read width & height
-				Microsoft::WRL::ComPtr<ID3D11Resource> resource;
-				_impl->_srv->GetResource(&resource);
+				loaded = succeeded(LoadFromDDSFile(wpath.c_str(), DirectX::DDS_FLAGS_NONE, nullptr, *img));
+			}
+		}
 
-				if (succeeded(resource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(_impl->_tex_2d.GetAddressOf()))))
-				{
-					D3D11_TEXTURE2D_DESC desc;
-					_impl->_tex_2d->GetDesc(&desc);
-					_impl->_width = desc.Width;
-					_impl->_height = desc.Height;
-				}
+		if (!loaded)
+		{
+			std::wstring wpath(path.begin(), path.end());
+			std::string extension = path.substr(path.find_last_of("."), path.size());
 
-				resource.Reset();
-			}
+			if (extension == ".tga" || extension == ".TGA")
+				loaded = succeeded(LoadFromTGAFile(wpath.c_str(), nullptr, *img));
+			else
+				loaded = succeeded(LoadFromWICFile(wpath.c_str(), DirectX::WIC_FLAGS_NONE, nullptr, *img));
 		}
-		else
+
+		if (!loaded)
 		{
-			if (succeeded(LoadFromWICFile(wpath.c_str(), DirectX::WIC_FLAGS_NONE, nullptr, *img)))
-			{
-				CreateShaderResourceView(device.Get(), img->GetImages(), img->GetImageCount(), img->GetMetadata(), &_impl->_srv);
+			Log::Error("Failed to load texture " + path);
+			return;
+		}
 
-				// get srv from img
-				D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-				_impl->_srv->GetDesc(&srvDesc);
+		CreateShaderResourceView(device.Get(), img->GetImages(), img->GetImageCount(), img->GetMetadata(), &_impl->_srv);
+		_impl->_memory_size = img->GetPixelsSize();
 
-				// read width & height
-				Microsoft::WRL::ComPtr<ID3D11Resource> resource;
-				_impl->_srv->GetResource(&resource);
+		// get srv from img
+		D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		_impl->_srv->GetDesc(&srvDesc);
 
-				if (succeeded(resource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(_impl->_tex_2d.GetAddressOf()))))
-				{
-					D3D11_TEXTURE2D_DESC desc;
-					_impl->_tex_2d->GetDesc(&desc);
-					_impl->_width = desc.Width;
-					_impl->_height = desc.Height;
-				}
+		// read width & height
+		Microsoft::WRL::ComPtr<ID3D11Resource> resource;
+		_impl->_srv->GetResource(&resource);
 
-				resource.Reset();
-			}
+		if (succeeded(resource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(_impl->_tex_2d.GetAddressOf()))))
+		{
+			D3D11_TEXTURE2D_DESC desc;
+			_impl->_tex_2d->GetDesc(&desc);
+			_impl->_width = desc.Width;
+			_impl->_height = desc.Height;
 		}
+
+		resource.Reset();
+	}
+
+	void Texture::CreateSolidColor(Microsoft::WRL::ComPtr<ID3D11Device>& device, unsigned int color)
+	{
+		D3D11_TEXTURE2D_DESC desc = {};
+		desc.Width = 1;
+		desc.Height = 1;
+		desc.MipLevels = 1;
+		desc.ArraySize = 1;
+		desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		desc.SampleDesc.Count = 1;
+		desc.Usage = D3D11_USAGE_IMMUTABLE;
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+		D3D11_SUBRESOURCE_DATA data = {};
+		data.pSysMem = &color;
+		data.SysMemPitch = sizeof(color);
+
+		if (failed(device->CreateTexture2D(&desc, &data, _impl->_tex_2d.GetAddressOf())) ||
+			failed(device->CreateShaderResourceView(_impl->_tex_2d.Get(), nullptr, _impl->_srv.GetAddressOf())))
+		{
+			Log::Error("Failed to create solid color texture.");
+			return;
+		}
+
+		_impl->_width = 1;
+		_impl->_height = 1;
+		_impl->_memory_size = sizeof(color);
+	}
+
+	std::size_t Texture::GetMemorySize(void) const
+	{
+		return _impl->_memory_size;
 	}
 
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& Texture::GetSRV(void)
@@ -9,9 +9,11 @@
 
 #include<DirectXTK/SimpleMath.h>
 
+#include"AssetCache.h"
+
 namespace Prizm
 {
-	class Texture
+	class Texture : public CachedAsset
 	{
 	private:
 		class Impl;
@@ -21,7 +23,12 @@ namespace Prizm
 		Texture(void);
 		~Texture(void);
 
+		std::size_t GetMemorySize(void) const override;
+
 		void LoadTexture(Microsoft::WRL::ComPtr<ID3D11Device>&, const std::string&);
+
+		// 1x1 texture filled with a RGBA8 color (0xAABBGGRR)
+		void CreateSolidColor(Microsoft::WRL::ComPtr<ID3D11Device>&, unsigned int);
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& GetSRV(void);
 
 		const DirectX::SimpleMath::Vector2 GetTextureSize(void);
@@ -13,6 +13,7 @@ namespace Prizm
 		dc->IASetPrimitiveTopology(static_cast<D3D_PRIMITIVE_TOPOLOGY>(_topology));
 
 		dc->DrawIndexed(_index_buffer.desc.element_count, 0, 0);
+		Graphics::CountDrawCall();
 	}
 
 	void Geometry::CleanUp(void)
@@ -30,4 +31,14 @@ namespace Prizm
 
 		_vertex_buffer.Update(Graphics::GetDeviceContext(), static_cast<const void*>(_vertex_2d.data()));
 	}
+
+	void Geometry::SetColor2D(const DirectX::SimpleMath::Vector4& color)
+	{
+		for (auto& vtx : _vertex_2d)
+		{
+			vtx.color = color;
+		}
+
+		_vertex_buffer.Update(Graphics::GetDeviceContext(), static_cast<const void*>(_vertex_2d.data()));
+	}
 }
\ No newline at end of file
@@ -33,7 +33,7 @@ namespace Prizm
 		template<class VertexBufferType>
 		Geometry(const std::vector<VertexBufferType>& vertices, const std::vector<unsigned>& indices, TopologyType topology)
 		{//3D
-			Microsoft::WRL::ComPtr<ID3D11Device> device = Graphics::GetDevice();
+			auto& device = Graphics::GetDevice();
 
 			BufferDesc buffer_desc = {};
 
@@ -58,7 +58,7 @@ namespace Prizm
 		
 		Geometry(const std::vector<VertexBuffer2D>& vertices, const std::vector<unsigned>& indices, BufferUsage vertex_usage)
 		{//2D
-			Microsoft::WRL::ComPtr<ID3D11Device> device = Graphics::GetDevice();
+			auto& device = Graphics::GetDevice();
 
 			BufferDesc buffer_desc = {};
 
@@ -90,5 +90,6 @@ namespace Prizm
 		Buffer GetIndex(void) { return _index_buffer; }
 
 		void MovePosition2DScreenToRatio(float x, float y);
+		void SetColor2D(const DirectX::SimpleMath::Vector4& color);
 	};
 }
\ No newline at end of file
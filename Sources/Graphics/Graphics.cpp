@@ -2,6 +2,7 @@
 #include<string>
 #include<vector>
 #include<DirectXTK/SimpleMath.h>
+#include<dxgi1_3.h>
 
 #include"Graphics.h"
 #include"ConstantBuffer.h"
@@ -11,6 +12,7 @@
 #include"..\Utilities\ResourcePool.h"
 #include"..\Utilities\Utils.h"
 #include"..\Utilities\Log.h"
+#include"..\Utilities\FrameArena.h"
 
 namespace Prizm
 {
@@ -19,6 +21,7 @@ namespace Prizm
 		Microsoft::WRL::ComPtr<ID3D11Device>                         _device;
 		Microsoft::WRL::ComPtr<ID3D11DeviceContext>                  _device_context;
 		Microsoft::WRL::ComPtr<IDXGISwapChain>                       _swap_chain;
+		Microsoft::WRL::ComPtr<IDXGISwapChain2>                      _swap_chain2;	// flip model only
 
 		std::vector<Microsoft::WRL::ComPtr<ID3D11RenderTargetView>>  _render_targets;
 		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>             _shadow_resource;
@@ -53,6 +56,15 @@ namespace Prizm
 		unsigned int _numerator, _denominator;
 		bool         _fullscreen;
 
+		// frame pacing
+		bool         _flip_model;
+		HANDLE       _frame_latency_waitable;
+		unsigned int _max_frame_latency;
+
+		// counted on the render thread, latched in EndFrame
+		RenderStats  _render_stats;
+		RenderStats  _last_render_stats;
+
 		void MSAASampleCheck(void)
 		{
 			_sample_desc = {};
@@ -234,8 +246,6 @@ namespace Prizm
 			DXGI_SWAP_CHAIN_DESC swap_chain_desc;
 			memset(&swap_chain_desc, 0, sizeof(swap_chain_desc));
 
-			swap_chain_desc.BufferCount = 3;
-
 			swap_chain_desc.BufferDesc.Width = window_width<int>;
 			swap_chain_desc.BufferDesc.Height = window_height<int>;
 			swap_chain_desc.BufferDesc.Format = static_cast<DXGI_FORMAT>(ImageFormat::RGBA8UN);
@@ -258,14 +268,27 @@ namespace Prizm
 
 			swap_chain_desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT | DXGI_USAGE_SHADER_INPUT;
 			swap_chain_desc.SampleDesc = _sample_desc;
-			swap_chain_desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
-			swap_chain_desc.Flags = 0;
 
-			// Create the swap chain.
-			HRESULT result = _factory->CreateSwapChain(
-				_device.Get(),
-				&swap_chain_desc,
-				_swap_chain.GetAddressOf());
+			// flip model with a waitable swap chain, older systems fall back to the blt model
+			const DXGI_SWAP_EFFECT swap_effects[] = { DXGI_SWAP_EFFECT_FLIP_DISCARD, DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL, DXGI_SWAP_EFFECT_DISCARD };
+			HRESULT result = E_FAIL;
+
+			for (auto swap_effect : swap_effects)
+			{
+				_flip_model = swap_effect != DXGI_SWAP_EFFECT_DISCARD;
+
+				swap_chain_desc.BufferCount = _flip_model ? 2 : 3;
+				swap_chain_desc.SwapEffect = swap_effect;
+				swap_chain_desc.Flags = _flip_model ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
+
+				// Create the swap chain.
+				result = _factory->CreateSwapChain(
+					_device.Get(),
+					&swap_chain_desc,
+					_swap_chain.ReleaseAndGetAddressOf());
+
+				if (succeeded(result)) break;
+			}
 
 			Log::Info("Swapchain create process done.");
 
@@ -275,6 +298,18 @@ namespace Prizm
 				return false;
 			}
 
+			if (_flip_model && succeeded(_swap_chain.As(&_swap_chain2)))
+			{
+				_frame_latency_waitable = _swap_chain2->GetFrameLatencyWaitableObject();
+				Log::Info("Flip model swap chain with frame latency waitable object.");
+			}
+			else
+			{
+				Log::Warning("Flip model unavailable, frame latency is not waitable.");
+			}
+
+			SetMaximumFrameLatency(_max_frame_latency);
+
 #ifdef _DEBUG
 			// Direct3D SDK Debug Layer
 			//------------------------------------------------------------------------------------------
@@ -764,6 +799,9 @@ namespace Prizm
 		{
 			_vsync_enabled = false;
 			_fullscreen = false;
+			_flip_model = false;
+			_frame_latency_waitable = nullptr;
+			_max_frame_latency = DEFAULT_MAX_FRAME_LATENCY;
 			_window_width = _window_height = _numerator = _denominator = 0;
 
 			for (int i = 0; i < static_cast<int>(RasterizerStateType::RASTERIZER_STATE_MAX); ++i)
@@ -823,6 +861,14 @@ namespace Prizm
 		{
 			ReportLiveObjects("Finalize call.");
 
+			if (_frame_latency_waitable)
+			{
+				CloseHandle(_frame_latency_waitable);
+				_frame_latency_waitable = nullptr;
+			}
+
+			_swap_chain2.Reset();
+
 			if (_swap_chain)
 			{
 				_swap_chain->SetFullscreenState(false, nullptr);
@@ -869,6 +915,10 @@ namespace Prizm
 
 		void BeginFrame(void)
 		{
+			// flip model unbinds the back buffer on Present
+			if (_flip_model)
+				_device_context->OMSetRenderTargets(1, _render_targets[RenderTargetType::BACK_BUFFER].GetAddressOf(), _depth_stencil_view.Get());
+
 			float clear_color[4] = { 0.0f, 0.125f, 0.3f, 1.0f }; //red, green, blue, alpha
 			_device_context->ClearRenderTargetView(_render_targets[RenderTargetType::BACK_BUFFER].Get(), clear_color);
 			_device_context->ClearDepthStencilView(_depth_stencil_view.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
@@ -885,6 +935,12 @@ namespace Prizm
 			_device_context->DSSetShader(nullptr, nullptr, 0);
 			_device_context->PSSetShader(nullptr, nullptr, 0);
 			_device_context->CSSetShader(nullptr, nullptr, 0);
+
+			// frame temporaries are dead after present
+			FrameArena::NextFrame();
+
+			_last_render_stats = _render_stats;
+			_render_stats = RenderStats();
 		}
 
 		bool ChangeWindowMode(void)
@@ -919,6 +975,34 @@ namespace Prizm
 			return true;
 		}
 
+		void WaitForFrameLatency(void)
+		{
+			if (!_frame_latency_waitable) return;
+
+			// bounded so a lost device cannot hang the game loop
+			WaitForSingleObjectEx(_frame_latency_waitable, 1000, TRUE);
+		}
+
+		bool SetMaximumFrameLatency(unsigned int max_latency)
+		{
+			if (max_latency == 0) return false;
+
+			_max_frame_latency = max_latency;
+
+			if (_swap_chain2)
+				return succeeded(_swap_chain2->SetMaximumFrameLatency(max_latency));
+
+			// blt model, the device limit applies instead
+			Microsoft::WRL::ComPtr<IDXGIDevice1> dxgi_device;
+			if (!_device || failed(_device.As(&dxgi_device))) return false;
+
+			return succeeded(dxgi_device->SetMaximumFrameLatency(max_latency));
+		}
+
+		unsigned int GetMaximumFrameLatency(void) { return _max_frame_latency; }
+
+		bool IsFlipModel(void) { return _flip_model; }
+
 		void SetRenderTarget(RenderTargetType type)
 		{
 			_device_context->OMSetRenderTargets(1, _render_targets[type].GetAddressOf(), _depth_stencil_view.Get());
@@ -947,17 +1031,20 @@ namespace Prizm
 
 		void SetBlendState(BlendStateType type)
 		{
+			CountStateChange();
 			float blendFactor[4] = { D3D11_BLEND_ZERO, D3D11_BLEND_ZERO, D3D11_BLEND_ZERO, D3D11_BLEND_ZERO };
 			_device_context->OMSetBlendState(_blend_states[type].Get(), blendFactor, 0xffffffff);
 		}
 
 		void SetRasterizerState(RasterizerStateType type)
 		{
+			CountStateChange();
 			_device_context->RSSetState(_rasterizer_states[type].Get());
 		}
 
 		void SetDepthStencilState(DepthStencilStateType type)
 		{
+			CountStateChange();
 			_device_context->OMSetDepthStencilState(_depth_stencil_states[type].Get(), 0);
 		}
 
@@ -968,6 +1055,7 @@ namespace Prizm
 
 		void SetSamplerState(unsigned int shader_type, SamplerStateType ss_type, unsigned int register_slot)
 		{
+			CountStateChange();
 			switch (shader_type)
 			{
 			case ShaderType::VS:
@@ -993,9 +1081,16 @@ namespace Prizm
 
 		void SetPSTexture(UINT register_slot, UINT num_views, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& srv)
 		{
+			CountStateChange();
 			_device_context->PSSetShaderResources(register_slot, num_views, srv.GetAddressOf());
 		}
 
+		void CountDrawCall(void) { ++_render_stats.draw_calls; }
+
+		void CountStateChange(void) { ++_render_stats.state_changes; }
+
+		const RenderStats& GetRenderStats(void) { return _last_render_stats; }
+
 		Microsoft::WRL::ComPtr<ID3D11Device>& GetDevice(void) { return _device; }
 
 		Microsoft::WRL::ComPtr<ID3D11DeviceContext>& GetDeviceContext(void) { return _device_context; }
@@ -68,8 +68,18 @@ namespace Prizm
 		RENDER_TARGET_MAX
 	};
 
+	// per frame counters for the performance HUD
+	struct RenderStats
+	{
+		unsigned int draw_calls;
+		unsigned int state_changes;
+	};
+
 	namespace Graphics
 	{
+		// frames the CPU may queue ahead of the GPU, lower means less input latency
+		constexpr unsigned int DEFAULT_MAX_FRAME_LATENCY = 1;
+
 		bool Initialize(int width, int height, const bool vsync, HWND hwnd, const bool FULL_SCREEN);
 		void Finalize(void);
 
@@ -78,6 +88,13 @@ namespace Prizm
 
 		bool ChangeWindowMode(void);
 
+		// block until the swap chain can take another frame
+		// call before pumping messages and Input::PreStateUpdate, input sampled before the wait ages by it
+		void WaitForFrameLatency(void);
+		bool SetMaximumFrameLatency(unsigned int);
+		unsigned int GetMaximumFrameLatency(void);
+		bool IsFlipModel(void);
+
 		void SetRenderTarget(RenderTargetType);
 		void ClearRenderTargetView(RenderTargetType, const float*);
 		void ClearDepthStencilView(void);
@@ -95,6 +112,12 @@ namespace Prizm
 		Microsoft::WRL::ComPtr<ID3D11Device>&			GetDevice(void);
 		Microsoft::WRL::ComPtr<ID3D11DeviceContext>&	GetDeviceContext(void);
 		HWND GetWindowHandle(void);
+
+		void CountDrawCall(void);
+		void CountStateChange(void);
+
+		// counters of the last presented frame
+		const RenderStats& GetRenderStats(void);
 	}
 }
 
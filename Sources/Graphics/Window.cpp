@@ -1,7 +1,12 @@
 
+#ifdef _WIN32
+
 #include<vector>
+#include<algorithm>
 
 #include<Windows.h>
+#include<Xinput.h>
+#pragma comment(lib, "Xinput9_1_0.lib")
 
 #include"Window.h"
 
@@ -22,6 +27,69 @@ namespace Prizm
 		HWND		_window_handle;
 		int			_screen_width, _screen_height;
 		bool		_multi_touch_enable;
+		Mode		_mode = WINDOWED;
+
+		// first XInput pad only
+		WORD		_gamepad_buttons = 0;
+		DWORD		_gamepad_packet = 0;
+		bool		_gamepad_connected = true;
+		ULONGLONG	_gamepad_retry_time = 0;
+
+		float NormalizeThumb(SHORT value, SHORT dead_zone)
+		{
+			const float magnitude = static_cast<float>(value < 0 ? -value : value);
+			if (magnitude <= dead_zone) return 0.0f;
+
+			const float normalized = (std::min)(1.0f, (magnitude - dead_zone) / (32767.0f - dead_zone));
+			return value < 0 ? -normalized : normalized;
+		}
+
+		float NormalizeTrigger(BYTE value)
+		{
+			return value > XINPUT_GAMEPAD_TRIGGER_THRESHOLD ? (value - XINPUT_GAMEPAD_TRIGGER_THRESHOLD) / (255.0f - XINPUT_GAMEPAD_TRIGGER_THRESHOLD) : 0.0f;
+		}
+
+		void PollGamepad(void)
+		{
+			// XInputGetState on an empty slot costs far more than a frame should, look again once a second
+			if (!_gamepad_connected && GetTickCount64() < _gamepad_retry_time) return;
+
+			XINPUT_STATE state = {};
+			const bool connected = XInputGetState(0, &state) == ERROR_SUCCESS;
+
+			if (!connected)
+			{
+				_gamepad_retry_time = GetTickCount64() + 1000;
+				if (!_gamepad_connected) return;
+			}
+			else if (_gamepad_connected && state.dwPacketNumber == _gamepad_packet)
+			{
+				return;
+			}
+
+			_gamepad_connected = connected;
+			_gamepad_packet = state.dwPacketNumber;
+
+			// a disconnect releases everything with the zeroed state
+			const WORD changed = state.Gamepad.wButtons ^ _gamepad_buttons;
+
+			for (KeyCode bit = 0; bit < 16; ++bit)
+			{
+				if (!((changed >> bit) & 1)) continue;
+
+				if ((state.Gamepad.wButtons >> bit) & 1) Input::GamepadButtonDown(bit);
+				else Input::GamepadButtonUp(bit);
+			}
+
+			_gamepad_buttons = state.Gamepad.wButtons;
+
+			Input::UpdateGamepadAxis(Input::PAD_LEFT_X, NormalizeThumb(state.Gamepad.sThumbLX, XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE));
+			Input::UpdateGamepadAxis(Input::PAD_LEFT_Y, NormalizeThumb(state.Gamepad.sThumbLY, XINPUT_GAMEPAD_LEFT_THUMB_DEADZONE));
+			Input::UpdateGamepadAxis(Input::PAD_RIGHT_X, NormalizeThumb(state.Gamepad.sThumbRX, XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE));
+			Input::UpdateGamepadAxis(Input::PAD_RIGHT_Y, NormalizeThumb(state.Gamepad.sThumbRY, XINPUT_GAMEPAD_RIGHT_THUMB_DEADZONE));
+			Input::UpdateGamepadAxis(Input::PAD_LEFT_TRIGGER, NormalizeTrigger(state.Gamepad.bLeftTrigger));
+			Input::UpdateGamepadAxis(Input::PAD_RIGHT_TRIGGER, NormalizeTrigger(state.Gamepad.bRightTrigger));
+		}
 
 		void InitRawInputDevices(void)
 		{
@@ -128,7 +196,8 @@ namespace Prizm
 			// keyboards
 		case WM_KEYDOWN:
 			Input::KeyDown(static_cast<KeyCode>(w_param));
-			if (Input::IsKeyTriggered("F1") && !Input::IsMouseCaptured()) Input::CaptureMouse(window_handle, true);
+			// the key state only changes at the start of the next frame, look at the raw key
+			if (w_param == PRIZM_KEY("F1") && !Input::IsMouseCaptured()) Input::CaptureMouse(window_handle, true);
 			break;
 
 		case WM_KEYUP:
@@ -203,8 +272,10 @@ namespace Prizm
 		return 0;
 	}
 
-	bool Window::Initialize(void)
+	bool Window::Initialize(Mode mode)
 	{
+		_mode = mode;
+
 		WNDCLASSEX  wc;
 
 		memset(&wc, 0, sizeof(wc));
@@ -244,6 +315,13 @@ namespace Prizm
 			return false;
 		}
 
+		// headless keeps the hidden window, the swap chain still needs one
+		if (_mode == HEADLESS)
+		{
+			Log::Info("Window initialize succeeded, headless.");
+			return true;
+		}
+
 		InitRawInputDevices();
 
 		ShowWindow(_window_handle, SW_SHOW);
@@ -264,8 +342,37 @@ namespace Prizm
 		Log::Info("Window finalize succeeded. Bye~~~");
 	}
 
+	bool Window::PumpMessages(void)
+	{
+		MSG msg = {};
+
+		while (PeekMessageA(&msg, nullptr, 0, 0, PM_REMOVE))
+		{
+			if (msg.message == WM_QUIT) return false;
+
+			TranslateMessage(&msg);
+			DispatchMessageA(&msg);
+		}
+
+		if (_mode != HEADLESS) PollGamepad();
+
+		return true;
+	}
+
+	bool Window::IsHeadless(void)
+	{
+		return _mode == HEADLESS;
+	}
+
+	void* Window::GetNativeHandle(void)
+	{
+		return _window_handle;
+	}
+
 	HWND Window::GetWindowHandle(void)
 	{
 		return _window_handle;
 	}
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
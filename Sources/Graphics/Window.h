@@ -1,9 +1,12 @@
 #pragma once
 
-#include<windows.h>
 #include<string>
 #include<memory>
 
+#ifdef _WIN32
+#include<windows.h>
+#endif
+
 namespace Prizm
 {
 	template<typename _Type>
@@ -15,11 +18,28 @@ namespace Prizm
 	template<typename _Type>
 	constexpr _Type window_height = 1080;
 
+	// Win32 in Window.cpp, X11 or headless in Window_Linux.cpp
 	namespace Window
 	{
-		bool Initialize(void);
+		enum Mode
+		{
+			WINDOWED,
+			HEADLESS,	// never shown and no input, for perf runs on machines without a desktop
+		};
+
+		bool Initialize(Mode mode = WINDOWED);
 		void Finalize(void);
 
+		// dispatches every pending event, false once the application was asked to quit
+		bool PumpMessages(void);
+
+		bool IsHeadless(void);
+
+		// HWND on Windows, X11 Window id on Linux, null when headless without a window
+		void* GetNativeHandle(void);
+
+#ifdef _WIN32
 		HWND GetWindowHandle(void);
+#endif
 	};
-}
\ No newline at end of file
+}
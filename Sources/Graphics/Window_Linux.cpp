@@ -0,0 +1,291 @@
+#ifndef _WIN32
+
+#include<csignal>
+#include<atomic>
+
+// X11 window when the headers are there, otherwise every window is headless
+#ifndef PRIZM_WINDOW_X11
+#if defined(__has_include)
+#if __has_include(<X11/Xlib.h>)
+#define PRIZM_WINDOW_X11 1
+#endif
+#endif
+#endif
+
+#ifndef PRIZM_WINDOW_X11
+#define PRIZM_WINDOW_X11 0
+#endif
+
+#if PRIZM_WINDOW_X11
+#include<X11/Xlib.h>
+#include<X11/Xutil.h>
+#include<X11/keysym.h>
+#endif
+
+#include"Window.h"
+
+#include"../Input/Input.h"
+#include"../Utilities/Log.h"
+#include"../Utilities/Platform.h"
+
+namespace Prizm
+{
+	namespace Window
+	{
+		Mode _mode = WINDOWED;
+
+		// SIGINT / SIGTERM end the message loop, the only way to stop a headless run early
+		std::atomic<bool> _quit_requested(false);
+
+		void OnQuitSignal(int)
+		{
+			_quit_requested = true;
+		}
+
+#if PRIZM_WINDOW_X11
+		Display*	_display = nullptr;
+		::Window	_window = 0;
+		Atom		_delete_message = 0;
+		int			_last_x = 0, _last_y = 0;
+
+		// same virtual-key codes the Win32 window reports
+		KeyCode ToKeyCode(KeySym sym)
+		{
+			if (sym >= XK_a && sym <= XK_z) return static_cast<KeyCode>('A' + (sym - XK_a));
+			if (sym >= XK_A && sym <= XK_Z) return static_cast<KeyCode>('A' + (sym - XK_A));
+			if (sym >= XK_0 && sym <= XK_9) return static_cast<KeyCode>('0' + (sym - XK_0));
+			if (sym >= XK_F1 && sym <= XK_F12) return static_cast<KeyCode>(112 + (sym - XK_F1));
+			if (sym >= XK_KP_0 && sym <= XK_KP_9) return static_cast<KeyCode>(96 + (sym - XK_KP_0));
+
+			switch (sym)
+			{
+			case XK_BackSpace:	return 8;
+			case XK_Tab:		return 9;
+			case XK_Return:		return 13;
+			case XK_Shift_L:
+			case XK_Shift_R:	return 16;
+			case XK_Control_L:
+			case XK_Control_R:	return 17;
+			case XK_Alt_L:
+			case XK_Alt_R:		return 18;
+			case XK_Escape:		return 27;
+			case XK_space:		return 32;
+			case XK_Prior:		return 33;
+			case XK_Next:		return 34;
+			case XK_End:		return 35;
+			case XK_Home:		return 36;
+			case XK_Left:		return 37;
+			case XK_Up:			return 38;
+			case XK_Right:		return 39;
+			case XK_Down:		return 40;
+			case XK_Insert:		return 45;
+			case XK_Delete:		return 46;
+			default:			return 0;
+			}
+		}
+
+		// X11 buttons 1, 2, 3 are left, middle, right
+		KeyCode ToButtonCode(unsigned int button)
+		{
+			switch (button)
+			{
+			case Button1: return 1;
+			case Button2: return 4;
+			case Button3: return 2;
+			default: return 0;
+			}
+		}
+
+		void SetPointerGrab(bool grab)
+		{
+			if (grab)
+			{
+				XGrabPointer(_display, _window, True, PointerMotionMask | ButtonPressMask | ButtonReleaseMask,
+					GrabModeAsync, GrabModeAsync, _window, None, CurrentTime);
+			}
+			else
+			{
+				XUngrabPointer(_display, CurrentTime);
+			}
+		}
+
+		bool CreateX11Window(void)
+		{
+			_display = XOpenDisplay(nullptr);
+
+			if (!_display)
+			{
+				Log::Warning("No X display, running headless.");
+				return false;
+			}
+
+			const int screen = DefaultScreen(_display);
+
+			_window = XCreateSimpleWindow(_display, RootWindow(_display, screen), 0, 0,
+				window_width<unsigned int>, window_height<unsigned int>, 0,
+				BlackPixel(_display, screen), BlackPixel(_display, screen));
+
+			XStoreName(_display, _window, window_caption<const char*>);
+			XSelectInput(_display, _window, KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask | StructureNotifyMask);
+
+			// the close button arrives as a ClientMessage instead of killing the connection
+			_delete_message = XInternAtom(_display, "WM_DELETE_WINDOW", False);
+			XSetWMProtocols(_display, _window, &_delete_message, 1);
+
+			XMapWindow(_display, _window);
+			XFlush(_display);
+
+			return true;
+		}
+
+		// false when the window asked to quit
+		bool HandleEvent(XEvent& event)
+		{
+			switch (event.type)
+			{
+			case ClientMessage:
+				if (static_cast<Atom>(event.xclient.data.l[0]) == _delete_message
+					&& Platform::Confirm(GetNativeHandle(), "User Notification", "Quit ?"))
+				{
+					Log::Info("[EXIT] BUTTON DOWN x");
+					return false;
+				}
+				break;
+
+				// keyboards
+			case KeyPress:
+				if (auto code = ToKeyCode(XLookupKeysym(&event.xkey, 0)))
+				{
+					Input::KeyDown(code);
+
+					// the key state only changes at the start of the next frame, look at the raw key
+					if (code == PRIZM_KEY("F1") && !Input::IsMouseCaptured())
+					{
+						Input::CaptureMouse(GetNativeHandle(), true);
+						SetPointerGrab(true);
+					}
+				}
+				break;
+
+			case KeyRelease:
+				// auto repeat sends a release right before the next press, the state still ends up right
+				if (auto code = ToKeyCode(XLookupKeysym(&event.xkey, 0)))
+					Input::KeyUp(code);
+				break;
+
+				// mouse buttons, 4 and 5 are the wheel
+			case ButtonPress:
+				if (event.xbutton.button == Button4 || event.xbutton.button == Button5)
+				{
+					if (Input::IsMouseCaptured()) Input::UpdateMousePos(0, 0, event.xbutton.button == Button4 ? 120 : -120);
+				}
+				else if (Input::IsMouseCaptured())
+				{
+					if (auto code = ToButtonCode(event.xbutton.button)) Input::KeyDown(code);
+				}
+				break;
+
+			case ButtonRelease:
+				if (Input::IsMouseCaptured())
+				{
+					if (auto code = ToButtonCode(event.xbutton.button)) Input::KeyUp(code);
+				}
+				break;
+
+			case MotionNotify:
+				if (Input::IsMouseCaptured())
+					Input::UpdateMousePos(event.xmotion.x - _last_x, event.xmotion.y - _last_y, 0);
+
+				_last_x = event.xmotion.x;
+				_last_y = event.xmotion.y;
+				break;
+
+			default:
+				break;
+			}
+
+			return true;
+		}
+#endif
+	}
+
+	bool Window::Initialize(Mode mode)
+	{
+		_mode = mode;
+
+		std::signal(SIGINT, OnQuitSignal);
+		std::signal(SIGTERM, OnQuitSignal);
+
+#if PRIZM_WINDOW_X11
+		if (_mode == WINDOWED && !CreateX11Window())
+			_mode = HEADLESS;
+#else
+		_mode = HEADLESS;
+#endif
+
+		Log::Info(_mode == HEADLESS ? "Window initialize succeeded, headless." : "Window initialize succeeded.");
+		return true;
+	}
+
+	void Window::Finalize(void)
+	{
+#if PRIZM_WINDOW_X11
+		if (_display)
+		{
+			if (Input::IsMouseCaptured()) SetPointerGrab(false);
+
+			XDestroyWindow(_display, _window);
+			XCloseDisplay(_display);
+
+			_display = nullptr;
+			_window = 0;
+		}
+#endif
+
+		Log::Info("Window finalize succeeded. Bye~~~");
+	}
+
+	bool Window::PumpMessages(void)
+	{
+		if (_quit_requested)
+		{
+			Log::Info("[EXIT] signal");
+			return false;
+		}
+
+#if PRIZM_WINDOW_X11
+		if (!_display) return true;
+
+		// escape already released the capture in the message loop, give the pointer back
+		static bool was_captured = false;
+		if (was_captured && !Input::IsMouseCaptured()) SetPointerGrab(false);
+		was_captured = Input::IsMouseCaptured();
+
+		while (XPending(_display))
+		{
+			XEvent event;
+			XNextEvent(_display, &event);
+
+			if (!HandleEvent(event)) return false;
+		}
+#endif
+
+		return true;
+	}
+
+	bool Window::IsHeadless(void)
+	{
+		return _mode == HEADLESS;
+	}
+
+	void* Window::GetNativeHandle(void)
+	{
+#if PRIZM_WINDOW_X11
+		return reinterpret_cast<void*>(_window);
+#else
+		return nullptr;
+#endif
+	}
+}
+
+#endif
@@ -1,158 +1,236 @@
 
-#include<unordered_map>
+#include<atomic>
+#include<cstring>
+
+#ifdef _WIN32
+#include<Windows.h>
+#endif
 
 #include"Input.h"
+#include"InputAction.h"
+#include"InputRecorder.h"
+#include"../Utilities/Log.h"
+#include"../Utilities/PerfTimer.h"
+#include"../Utilities/FramePacer.h"
+#include"../Utilities/SpscRing.h"
 
 namespace Prizm
 {
 	namespace Input
 	{
-		//keyboard and mouse keys num
-		constexpr int keyscount = 256;
+		// perfect hash over KEY_NAMES, the seed is searched once so that no two names share a slot
+		constexpr std::uint32_t key_slot_count = 4096;
+		constexpr std::uint8_t empty_slot = 0xff;
+
+		static_assert(KEY_NAME_COUNT < empty_slot, "KEY_NAMES outgrew the slot index type.");
+
+		struct KeyHashTable
+		{
+			std::uint32_t seed;
+			std::uint8_t slots[key_slot_count];		// index into KEY_NAMES
+		};
+
+		// case insensitive FNV-1a
+		std::uint32_t HashKeyName(const char* name, std::uint32_t seed)
+		{
+			std::uint32_t hash = 2166136261u ^ seed;
+
+			for (; *name; ++name)
+			{
+				hash ^= static_cast<unsigned char>(ToLowerAscii(*name));
+				hash *= 16777619u;
+			}
 
-		static const std::unordered_map<const char*, KeyCode> key_map_ = []()
+			return hash ^ (hash >> 15);
+		}
+
+		static const KeyHashTable key_table_ = []()
 		{
-			std::unordered_map<const char*, KeyCode> m;
-
-			// mouse button
-			m["LButton"] = m["lbutton"] = 1;
-			m["RButton"] = m["rbutton"] = 2;
-			// center button
-			m["MButton"] = m["mbutton"] = 4;
-
-			// keyboard key
-			m["Backspace"] = m["backspace"] = 8;
-			m["Tab"] = m["tab"] = 9;
-			m["Enter"] = m["enter"] = 13;
-			m["Shift"] = m["shift"] = 16;
-			m["Controll"] = m["controll"] = m["Ctrl"] = m["ctrl"] = 17;
-			m["Alt"] = m["alt"] = 18;
-			m["Escape"] = m["escape"] = m["ESC"] = m["esc"] = 27;
-
-			m["Space"] = m["space"] = 32;
-
-			m["PageUp"] = m["pageup"] = 33;
-			m["PageDown"] = m["pagedown"] = 34;
-
-			m["End"] = m["end"] = 35;
-			m["Home"] = m["home"] = 36;
-
-			m["Left"] = m["left"] = 37;
-			m["Up"] = m["up"] = 38;
-			m["Right"] = m["right"] = 39;
-			m["Down"] = m["down"] = 40;
-
-			m["Select"] = m["select"] = 41;
-			m["Print"] = m["print"] = 42;
-			m["Execute"] = m["execute"] = 43;
-			m["PrintScreen"] = m["printscreen"] = 44;
-			m["Insert"] = m["insert"] = 45;
-			m["Delete"] = m["delete"] = 46;
-			m["Help"] = m["help"] = 47;
-
-			m["0"] = 48;
-			m["1"] = 49;		m["2"] = 50;		m["3"] = 51;
-			m["4"] = 52;		m["5"] = 53;		m["6"] = 54;
-			m["7"] = 55;		m["8"] = 56;		m["9"] = 57;
-
-			m["A"] = m["a"] = 65;
-			m["B"] = m["b"] = 66;
-			m["C"] = m["c"] = 67;
-			m["D"] = m["d"] = 68;
-			m["E"] = m["e"] = 69;
-			m["F"] = m["f"] = 70;
-			m["G"] = m["g"] = 71;
-			m["H"] = m["h"] = 72;
-			m["I"] = m["i"] = 73;
-			m["J"] = m["j"] = 74;
-			m["K"] = m["k"] = 75;
-			m["L"] = m["l"] = 76;
-			m["M"] = m["m"] = 77;
-			m["S"] = m["s"] = 83;
-			m["N"] = m["n"] = 78;
-			m["O"] = m["o"] = 79;
-			m["P"] = m["p"] = 80;
-			m["Q"] = m["q"] = 81;
-			m["R"] = m["r"] = 82;
-			m["T"] = m["t"] = 84;
-			m["U"] = m["u"] = 85;
-			m["V"] = m["v"] = 86;
-			m["W"] = m["w"] = 87;
-			m["X"] = m["x"] = 88;
-			m["Y"] = m["y"] = 89;
-			m["Z"] = m["z"] = 90;
-
-			// Left windows key
-			m["LWindows"] = m["lwindows"] = 91;
-
-			m["Numpad0"] = 96;
-			m["Numpad1"] = 97;		m["Numpad2"] = 98;		m["Numpad3"] = 99;
-			m["Numpad4"] = 100;		m["Numpad5"] = 101;		m["Numpad6"] = 102;
-			m["Numpad7"] = 103;		m["Numpad8"] = 104;		m["Numpad9"] = 105;
-			m["Numpad*"] = m["*"] = 106;
-			m["Numpad+"] = m["+"] = 107;
-			m["Numpad-"] = m["-"] = 109;
-			m["Numpad."] = m["."] = 110;
-			m["Numpad/"] = m["/"] = 111;
-
-			m[","] = 108;
-
-			m["F1"] = 112;			m["F2"] = 113;			m["F3"] = 114;
-			m["F4"] = 115;			m["F5"] = 116;			m["F6"] = 117;
-			m["F7"] = 118;			m["F8"] = 119;			m["F9"] = 120;
-			m["F10"] = 121;			m["F11"] = 122;			m["F12"] = 123;
-
-			m["LShift"] = m["lshift"] = 160;
-			m["RShift"] = m["rshift"] = 161;
-			m["LControll"] = m["lcontroll"] = 162;
-			m["RControll"] = m["rcontroll"] = 163;
-			m["LAlt"] = m["lalt"] = 164;
-			m["RAlt"] = m["ralt"] = 165;
-
-			m[";"] = 186;
-			m["\\"] = 220;
-			m["'"] = 222;
-
-			return m;
+			KeyHashTable table;
+
+			for (table.seed = 0;; ++table.seed)
+			{
+				std::memset(table.slots, empty_slot, sizeof(table.slots));
+
+				bool collided = false;
+
+				for (std::size_t i = 0; i < KEY_NAME_COUNT && !collided; ++i)
+				{
+					auto& slot = table.slots[HashKeyName(KEY_NAMES[i].name, table.seed) & (key_slot_count - 1)];
+
+					// a name listed twice would never stop colliding, KEY_NAMES keeps them unique
+					collided = slot != empty_slot;
+					slot = static_cast<std::uint8_t>(i);
+				}
+
+				if (!collided) return table;
+			}
 		}();
 
+		// raw events recorded by the window thread, applied in PreStateUpdate
+		enum EventType : std::uint8_t
+		{
+			EVENT_KEY_DOWN,
+			EVENT_KEY_UP,
+			EVENT_BUTTON_DOWN,
+			EVENT_BUTTON_UP,
+			EVENT_MOUSE_MOVE,
+			EVENT_TOUCH,
+			EVENT_GAMEPAD_AXIS,
+		};
+
+		struct Event
+		{
+			EventType type;
+			std::uint8_t index;				// touch index, gamepad axis
+			short scroll;
+			KeyCode code;
+			long x, y;
+			float value;					// gamepad axis
+			std::uint32_t flags;			// TOUCH_*
+			PerfTimer::Nanoseconds time;
+		};
+
+		constexpr std::size_t event_capacity = 1024;
+
+		SpscRing<Event, event_capacity> events_;
+		std::atomic<std::uint32_t> dropped_events_(0);
+
+		FramePacer* frame_pacer_ = nullptr;
+
 		// mouse_state
 		bool  mouse_captured = false;
-		POINT capture_position;
+		Point capture_position;
 	
 		// input state
 		bool ignore_input = false;
 
-		// keyboard
-		bool keys[keyscount];			// Included mouse L, R, Center button.
-		bool prev_keys[keyscount];
+		// every code, keyboard with mouse L, R, Center button, gamepad buttons and touches
+		// edge detection is a handful of AND per word instead of a byte per key
+		InputBits keys;
+		InputBits prev_keys;
+		InputBits triggered_keys;		// went down this frame, survives a release inside the same frame
+		InputBits released_keys;
+		InputBits frame_downs;			// every down / up event of this frame
+		InputBits frame_ups;
+
+		std::vector<InputEvent> frame_events;
 
 		// mouse
-		bool buttons[17];
+		std::uint32_t buttons = 0;
 		long mouse_pos[2];
 		long mouse_delta[2];
 		short mouse_scroll = 0;
 
 		// touch
-		POINT touch_position[max_touchcount];
-		POINT prev_touch_position[max_touchcount];
+		Point touch_position[max_touchcount];
+		Point prev_touch_position[max_touchcount];
 		long touch_delta[max_touchcount][2];
-		DWORD touch_state[max_touchcount];
-		DWORD prev_touch_state[max_touchcount];
+		std::uint32_t touch_state[max_touchcount];
+		std::uint32_t prev_touch_state[max_touchcount];
+
+		// gamepad
+		float gamepad_axes[PAD_AXIS_COUNT];
+
+		void PushEvent(const Event& event)
+		{
+			// a lost up event would stick the key, make it visible instead of blocking the window thread
+			if (!events_.Push(event)) dropped_events_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		Event MakeEvent(EventType type)
+		{
+			Event event = {};
+			event.type = type;
+			event.time = PerfTimer::Now();
+			return event;
+		}
+
+		void SetCode(KeyCode code, bool down, PerfTimer::Nanoseconds time)
+		{
+			if (down)
+			{
+				keys.Set(code);
+				frame_downs.Set(code);
+			}
+			else
+			{
+				keys.Reset(code);
+				frame_ups.Set(code);
+			}
+
+			frame_events.push_back({ code, down, time / 1000 });
+		}
+
+		void ApplyEvent(const Event& event)
+		{
+			switch (event.type)
+			{
+			case EVENT_KEY_DOWN:
+				SetCode(event.code, true, event.time);
+				break;
+
+			case EVENT_KEY_UP:
+				SetCode(event.code, false, event.time);
+				break;
+
+			case EVENT_BUTTON_DOWN:
+				buttons |= 1u << event.code;
+				break;
+
+			case EVENT_BUTTON_UP:
+				buttons &= ~(1u << event.code);
+				break;
+
+			case EVENT_MOUSE_MOVE:
+				// raw input sends several moves per frame, the frame delta is their sum
+				mouse_delta[0] += event.x;
+				mouse_delta[1] += event.y;
+				if (event.scroll) mouse_scroll = event.scroll;
+				break;
+
+			case EVENT_TOUCH:
+				touch_position[event.index].x = event.x;
+				touch_position[event.index].y = event.y;
+				touch_state[event.index] |= event.flags;
+
+				if (event.flags & TOUCH_UP)
+					SetCode(TOUCH_BUTTON_BASE + event.index, false, event.time);
+				else if ((event.flags & TOUCH_DOWN) || !keys.Test(TOUCH_BUTTON_BASE + event.index))
+					SetCode(TOUCH_BUTTON_BASE + event.index, true, event.time);
+				break;
+
+			case EVENT_GAMEPAD_AXIS:
+				gamepad_axes[event.index] = event.value;
+				break;
+			}
+		}
 
 		void Initialize(void)
 		{
-			memset(keys, false, sizeof(bool) * keyscount);
-			memset(prev_keys, false, sizeof(bool) * keyscount);
+			keys.Clear();
+			prev_keys.Clear();
+			triggered_keys.Clear();
+			released_keys.Clear();
+			frame_downs.Clear();
+			frame_ups.Clear();
+
+			frame_events.clear();
+			frame_events.reserve(event_capacity);
+
+			for (auto& axis : gamepad_axes) axis = 0.0f;
 
 			memset(mouse_delta, 0, sizeof(long) * 2);
 			memset(mouse_pos, 0, sizeof(long) * 2);
 		}
 
-		void CaptureMouse(HWND window_handle, bool do_capture)
+		void CaptureMouse(void* native_window, bool do_capture)
 		{
 			mouse_captured = do_capture;
 
+#ifdef _WIN32
+			HWND window_handle = static_cast<HWND>(native_window);
+
 			if(do_capture)
 			{
 				RECT rect;
@@ -167,7 +245,11 @@ namespace Prizm
 
 				while (ShowCursor(FALSE) >= 0);
 				ClipCursor(&rect);
-				GetCursorPos(&capture_position);
+
+				POINT cursor;
+				GetCursorPos(&cursor);
+				capture_position.x = cursor.x;
+				capture_position.y = cursor.y;
 				SetForegroundWindow(window_handle);
 				SetFocus(window_handle);
 
@@ -183,40 +265,139 @@ namespace Prizm
 
 				ignore_input = false;
 			}
+#else
+			// the X11 window grabs the pointer itself, see Window_Linux.cpp
+			(void)native_window;
+			ignore_input = false;
+#endif
 		}
 		bool IsMouseCaptured(void) { return mouse_captured; }
-		POINT MouseCapturePosition(void) { return capture_position; }
+		Point MouseCapturePosition(void) { return capture_position; }
+
+		// window thread, any one thread may produce
+		void KeyDown(KeyCode key)
+		{
+			if (key == INVALID_KEY || key >= KEYBOARD_CODE_COUNT) return;
 
-		void KeyDown(KeyCode key) { keys[key] = true; }
-		void KeyUp(KeyCode key) { keys[key] = false; }
+			auto event = MakeEvent(EVENT_KEY_DOWN);
+			event.code = key;
+			PushEvent(event);
+		}
+
+		void KeyUp(KeyCode key)
+		{
+			if (key == INVALID_KEY || key >= KEYBOARD_CODE_COUNT) return;
+
+			auto event = MakeEvent(EVENT_KEY_UP);
+			event.code = key;
+			PushEvent(event);
+		}
+
+		void ButtonDown(KeyCode button)
+		{
+			if (button >= 32) return;
+
+			auto event = MakeEvent(EVENT_BUTTON_DOWN);
+			event.code = button;
+			PushEvent(event);
+		}
+
+		void ButtonUp(KeyCode button)
+		{
+			if (button >= 32) return;
+
+			auto event = MakeEvent(EVENT_BUTTON_UP);
+			event.code = button;
+			PushEvent(event);
+		}
 
-		void ButtonDown(KeyCode button) { buttons[button] = true; }
-		void ButtonUp(KeyCode button) { buttons[button] = false; }
 		void UpdateMousePos(long x, long y, short scroll)
 		{
-			mouse_delta[0] = x;
-			mouse_delta[1] = y;
-			mouse_pos[0] = 0;
-			mouse_pos[1] = 0;
-			mouse_scroll = scroll;
+			auto event = MakeEvent(EVENT_MOUSE_MOVE);
+			event.x = x;
+			event.y = y;
+			event.scroll = scroll;
+			PushEvent(event);
+		}
+
+		void UpdateTouchPos(long x, long y, int count, std::uint32_t flags)
+		{
+			if (count < 0 || count >= max_touchcount) return;
+
+			auto event = MakeEvent(EVENT_TOUCH);
+			event.index = static_cast<std::uint8_t>(count);
+			event.x = x;
+			event.y = y;
+			event.flags = flags;
+			PushEvent(event);
+		}
+
+		void GamepadButtonDown(KeyCode button)
+		{
+			if (button >= TOUCH_BUTTON_BASE - GAMEPAD_BUTTON_BASE) return;
+
+			auto event = MakeEvent(EVENT_KEY_DOWN);
+			event.code = GAMEPAD_BUTTON_BASE + button;
+			PushEvent(event);
+		}
+
+		void GamepadButtonUp(KeyCode button)
+		{
+			if (button >= TOUCH_BUTTON_BASE - GAMEPAD_BUTTON_BASE) return;
+
+			auto event = MakeEvent(EVENT_KEY_UP);
+			event.code = GAMEPAD_BUTTON_BASE + button;
+			PushEvent(event);
+		}
+
+		void UpdateGamepadAxis(GamepadAxis axis, float value)
+		{
+			if (axis < 0 || axis >= PAD_AXIS_COUNT) return;
+
+			auto event = MakeEvent(EVENT_GAMEPAD_AXIS);
+			event.index = static_cast<std::uint8_t>(axis);
+			event.value = value;
+			PushEvent(event);
 		}
 
-		void UpdateTouchPos(long x, long y, int count, DWORD flags)
+		KeyCode FindKeyCode(const char* name)
 		{
-			touch_position[count].x = x;
-			touch_position[count].y = y;
-			touch_state[count] = flags;
+			const auto index = key_table_.slots[HashKeyName(name, key_table_.seed) & (key_slot_count - 1)];
+
+			if (index == empty_slot || !KeyNameEquals(KEY_NAMES[index].name, name)) return INVALID_KEY;
+
+			return KEY_NAMES[index].code;
 		}
 
-		// key state
-		bool IsKeyPress(const char* key){ const KeyCode code = key_map_.at(key); return keys[code] && !ignore_input; }
+		KeyCode FindKeyCode(const std::string& name) { return FindKeyCode(name.c_str()); }
+
+		const char* GetKeyName(KeyCode code)
+		{
+			for (auto& key : KEY_NAMES)
+			{
+				if (key.code == code) return key.name;
+			}
+
+			return nullptr;
+		}
 
-		bool IsKeyReleased(const char* key) { const KeyCode code = key_map_.at(key); return (!keys[code] && prev_keys[code]) && !ignore_input; }
+		// key state, INVALID_KEY is never set so unknown names read as released
+		bool IsKeyPress(KeyCode code) { return keys.Test(code) && !ignore_input; }
 
-		bool IsKeyTriggered(const char* key) { const KeyCode code = key_map_.at(key); return !prev_keys[code] && keys[code] && !ignore_input; }
+		bool IsKeyReleased(KeyCode code) { return released_keys.Test(code) && !ignore_input; }
+
+		bool IsKeyTriggered(KeyCode code) { return triggered_keys.Test(code) && !ignore_input; }
+
+		bool IsKeyPress(const char* key) { return IsKeyPress(FindKeyCode(key)); }
+
+		bool IsKeyReleased(const char* key) { return IsKeyReleased(FindKeyCode(key)); }
+
+		bool IsKeyTriggered(const char* key) { return IsKeyTriggered(FindKeyCode(key)); }
 
 		// mouse state
-		bool IsMousePress(const char* button) { const KeyCode code = key_map_.at(button); return buttons[code] && !ignore_input; }
+		bool IsMousePress(KeyCode button) { return button < 32 && (buttons >> button & 1) && !ignore_input; }
+
+		bool IsMousePress(const char* button) { return IsMousePress(FindKeyCode(button)); }
 
 		bool IsScrollUp(void) { return mouse_scroll > 0 && !ignore_input; }
 		bool IsScrollDown(void) { return mouse_scroll < 0 && !ignore_input; }
@@ -225,10 +406,10 @@ namespace Prizm
 		int  MouseDeltaX(void) { return !ignore_input ? mouse_delta[0] : 0; }
 
 		// touch state
-		bool IsTouchPress(int count) { return touch_state[count] & (TOUCHEVENTF_DOWN | TOUCHEVENTF_MOVE); }
-		bool IsTouchMove(int count) { return touch_state[count] & TOUCHEVENTF_MOVE; }
-		bool IsTouchReleased(int count) { return touch_state[count] & TOUCHEVENTF_UP; }
-		bool IsTouchTriggered(int count) { return touch_state[count] & TOUCHEVENTF_DOWN; }
+		bool IsTouchPress(int count) { return (touch_state[count] & (TOUCH_DOWN | TOUCH_MOVE)) != 0; }
+		bool IsTouchMove(int count) { return (touch_state[count] & TOUCH_MOVE) != 0; }
+		bool IsTouchReleased(int count) { return (touch_state[count] & TOUCH_UP) != 0; }
+		bool IsTouchTriggered(int count) { return (touch_state[count] & TOUCH_DOWN) != 0; }
 
 		int  TouchDeltaX(int count)
 		{
@@ -253,10 +434,140 @@ namespace Prizm
 			return touch_delta[count];
 		}
 
+		// consumer side, start of frame
+		void CaptureFrameState(FrameState& state)
+		{
+			state.keys = keys;
+			state.downs = frame_downs;
+			state.ups = frame_ups;
+			state.mouse_delta[0] = mouse_delta[0];
+			state.mouse_delta[1] = mouse_delta[1];
+			state.mouse_scroll = mouse_scroll;
+
+			for (int i = 0; i < max_touchcount; ++i)
+			{
+				state.touch_position[i] = touch_position[i];
+				state.touch_state[i] = touch_state[i];
+			}
+
+			std::memcpy(state.gamepad_axes, gamepad_axes, sizeof(gamepad_axes));
+		}
+
+		// the recording only has the sets of the frame, the events come out per code in an order
+		// that ends in the recorded state, the order between different codes is lost
+		void ApplyRecordedFrame(void)
+		{
+			FrameState state;
+			if (!InputRecorder::ReadFrame(state)) return;
+
+			const auto time = PerfTimer::Now();
+
+			for (std::size_t i = 0; i < InputBits::WORD_COUNT; ++i)
+			{
+				const std::uint64_t changed = state.downs.words[i] | state.ups.words[i];
+				if (!changed) continue;
+
+				for (KeyCode bit = 0; bit < 64; ++bit)
+				{
+					if (!((changed >> bit) & 1)) continue;
+
+					const KeyCode code = static_cast<KeyCode>(i * 64) + bit;
+					const bool down = state.downs.Test(code);
+					const bool up = state.ups.Test(code);
+					const bool ends_down = state.keys.Test(code);
+
+					if (down && up)
+					{
+						SetCode(code, !ends_down, time);
+						SetCode(code, ends_down, time);
+					}
+					else
+					{
+						SetCode(code, down, time);
+					}
+				}
+			}
+
+			// SetCode only follows the transitions, the recorded state is the truth
+			keys = state.keys;
+			frame_downs = state.downs;
+			frame_ups = state.ups;
+
+			mouse_delta[0] = state.mouse_delta[0];
+			mouse_delta[1] = state.mouse_delta[1];
+			mouse_scroll = state.mouse_scroll;
+
+			for (int i = 0; i < max_touchcount; ++i)
+			{
+				touch_state[i] = state.touch_state[i];
+				if (touch_state[i]) touch_position[i] = state.touch_position[i];
+			}
+
+			std::memcpy(gamepad_axes, state.gamepad_axes, sizeof(gamepad_axes));
+		}
+
+		void SetFramePacer(FramePacer* frame_pacer)
+		{
+			frame_pacer_ = frame_pacer;
+		}
+
+		void PreStateUpdate(void)
+		{
+			// latency counts from here, the state the frame acts on is latched below
+			if (frame_pacer_) frame_pacer_->MarkInputSampled();
+
+			if (InputRecorder::IsReplaying())
+			{
+				// the recording is the only source, whatever the window sends is dropped
+				while (events_.Front()) events_.PopFront();
+
+				ApplyRecordedFrame();
+			}
+			else
+			{
+				while (auto event = events_.Front())
+				{
+					ApplyEvent(*event);
+					events_.PopFront();
+				}
+			}
+
+			if (auto dropped = dropped_events_.exchange(0, std::memory_order_relaxed))
+				Log::Warning(PRIZM_FMT("Input event queue full, {} events dropped."), dropped);
+
+			// a tap inside one frame still triggers and releases, auto repeat of a held key does not trigger again
+			for (std::size_t i = 0; i < InputBits::WORD_COUNT; ++i)
+			{
+				triggered_keys.words[i] = frame_downs.words[i] & ~prev_keys.words[i];
+				released_keys.words[i] = (frame_ups.words[i] | prev_keys.words[i]) & ~keys.words[i];
+			}
+
+			if (InputRecorder::IsRecording())
+			{
+				FrameState state;
+				CaptureFrameState(state);
+				InputRecorder::WriteFrame(state);
+			}
+
+			UpdateActions();
+		}
+
+		bool IsGamepadPress(KeyCode button) { return keys.Test(GAMEPAD_BUTTON_BASE + button) && !ignore_input; }
+
+		float GamepadAxisValue(GamepadAxis axis) { return !ignore_input ? gamepad_axes[axis] : 0.0f; }
+
+		const InputBits& GetInputBits(void) { return keys; }
+		const InputBits& GetPrevInputBits(void) { return prev_keys; }
+
+		const std::vector<InputEvent>& GetFrameEvents(void) { return frame_events; }
+
 		// update end of frame
 		void PostStateUpdate(void)
 		{
-			memcpy(prev_keys, keys, sizeof(bool) * keyscount);
+			prev_keys = keys;
+			frame_downs.Clear();
+			frame_ups.Clear();
+			frame_events.clear();
 			mouse_delta[0] = mouse_delta[1] = 0;
 			mouse_scroll = 0;
 
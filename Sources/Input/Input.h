@@ -1,15 +1,34 @@
 #pragma once
 
 #include<string>
-#include<Windows.h>
+#include<vector>
+#include<cstddef>
+#include<cstdint>
 
 /*
 Mouse and touch input has raw input data.
-These need initialized in WinAPI's event handler.
+These are fed by the platform window's event handler, see Graphics/Window.h.
+Key codes are Win32 virtual-key codes on every platform.
+
+The update functions only queue a timestamped event on a lock-free ring,
+one thread (the one pumping the window) may feed it while the game thread reads.
+PreStateUpdate applies the queue, so the state is stable for the whole frame.
+
+Key names are resolved at compile time, the queries are a plain array index:
+
+	if (Input::IsKeyPress(PRIZM_KEY("W"))) ...
+
+Names are case insensitive and an unknown name does not compile.
+Strings that only exist at runtime (config files) go through FindKeyCode.
 */
 
+// compile time key name to KeyCode
+#define PRIZM_KEY(name) ::Prizm::Input::CheckedKeyCode<::Prizm::Input::KeyCodeOf(name)>()
+
 namespace Prizm
 {
+	class FramePacer;
+
 	using KeyCode = unsigned int;
 	
 	namespace Input
@@ -17,14 +36,195 @@ namespace Prizm
 		// multi touch num
 		constexpr int max_touchcount = 2;
 
+		// touch flags, same values as TOUCHEVENTF_*
+		constexpr std::uint32_t TOUCH_MOVE = 0x0001;
+		constexpr std::uint32_t TOUCH_DOWN = 0x0002;
+		constexpr std::uint32_t TOUCH_UP = 0x0004;
+
+		struct Point
+		{
+			long x, y;
+		};
+
+		constexpr KeyCode INVALID_KEY = 0;
+
+		// every digital input shares one code space, keyboard and mouse buttons are 0 - 255
+		constexpr KeyCode KEYBOARD_CODE_COUNT = 256;
+		constexpr KeyCode GAMEPAD_BUTTON_BASE = 256;	// + XInput button bit index
+		constexpr KeyCode TOUCH_BUTTON_BASE = 272;		// + touch index
+		constexpr KeyCode INPUT_CODE_COUNT = 320;
+
+		enum GamepadAxis
+		{
+			PAD_LEFT_X,
+			PAD_LEFT_Y,
+			PAD_RIGHT_X,
+			PAD_RIGHT_Y,
+			PAD_LEFT_TRIGGER,
+			PAD_RIGHT_TRIGGER,
+			PAD_AXIS_COUNT,
+		};
+
+		struct KeyName
+		{
+			const char* name;
+			KeyCode code;
+		};
+
+		constexpr KeyName KEY_NAMES[] =
+		{
+			// mouse button
+			{ "LButton", 1 }, { "RButton", 2 },
+			// center button
+			{ "MButton", 4 },
+
+			// keyboard key
+			{ "Backspace", 8 }, { "Tab", 9 }, { "Enter", 13 },
+			{ "Shift", 16 }, { "Controll", 17 }, { "Ctrl", 17 }, { "Alt", 18 },
+			{ "Escape", 27 }, { "ESC", 27 },
+
+			{ "Space", 32 },
+			{ "PageUp", 33 }, { "PageDown", 34 },
+			{ "End", 35 }, { "Home", 36 },
+			{ "Left", 37 }, { "Up", 38 }, { "Right", 39 }, { "Down", 40 },
+
+			{ "Select", 41 }, { "Print", 42 }, { "Execute", 43 }, { "PrintScreen", 44 },
+			{ "Insert", 45 }, { "Delete", 46 }, { "Help", 47 },
+
+			{ "0", 48 }, { "1", 49 }, { "2", 50 }, { "3", 51 }, { "4", 52 },
+			{ "5", 53 }, { "6", 54 }, { "7", 55 }, { "8", 56 }, { "9", 57 },
+
+			{ "A", 65 }, { "B", 66 }, { "C", 67 }, { "D", 68 }, { "E", 69 }, { "F", 70 }, { "G", 71 },
+			{ "H", 72 }, { "I", 73 }, { "J", 74 }, { "K", 75 }, { "L", 76 }, { "M", 77 }, { "N", 78 },
+			{ "O", 79 }, { "P", 80 }, { "Q", 81 }, { "R", 82 }, { "S", 83 }, { "T", 84 }, { "U", 85 },
+			{ "V", 86 }, { "W", 87 }, { "X", 88 }, { "Y", 89 }, { "Z", 90 },
+
+			// Left windows key
+			{ "LWindows", 91 },
+
+			{ "Numpad0", 96 }, { "Numpad1", 97 }, { "Numpad2", 98 }, { "Numpad3", 99 }, { "Numpad4", 100 },
+			{ "Numpad5", 101 }, { "Numpad6", 102 }, { "Numpad7", 103 }, { "Numpad8", 104 }, { "Numpad9", 105 },
+			{ "Numpad*", 106 }, { "*", 106 },
+			{ "Numpad+", 107 }, { "+", 107 },
+			{ ",", 108 },
+			{ "Numpad-", 109 }, { "-", 109 },
+			{ "Numpad.", 110 }, { ".", 110 },
+			{ "Numpad/", 111 }, { "/", 111 },
+
+			{ "F1", 112 }, { "F2", 113 }, { "F3", 114 }, { "F4", 115 }, { "F5", 116 }, { "F6", 117 },
+			{ "F7", 118 }, { "F8", 119 }, { "F9", 120 }, { "F10", 121 }, { "F11", 122 }, { "F12", 123 },
+
+			{ "LShift", 160 }, { "RShift", 161 },
+			{ "LControll", 162 }, { "RControll", 163 },
+			{ "LAlt", 164 }, { "RAlt", 165 },
+
+			{ ";", 186 }, { "\\", 220 }, { "'", 222 },
+
+			// gamepad, same bit order as XINPUT_GAMEPAD_*
+			{ "PadUp", 256 }, { "PadDown", 257 }, { "PadLeft", 258 }, { "PadRight", 259 },
+			{ "PadStart", 260 }, { "PadBack", 261 }, { "PadLThumb", 262 }, { "PadRThumb", 263 },
+			{ "PadLB", 264 }, { "PadRB", 265 },
+			{ "PadA", 268 }, { "PadB", 269 }, { "PadX", 270 }, { "PadY", 271 },
+
+			// held while the finger is down
+			{ "Touch0", 272 }, { "Touch1", 273 },
+		};
+
+		constexpr std::size_t KEY_NAME_COUNT = sizeof(KEY_NAMES) / sizeof(KEY_NAMES[0]);
+
+		constexpr char ToLowerAscii(char c)
+		{
+			return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+		}
+
+		constexpr bool KeyNameEquals(const char* lhs, const char* rhs)
+		{
+			while (*lhs && ToLowerAscii(*lhs) == ToLowerAscii(*rhs))
+			{
+				++lhs;
+				++rhs;
+			}
+
+			return ToLowerAscii(*lhs) == ToLowerAscii(*rhs);
+		}
+
+		// INVALID_KEY for unknown names, only meant for constant expressions, see PRIZM_KEY
+		constexpr KeyCode KeyCodeOf(const char* name)
+		{
+			for (std::size_t i = 0; i < KEY_NAME_COUNT; ++i)
+			{
+				if (KeyNameEquals(KEY_NAMES[i].name, name)) return KEY_NAMES[i].code;
+			}
+
+			return INVALID_KEY;
+		}
+
+		template<KeyCode _Code>
+		constexpr KeyCode CheckedKeyCode(void)
+		{
+			static_assert(_Code != INVALID_KEY, "Unknown key name, see Input::KEY_NAMES.");
+			return _Code;
+		}
+
+		// runtime path for names read from files, one hash and one compare, INVALID_KEY when unknown
+		KeyCode FindKeyCode(const char* name);
+		KeyCode FindKeyCode(const std::string& name);
+
+		// first name of a code for display and config files, nullptr when it has none
+		const char* GetKeyName(KeyCode code);
+
+		// one bit per code, whole sets are tested with a few AND per word
+		struct InputBits
+		{
+			static constexpr std::size_t WORD_COUNT = INPUT_CODE_COUNT / 64;
+
+			std::uint64_t words[WORD_COUNT];
+
+			bool Test(KeyCode code) const { return code < INPUT_CODE_COUNT && ((words[code >> 6] >> (code & 63)) & 1); }
+			void Set(KeyCode code) { if (code < INPUT_CODE_COUNT) words[code >> 6] |= std::uint64_t(1) << (code & 63); }
+			void Reset(KeyCode code) { if (code < INPUT_CODE_COUNT) words[code >> 6] &= ~(std::uint64_t(1) << (code & 63)); }
+			void Clear(void) { for (auto& word : words) word = 0; }
+
+			bool Intersects(const InputBits& other) const
+			{
+				std::uint64_t any = 0;
+				for (std::size_t i = 0; i < WORD_COUNT; ++i) any |= words[i] & other.words[i];
+				return any != 0;
+			}
+		};
+
+		// what one PreStateUpdate produced, stored and fed back by InputRecorder
+		struct FrameState
+		{
+			InputBits keys;
+			InputBits downs;				// went down / up at some point in the frame
+			InputBits ups;
+			long mouse_delta[2];
+			short mouse_scroll;
+			Point touch_position[max_touchcount];
+			std::uint32_t touch_state[max_touchcount];
+			float gamepad_axes[PAD_AXIS_COUNT];
+		};
+
+		// a digital transition of this frame in arrival order
+		struct InputEvent
+		{
+			KeyCode code;
+			bool down;
+			std::int64_t time_us;			// PerfTimer::Now() in microseconds, when the window thread saw it
+		};
+
 		void Initialize(void);
 
-		// mouse capture
-		void CaptureMouse(HWND, bool do_capture);
+		// PreStateUpdate marks the input sampled on it, nullptr to stop
+		void SetFramePacer(FramePacer*);
+
+		// mouse capture, native_window is Window::GetNativeHandle()
+		void CaptureMouse(void* native_window, bool do_capture);
 		bool IsMouseCaptured(void);
-		POINT MouseCapturePosition(void);
+		Point MouseCapturePosition(void);
 
-		// update
+		// update, producer thread
 		void KeyDown(KeyCode);
 		void KeyUp(KeyCode);
 
@@ -32,9 +232,19 @@ namespace Prizm
 		void ButtonUp(KeyCode);
 		void UpdateMousePos(long, long, short);
 
-		void UpdateTouchPos(long, long, int, DWORD);
+		void UpdateTouchPos(long, long, int, std::uint32_t);
+
+		// button is the XInput bit index, axes are -1 to 1 and triggers 0 to 1
+		void GamepadButtonDown(KeyCode button);
+		void GamepadButtonUp(KeyCode button);
+		void UpdateGamepadAxis(GamepadAxis, float);
 
 		// key state
+		bool IsKeyPress(KeyCode);
+		bool IsKeyReleased(KeyCode);
+		bool IsKeyTriggered(KeyCode);
+
+		// by name, hashed at every call, prefer PRIZM_KEY in per frame code
 		bool IsKeyPress(const char*);
 		
 		bool IsKeyReleased(const char*);
@@ -42,6 +252,7 @@ namespace Prizm
 		bool IsKeyTriggered(const char*);
 
 		// mouse state
+		bool IsMousePress(KeyCode);
 		bool IsMousePress(const char*);
 		
 		bool IsScrollUp(void);
@@ -62,6 +273,20 @@ namespace Prizm
 		const long* GetMouseDelta(void);
 		const long* GetTouchDelta(int);
 
+		// gamepad state
+		bool IsGamepadPress(KeyCode button);
+		float GamepadAxisValue(GamepadAxis);
+
+		// whole state of this and the previous frame, see InputAction.h
+		const InputBits& GetInputBits(void);
+		const InputBits& GetPrevInputBits(void);
+
+		// transitions applied by the last PreStateUpdate
+		const std::vector<InputEvent>& GetFrameEvents(void);
+
+		// applies the queued events, start of frame before anything reads the state
+		void PreStateUpdate(void);
+
 		// update end of frame
 		void PostStateUpdate(void);
 	};
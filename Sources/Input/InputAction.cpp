@@ -0,0 +1,344 @@
+
+#include<fstream>
+#include<sstream>
+#include<algorithm>
+
+#include"InputAction.h"
+#include"../Utilities/Log.h"
+
+namespace Prizm
+{
+	namespace Input
+	{
+		namespace
+		{
+			struct AxisBinding
+			{
+				ActionId action;
+				KeyCode negative;
+				KeyCode positive;
+			};
+
+			struct AnalogBinding
+			{
+				ActionId action;
+				int source;
+				float scale;
+			};
+
+			std::vector<std::string> action_names_;
+
+			// bound codes per action, pressed when any of them is down
+			InputBits action_masks_[MAX_ACTIONS];
+			std::vector<AxisBinding> axis_bindings_;
+			std::vector<AnalogBinding> analog_bindings_;
+
+			std::uint64_t actions_ = 0;
+			std::uint64_t prev_actions_ = 0;
+			std::uint64_t triggered_actions_ = 0;
+			std::uint64_t released_actions_ = 0;
+			float action_axes_[MAX_ACTIONS];
+
+			std::vector<ActionEvent> action_events_;
+
+			// went down and not read by the simulation yet
+			std::uint64_t latency_pending_ = 0;
+			std::int64_t trigger_time_us_[MAX_ACTIONS];
+			TimerStats latency_stats_;
+
+			constexpr std::uint64_t ActionBit(ActionId action) { return std::uint64_t(1) << action; }
+
+			bool IsValid(ActionId action) { return action < action_names_.size(); }
+
+			void RecordLatency(ActionId action)
+			{
+				if (!(latency_pending_ & ActionBit(action))) return;
+
+				latency_pending_ &= ~ActionBit(action);
+				latency_stats_.Add(PerfTimer::Now() - trigger_time_us_[action] * 1000);
+			}
+
+			float ReadAnalog(int source)
+			{
+				if (source < PAD_AXIS_COUNT) return GamepadAxisValue(static_cast<GamepadAxis>(source));
+				if (source == ANALOG_MOUSE_X) return static_cast<float>(MouseDeltaX());
+				if (source == ANALOG_MOUSE_Y) return static_cast<float>(MouseDeltaY());
+				return 0.0f;
+			}
+
+			int FindAnalogSource(const std::string& name)
+			{
+				constexpr const char* names[ANALOG_SOURCE_COUNT] =
+				{
+					"PadLeftX", "PadLeftY", "PadRightX", "PadRightY", "PadLeftTrigger", "PadRightTrigger",
+					"MouseX", "MouseY",
+				};
+
+				for (int i = 0; i < ANALOG_SOURCE_COUNT; ++i)
+				{
+					if (KeyNameEquals(names[i], name.c_str())) return i;
+				}
+
+				return -1;
+			}
+
+			KeyCode ParseKey(const std::string& name, const std::string& path, int line_number)
+			{
+				const KeyCode code = FindKeyCode(name);
+
+				if (code == INVALID_KEY)
+					Log::Warning(PRIZM_FMT("{}({}): unknown key \"{}\"."), path, line_number, name);
+
+				return code;
+			}
+		}
+
+		ActionId RegisterAction(const char* name)
+		{
+			const ActionId found = FindAction(name);
+			if (found != INVALID_ACTION) return found;
+
+			if (action_names_.size() >= MAX_ACTIONS)
+			{
+				Log::Error(PRIZM_FMT("Too many input actions, \"{}\" is not registered."), name);
+				return INVALID_ACTION;
+			}
+
+			const auto action = static_cast<ActionId>(action_names_.size());
+
+			action_names_.emplace_back(name);
+			action_masks_[action].Clear();
+			action_axes_[action] = 0.0f;
+
+			return action;
+		}
+
+		ActionId FindAction(const std::string& name)
+		{
+			for (std::size_t i = 0; i < action_names_.size(); ++i)
+			{
+				if (action_names_[i] == name) return static_cast<ActionId>(i);
+			}
+
+			return INVALID_ACTION;
+		}
+
+		const char* GetActionName(ActionId action)
+		{
+			return IsValid(action) ? action_names_[action].c_str() : "";
+		}
+
+		bool BindButton(ActionId action, KeyCode code)
+		{
+			if (!IsValid(action) || code == INVALID_KEY || code >= INPUT_CODE_COUNT) return false;
+
+			action_masks_[action].Set(code);
+			return true;
+		}
+
+		bool BindAxis(ActionId action, KeyCode negative, KeyCode positive)
+		{
+			if (!BindButton(action, negative) || !BindButton(action, positive)) return false;
+
+			axis_bindings_.push_back({ action, negative, positive });
+			return true;
+		}
+
+		bool BindAnalog(ActionId action, int source, float scale)
+		{
+			if (!IsValid(action) || source < 0 || source >= ANALOG_SOURCE_COUNT) return false;
+
+			analog_bindings_.push_back({ action, source, scale });
+			return true;
+		}
+
+		void ClearBindings(void)
+		{
+			for (auto& mask : action_masks_) mask.Clear();
+
+			axis_bindings_.clear();
+			analog_bindings_.clear();
+		}
+
+		bool LoadBindings(const std::string& path)
+		{
+			std::ifstream in(path);
+			if (!in) return false;
+
+			ClearBindings();
+
+			std::string line;
+			int line_number = 0;
+
+			while (std::getline(in, line))
+			{
+				++line_number;
+
+				std::stringstream ss(line);
+				std::string name, kind;
+				if (!(ss >> name >> kind) || name[0] == '#') continue;
+
+				const ActionId action = RegisterAction(name.c_str());
+				if (action == INVALID_ACTION) continue;
+
+				std::string source;
+
+				if (kind == "button")
+				{
+					while (ss >> source)
+					{
+						if (auto code = ParseKey(source, path, line_number)) BindButton(action, code);
+					}
+				}
+				else if (kind == "axis")
+				{
+					std::string positive;
+					if (!(ss >> source >> positive))
+					{
+						Log::Warning(PRIZM_FMT("{}({}): axis needs a negative and a positive key."), path, line_number);
+						continue;
+					}
+
+					const KeyCode negative_code = ParseKey(source, path, line_number);
+					const KeyCode positive_code = ParseKey(positive, path, line_number);
+					if (negative_code && positive_code) BindAxis(action, negative_code, positive_code);
+				}
+				else if (kind == "analog")
+				{
+					float scale = 1.0f;
+					ss >> source >> scale;
+
+					const int analog = FindAnalogSource(source);
+					if (analog < 0)
+					{
+						Log::Warning(PRIZM_FMT("{}({}): unknown analog source \"{}\"."), path, line_number, source);
+						continue;
+					}
+
+					BindAnalog(action, analog, scale);
+				}
+				else
+				{
+					Log::Warning(PRIZM_FMT("{}({}): unknown binding kind \"{}\"."), path, line_number, kind);
+				}
+			}
+
+			Log::Info(PRIZM_FMT("Input bindings loaded from {}."), path);
+			return true;
+		}
+
+		void UpdateActions(void)
+		{
+			const auto action_count = static_cast<ActionId>(action_names_.size());
+
+			prev_actions_ = actions_;
+			action_events_.clear();
+
+			// replay the raw transitions of this frame from the last frame's state
+			// so the action events keep the timestamps and order of the OS events
+			InputBits replay = GetPrevInputBits();
+			std::uint64_t replay_actions = prev_actions_;
+			std::uint64_t downs = 0;
+			std::uint64_t ups = 0;
+
+			for (auto& event : GetFrameEvents())
+			{
+				if (event.down) replay.Set(event.code);
+				else replay.Reset(event.code);
+
+				for (ActionId action = 0; action < action_count; ++action)
+				{
+					if (!action_masks_[action].Test(event.code)) continue;
+
+					const bool pressed = action_masks_[action].Intersects(replay);
+					if (pressed == ((replay_actions & ActionBit(action)) != 0)) continue;
+
+					replay_actions ^= ActionBit(action);
+					action_events_.push_back({ action, pressed, event.time_us });
+
+					if (pressed)
+					{
+						downs |= ActionBit(action);
+
+						if (!(latency_pending_ & ActionBit(action)))
+						{
+							latency_pending_ |= ActionBit(action);
+							trigger_time_us_[action] = event.time_us;
+						}
+					}
+					else
+					{
+						ups |= ActionBit(action);
+					}
+				}
+			}
+
+			// every binding against the polled state, one AND per word and action
+			const InputBits& keys = GetInputBits();
+			actions_ = 0;
+
+			for (ActionId action = 0; action < action_count; ++action)
+			{
+				actions_ |= static_cast<std::uint64_t>(action_masks_[action].Intersects(keys)) << action;
+			}
+
+			triggered_actions_ = downs & ~prev_actions_;
+			released_actions_ = (ups | prev_actions_) & ~actions_;
+
+			// nobody read it while it was down, nothing to measure
+			latency_pending_ &= actions_ | triggered_actions_;
+
+			std::fill(action_axes_, action_axes_ + MAX_ACTIONS, 0.0f);
+
+			for (auto& binding : axis_bindings_)
+			{
+				action_axes_[binding.action] += (keys.Test(binding.positive) ? 1.0f : 0.0f) - (keys.Test(binding.negative) ? 1.0f : 0.0f);
+			}
+
+			for (auto& binding : analog_bindings_)
+			{
+				action_axes_[binding.action] += ReadAnalog(binding.source) * binding.scale;
+			}
+
+			for (ActionId action = 0; action < action_count; ++action)
+			{
+				action_axes_[action] = (std::max)(-1.0f, (std::min)(1.0f, action_axes_[action]));
+			}
+		}
+
+		bool IsActionPress(ActionId action)
+		{
+			if (!IsValid(action)) return false;
+
+			RecordLatency(action);
+			return (actions_ & ActionBit(action)) != 0;
+		}
+
+		bool IsActionTriggered(ActionId action)
+		{
+			if (!IsValid(action)) return false;
+
+			RecordLatency(action);
+			return (triggered_actions_ & ActionBit(action)) != 0;
+		}
+
+		bool IsActionReleased(ActionId action)
+		{
+			return IsValid(action) && (released_actions_ & ActionBit(action)) != 0;
+		}
+
+		float ActionAxis(ActionId action)
+		{
+			if (!IsValid(action)) return 0.0f;
+
+			RecordLatency(action);
+			return action_axes_[action];
+		}
+
+		std::uint64_t GetActionBits(void) { return actions_; }
+
+		const std::vector<ActionEvent>& GetActionEvents(void) { return action_events_; }
+
+		const TimerStats& GetActionLatencyStats(void) { return latency_stats_; }
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include<string>
+#include<vector>
+#include<cstdint>
+
+#include"Input.h"
+#include"../Utilities/PerfTimer.h"
+
+/*
+Named actions on top of the raw state, gameplay asks for "PlayerMoveX" instead of A / D.
+
+An action is pressed while any of its bound codes is. Every action is one bit
+and all of them are evaluated in one pass over the input words each frame.
+Axes add a negative / positive code pair and analog sources.
+
+Bindings are set from code or read from a text file, one per line:
+
+	# action		kind	sources
+	PlayerMoveX		axis	A D
+	PlayerMoveX		analog	PadLeftX 1.0
+	Fire			button	Space PadA LButton
+
+Key names are the ones of Input::KEY_NAMES.
+*/
+
+namespace Prizm
+{
+	namespace Input
+	{
+		using ActionId = std::uint32_t;
+
+		constexpr std::size_t MAX_ACTIONS = 64;
+		constexpr ActionId INVALID_ACTION = ~0u;
+
+		// gamepad axes first so a GamepadAxis is also an AnalogSource
+		enum AnalogSource
+		{
+			ANALOG_MOUSE_X = PAD_AXIS_COUNT,
+			ANALOG_MOUSE_Y,
+			ANALOG_SOURCE_COUNT,
+		};
+
+		// an action changing state inside the frame, in the order the raw events arrived
+		struct ActionEvent
+		{
+			ActionId action;
+			bool pressed;
+			std::int64_t time_us;
+		};
+
+		// the same name returns the same id, INVALID_ACTION once MAX_ACTIONS are in use
+		ActionId RegisterAction(const char* name);
+		ActionId FindAction(const std::string& name);
+		const char* GetActionName(ActionId);
+
+		// code is anything from the Input code space, keys, mouse and gamepad buttons, touches
+		bool BindButton(ActionId, KeyCode code);
+		bool BindAxis(ActionId, KeyCode negative, KeyCode positive);
+		bool BindAnalog(ActionId, int source, float scale);
+
+		// actions stay registered, only their bindings go
+		void ClearBindings(void);
+
+		// replaces every binding, false when the file can not be opened and the old bindings stay
+		bool LoadBindings(const std::string& path);
+
+		// called by PreStateUpdate
+		void UpdateActions(void);
+
+		bool IsActionPress(ActionId);
+		bool IsActionTriggered(ActionId);
+		bool IsActionReleased(ActionId);
+
+		// -1 to 1, digital pairs give -1, 0 or 1, analog sources are added on top
+		float ActionAxis(ActionId);
+
+		// one bit per ActionId
+		std::uint64_t GetActionBits(void);
+
+		const std::vector<ActionEvent>& GetActionEvents(void);
+
+		// OS event to the first time the simulation reads the action after it went down
+		const TimerStats& GetActionLatencyStats(void);
+	}
+}
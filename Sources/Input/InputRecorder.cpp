@@ -0,0 +1,437 @@
+
+#include<cstring>
+#include<fstream>
+#include<iterator>
+
+#include"InputRecorder.h"
+#include"../Utilities/BinaryLog.h"
+#include"../Utilities/Log.h"
+
+namespace Prizm
+{
+	namespace InputRecorder
+	{
+		namespace
+		{
+			constexpr char MAGIC[] = "PRZMINP2";
+			constexpr std::size_t MAGIC_SIZE = 8;
+
+			// written out whenever the buffer grows past this
+			constexpr std::size_t FLUSH_SIZE = 64 * 1024;
+
+			enum FrameField : std::uint8_t
+			{
+				FIELD_KEYS = 1 << 0,
+				FIELD_DOWNS = 1 << 1,
+				FIELD_UPS = 1 << 2,
+				FIELD_MOUSE = 1 << 3,
+				FIELD_TOUCH = 1 << 4,
+				FIELD_AXES = 1 << 5,
+			};
+
+			enum Mode
+			{
+				MODE_NONE,
+				MODE_RECORD,
+				MODE_REPLAY,
+			};
+
+			Mode _mode = MODE_NONE;
+			std::string _path;
+
+			std::ofstream _file;
+			std::string _buffer;
+			std::uint64_t _bytes_written = 0;
+
+			std::string _replay_data;
+			std::size_t _offset = 0;
+			bool _finished = false;
+
+			std::uint64_t _frame_count = 0;
+
+			// what the previous frame left behind, keys and axes are stored as changes to it
+			Input::InputBits _last_keys;
+			float _last_axes[Input::PAD_AXIS_COUNT];
+
+			void ResetBaseline(void)
+			{
+				_last_keys.Clear();
+				for (auto& axis : _last_axes) axis = 0.0f;
+				_frame_count = 0;
+			}
+
+			void Flush(void)
+			{
+				_file.write(_buffer.data(), _buffer.size());
+				_bytes_written += _buffer.size();
+				_buffer.clear();
+			}
+
+			template<class _T>
+			void AppendRaw(const _T& value)
+			{
+				_buffer.append(reinterpret_cast<const char*>(&value), sizeof(_T));
+			}
+
+			template<class _T>
+			bool ReadRaw(_T& value)
+			{
+				if (_offset + sizeof(_T) > _replay_data.size()) return false;
+
+				std::memcpy(&value, _replay_data.data() + _offset, sizeof(_T));
+				_offset += sizeof(_T);
+				return true;
+			}
+
+			bool ReadVarint(std::uint64_t& value)
+			{
+				const char* data = _replay_data.data() + _offset;
+				if (!BinaryLog::ReadVarint(data, _replay_data.data() + _replay_data.size(), value)) return false;
+
+				_offset = data - _replay_data.data();
+				return true;
+			}
+
+			bool ReadZigZag(std::int64_t& value)
+			{
+				std::uint64_t raw;
+				if (!ReadVarint(raw)) return false;
+
+				value = BinaryLog::UnZigZag(raw);
+				return true;
+			}
+
+			std::uint8_t WordMask(const Input::InputBits& bits)
+			{
+				std::uint8_t mask = 0;
+
+				for (std::size_t i = 0; i < Input::InputBits::WORD_COUNT; ++i)
+				{
+					if (bits.words[i]) mask |= 1 << i;
+				}
+
+				return mask;
+			}
+
+			void AppendBits(const Input::InputBits& bits)
+			{
+				const std::uint8_t mask = WordMask(bits);
+				AppendRaw(mask);
+
+				for (std::size_t i = 0; i < Input::InputBits::WORD_COUNT; ++i)
+				{
+					if (mask & (1 << i)) AppendRaw(bits.words[i]);
+				}
+			}
+
+			bool ReadBits(Input::InputBits& bits)
+			{
+				std::uint8_t mask;
+				if (!ReadRaw(mask)) return false;
+
+				for (std::size_t i = 0; i < Input::InputBits::WORD_COUNT; ++i)
+				{
+					bits.words[i] = 0;
+					if ((mask & (1 << i)) && !ReadRaw(bits.words[i])) return false;
+				}
+
+				return true;
+			}
+
+			void StopReplay(const char* reason)
+			{
+				if (!_finished)
+					Log::Info(PRIZM_FMT("Replay of {} {} after {} frames."), _path, reason, _frame_count);
+
+				_finished = true;
+			}
+		}
+
+		bool BeginRecording(const std::string& path, double simulation_hz)
+		{
+			if (_mode != MODE_NONE) return false;
+
+			_file.open(path, std::ios::binary | std::ios::trunc);
+
+			if (!_file)
+			{
+				Log::Error(PRIZM_FMT("Cannot open input recording {}."), path);
+				return false;
+			}
+
+			_buffer.clear();
+			_buffer.reserve(FLUSH_SIZE * 2);
+			_buffer.append(MAGIC, MAGIC_SIZE);
+			AppendRaw(simulation_hz);
+
+			_bytes_written = 0;
+			_path = path;
+			_mode = MODE_RECORD;
+			ResetBaseline();
+
+			Log::Info(PRIZM_FMT("Recording input to {}."), path);
+			return true;
+		}
+
+		void EndRecording(void)
+		{
+			if (_mode != MODE_RECORD) return;
+
+			Flush();
+			_file.close();
+			_mode = MODE_NONE;
+
+			Log::Info(PRIZM_FMT("Input recording {} closed, {} frames, {} bytes ({:.1f} bytes per frame)."),
+				_path, _frame_count, _bytes_written, _frame_count ? static_cast<double>(_bytes_written) / _frame_count : 0.0);
+		}
+
+		bool IsRecording(void) { return _mode == MODE_RECORD; }
+
+		bool BeginReplay(const std::string& path, double& simulation_hz)
+		{
+			if (_mode != MODE_NONE) return false;
+
+			std::ifstream file(path, std::ios::binary);
+
+			if (!file)
+			{
+				Log::Error(PRIZM_FMT("Cannot open input recording {}."), path);
+				return false;
+			}
+
+			_replay_data.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			_offset = 0;
+
+			if (_replay_data.size() < MAGIC_SIZE || std::memcmp(_replay_data.data(), MAGIC, MAGIC_SIZE) != 0)
+			{
+				Log::Error(PRIZM_FMT("{} is not an input recording."), path);
+				return false;
+			}
+
+			_offset = MAGIC_SIZE;
+
+			if (!ReadRaw(simulation_hz) || simulation_hz <= 0.0)
+			{
+				Log::Error(PRIZM_FMT("{} has a broken header."), path);
+				return false;
+			}
+
+			_path = path;
+			_finished = false;
+			_mode = MODE_REPLAY;
+			ResetBaseline();
+
+			Log::Info(PRIZM_FMT("Replaying input from {}, {} bytes at {} Hz."), path, _replay_data.size(), simulation_hz);
+			return true;
+		}
+
+		void EndReplay(void)
+		{
+			if (_mode != MODE_REPLAY) return;
+
+			_replay_data.clear();
+			_replay_data.shrink_to_fit();
+			_mode = MODE_NONE;
+		}
+
+		bool IsReplaying(void) { return _mode == MODE_REPLAY; }
+
+		bool IsReplayFinished(void) { return _mode == MODE_REPLAY && _finished; }
+
+		std::uint64_t GetFrameCount(void) { return _frame_count; }
+
+		void WriteFrame(const Input::FrameState& state)
+		{
+			if (_mode != MODE_RECORD) return;
+
+			Input::InputBits key_changes;
+			for (std::size_t i = 0; i < Input::InputBits::WORD_COUNT; ++i)
+			{
+				key_changes.words[i] = state.keys.words[i] ^ _last_keys.words[i];
+			}
+
+			std::uint8_t touch_mask = 0;
+			for (int i = 0; i < Input::max_touchcount; ++i)
+			{
+				if (state.touch_state[i]) touch_mask |= 1 << i;
+			}
+
+			std::uint8_t axis_mask = 0;
+			for (int i = 0; i < Input::PAD_AXIS_COUNT; ++i)
+			{
+				if (state.gamepad_axes[i] != _last_axes[i]) axis_mask |= 1 << i;
+			}
+
+			std::uint8_t fields = 0;
+			if (WordMask(key_changes)) fields |= FIELD_KEYS;
+			if (WordMask(state.downs)) fields |= FIELD_DOWNS;
+			if (WordMask(state.ups)) fields |= FIELD_UPS;
+			if (state.mouse_delta[0] || state.mouse_delta[1] || state.mouse_scroll) fields |= FIELD_MOUSE;
+			if (touch_mask) fields |= FIELD_TOUCH;
+			if (axis_mask) fields |= FIELD_AXES;
+
+			AppendRaw(fields);
+
+			if (fields & FIELD_KEYS) AppendBits(key_changes);
+			if (fields & FIELD_DOWNS) AppendBits(state.downs);
+			if (fields & FIELD_UPS) AppendBits(state.ups);
+
+			if (fields & FIELD_MOUSE)
+			{
+				BinaryLog::AppendVarint(_buffer, BinaryLog::ZigZag(state.mouse_delta[0]));
+				BinaryLog::AppendVarint(_buffer, BinaryLog::ZigZag(state.mouse_delta[1]));
+				BinaryLog::AppendVarint(_buffer, BinaryLog::ZigZag(state.mouse_scroll));
+			}
+
+			if (fields & FIELD_TOUCH)
+			{
+				AppendRaw(touch_mask);
+
+				for (int i = 0; i < Input::max_touchcount; ++i)
+				{
+					if (!(touch_mask & (1 << i))) continue;
+
+					BinaryLog::AppendVarint(_buffer, BinaryLog::ZigZag(state.touch_position[i].x));
+					BinaryLog::AppendVarint(_buffer, BinaryLog::ZigZag(state.touch_position[i].y));
+					BinaryLog::AppendVarint(_buffer, state.touch_state[i]);
+				}
+			}
+
+			if (fields & FIELD_AXES)
+			{
+				AppendRaw(axis_mask);
+
+				for (int i = 0; i < Input::PAD_AXIS_COUNT; ++i)
+				{
+					if (axis_mask & (1 << i)) AppendRaw(state.gamepad_axes[i]);
+				}
+			}
+
+			_last_keys = state.keys;
+			std::memcpy(_last_axes, state.gamepad_axes, sizeof(_last_axes));
+		}
+
+		bool ReadFrame(Input::FrameState& state)
+		{
+			if (_mode != MODE_REPLAY || _finished) return false;
+
+			if (_offset >= _replay_data.size())
+			{
+				StopReplay("finished");
+				return false;
+			}
+
+			std::uint8_t fields;
+			if (!ReadRaw(fields))
+			{
+				StopReplay("is truncated, stopped");
+				return false;
+			}
+
+			Input::InputBits key_changes;
+			key_changes.Clear();
+			state.downs.Clear();
+			state.ups.Clear();
+
+			bool ok = (!(fields & FIELD_KEYS) || ReadBits(key_changes))
+				&& (!(fields & FIELD_DOWNS) || ReadBits(state.downs))
+				&& (!(fields & FIELD_UPS) || ReadBits(state.ups));
+
+			std::int64_t x = 0, y = 0, scroll = 0;
+			if (ok && (fields & FIELD_MOUSE)) ok = ReadZigZag(x) && ReadZigZag(y) && ReadZigZag(scroll);
+
+			state.mouse_delta[0] = static_cast<long>(x);
+			state.mouse_delta[1] = static_cast<long>(y);
+			state.mouse_scroll = static_cast<short>(scroll);
+
+			for (int i = 0; i < Input::max_touchcount; ++i) state.touch_state[i] = 0;
+
+			std::uint8_t touch_mask = 0;
+			if (ok && (fields & FIELD_TOUCH)) ok = ReadRaw(touch_mask);
+
+			for (int i = 0; ok && i < Input::max_touchcount; ++i)
+			{
+				if (!(touch_mask & (1 << i))) continue;
+
+				std::uint64_t flags;
+				ok = ReadZigZag(x) && ReadZigZag(y) && ReadVarint(flags);
+				if (!ok) break;
+
+				state.touch_position[i].x = static_cast<long>(x);
+				state.touch_position[i].y = static_cast<long>(y);
+				state.touch_state[i] = static_cast<std::uint32_t>(flags);
+			}
+
+			std::uint8_t axis_mask = 0;
+			if (ok && (fields & FIELD_AXES)) ok = ReadRaw(axis_mask);
+
+			for (int i = 0; ok && i < Input::PAD_AXIS_COUNT; ++i)
+			{
+				if (axis_mask & (1 << i)) ok = ReadRaw(_last_axes[i]);
+			}
+
+			if (!ok)
+			{
+				StopReplay("is truncated, stopped");
+				return false;
+			}
+
+			for (std::size_t i = 0; i < Input::InputBits::WORD_COUNT; ++i)
+			{
+				_last_keys.words[i] ^= key_changes.words[i];
+			}
+
+			state.keys = _last_keys;
+			std::memcpy(state.gamepad_axes, _last_axes, sizeof(_last_axes));
+
+			return true;
+		}
+
+		void WriteSteps(unsigned int steps)
+		{
+			if (_mode != MODE_RECORD) return;
+
+			BinaryLog::AppendVarint(_buffer, steps);
+			++_frame_count;
+
+			if (_buffer.size() >= FLUSH_SIZE) Flush();
+		}
+
+		unsigned int ReadSteps(void)
+		{
+			if (_mode != MODE_REPLAY || _finished) return 0;
+
+			std::uint64_t steps;
+
+			if (!ReadVarint(steps))
+			{
+				StopReplay("is truncated, stopped");
+				return 0;
+			}
+
+			++_frame_count;
+			return static_cast<unsigned int>(steps);
+		}
+
+		bool SyncCondition(bool value)
+		{
+			if (_mode == MODE_RECORD)
+			{
+				AppendRaw(static_cast<std::uint8_t>(value));
+				return value;
+			}
+
+			if (_mode != MODE_REPLAY || _finished) return value;
+
+			std::uint8_t recorded;
+
+			if (!ReadRaw(recorded))
+			{
+				StopReplay("is truncated, stopped");
+				return value;
+			}
+
+			return recorded != 0;
+		}
+	}
+}
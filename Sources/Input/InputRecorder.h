@@ -0,0 +1,49 @@
+#pragma once
+
+#include<string>
+#include<cstdint>
+
+#include"Input.h"
+
+// records the input of every frame together with the fixed steps that frame ran,
+// replaying it feeds the same state to the same simulation steps without a window
+//   header    "PRZMINP2", simulation rate f64
+//   frame     fields u8, [keys] [downs] [ups] [mouse] [touch] [axes], steps v, one u8 per SyncCondition
+//   bits      word mask u8, one u64 per set mask bit, keys are XOR against the previous frame
+//   mouse     dx zv, dy zv, scroll zv
+//   touch     touch mask u8, per touch x zv, y zv, flags v
+//   axes      axis mask u8, one f32 per changed axis
+// v and zv are the varints of BinaryLog.h, an idle frame is two bytes
+
+namespace Prizm
+{
+	namespace InputRecorder
+	{
+		bool BeginRecording(const std::string& path, double simulation_hz);
+		void EndRecording(void);
+		bool IsRecording(void);
+
+		// the rate the recording ran at, the replay has to use it for the steps to match
+		bool BeginReplay(const std::string& path, double& simulation_hz);
+		void EndReplay(void);
+		bool IsReplaying(void);
+
+		// every frame of the recording was played
+		bool IsReplayFinished(void);
+
+		std::uint64_t GetFrameCount(void);
+
+		// Input::PreStateUpdate
+		void WriteFrame(const Input::FrameState&);
+		bool ReadFrame(Input::FrameState&);
+
+		// GameTime::Advance, after the frame's input
+		void WriteSteps(unsigned int steps);
+		unsigned int ReadSteps(void);
+
+		// something the frame acts on that is not input, such as a background load having finished
+		// recorded after the frame's steps, a replay gets the recorded value back instead of value
+		// has to be asked in the same order every frame, the answers are read back in sequence
+		bool SyncCondition(bool value);
+	}
+}
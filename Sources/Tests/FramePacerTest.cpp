@@ -0,0 +1,201 @@
+#include<cstdint>
+#include<cstdlib>
+#include<iostream>
+
+#include"../Utilities/FramePacer.h"
+
+/*
+FramePacer against a fake clock, no real time passes.
+
+Every clock read advances the clock by TICK so the spin loop ends, a sleep
+advances it by the requested time plus the oversleep of the fake OS timer.
+*/
+
+namespace Prizm
+{
+	class FakeClock
+	{
+	public:
+		// no divisor of the period or the spin threshold, spins end past the deadline like on a real clock
+		static constexpr std::int64_t TICK = 1237;
+
+		// far from 0, FramePacer treats a 0 deadline as unset
+		std::int64_t now = 1000000000000ll;
+		std::int64_t oversleep = 0;
+		unsigned int sleep_count = 0;
+		// where the last sleep was asked to end, before the oversleep
+		std::int64_t slept_until = 0;
+
+		FramePacer MakePacer(void)
+		{
+			return FramePacer([this]() { return now += TICK; }, [this](std::int64_t ns) { ++sleep_count; slept_until = now + ns; now += ns + oversleep; });
+		}
+
+		// frame work between two waits
+		void Work(std::int64_t ns) { now += ns; }
+	};
+
+	int failures = 0;
+
+	void Check(bool condition, const char* what, std::int64_t value = 0)
+	{
+		if (condition) return;
+
+		std::cerr << "FAIL " << what << " (" << value << ")" << std::endl;
+		++failures;
+	}
+
+	const std::int64_t PERIOD = 16666666;
+
+	void Uncapped(void)
+	{
+		FakeClock clock;
+		auto pacer = clock.MakePacer();
+
+		pacer.WaitForNextFrame();
+		clock.Work(PERIOD / 2);
+		pacer.WaitForNextFrame();
+
+		Check(clock.sleep_count == 0, "uncapped never sleeps", clock.sleep_count);
+		Check(pacer.GetLastWaitMs() == 0.0, "uncapped never waits");
+	}
+
+	void WaitsForTheDeadline(void)
+	{
+		FakeClock clock;
+		clock.oversleep = 500000;
+		auto pacer = clock.MakePacer();
+		pacer.SetTargetFrameRate(60.0);
+
+		pacer.WaitForNextFrame();
+		Check(clock.sleep_count == 0, "the first frame only sets the deadline", clock.sleep_count);
+
+		const auto deadline = clock.now + PERIOD;
+		clock.Work(5000000);
+		pacer.WaitForNextFrame();
+
+		Check(clock.sleep_count == 1, "one coarse sleep", clock.sleep_count);
+		Check(clock.now >= deadline, "returns at the deadline, not before", deadline - clock.now);
+		Check(clock.now < deadline + 2 * FakeClock::TICK, "spins, oversleep stays within the threshold", clock.now - deadline);
+		Check(clock.slept_until <= deadline - FramePacer::DEFAULT_SPIN_THRESHOLD, "sleeps only up to the spin threshold", deadline - clock.slept_until);
+		Check(pacer.GetLastWaitMs() > 11.0 && pacer.GetLastWaitMs() < 12.0, "waits the rest of the frame", static_cast<std::int64_t>(pacer.GetLastWaitMs() * 1000.0));
+	}
+
+	void KeepsTheCadence(void)
+	{
+		FakeClock clock;
+		auto pacer = clock.MakePacer();
+		pacer.SetTargetFrameRate(60.0);
+
+		pacer.WaitForNextFrame();
+		const auto first = clock.now;
+
+		for (int frame = 1; frame <= 600; ++frame)
+		{
+			// uneven work, always under a frame
+			clock.Work((frame * 7919 % 15) * 1000000ll);
+			pacer.WaitForNextFrame();
+
+			const auto drift = clock.now - (first + frame * PERIOD);
+			if (drift < 0 || drift >= 2 * FakeClock::TICK)
+			{
+				Check(false, "frames start on the period grid", drift);
+				return;
+			}
+		}
+	}
+
+	void LateFrameKeepsTheGrid(void)
+	{
+		FakeClock clock;
+		auto pacer = clock.MakePacer();
+		pacer.SetTargetFrameRate(60.0);
+
+		pacer.WaitForNextFrame();
+		const auto first = clock.now;
+
+		// misses the deadline by less than a frame, the next one is still on the grid
+		clock.Work(PERIOD + PERIOD / 2);
+		pacer.WaitForNextFrame();
+		Check(clock.sleep_count == 0, "a late frame does not sleep", clock.sleep_count);
+
+		clock.Work(1000000);
+		pacer.WaitForNextFrame();
+
+		const auto drift = clock.now - (first + 2 * PERIOD);
+		Check(drift >= 0 && drift < 2 * FakeClock::TICK, "the deadline after a late frame rolls over onto the grid", drift);
+	}
+
+	void StallResyncs(void)
+	{
+		FakeClock clock;
+		auto pacer = clock.MakePacer();
+		pacer.SetTargetFrameRate(60.0);
+
+		pacer.WaitForNextFrame();
+
+		// a hitch of several frames, no burst of unpaced frames to catch up afterwards
+		clock.Work(5 * PERIOD);
+		pacer.WaitForNextFrame();
+		const auto resync = clock.now;
+
+		clock.Work(1000000);
+		pacer.WaitForNextFrame();
+
+		const auto drift = clock.now - (resync + PERIOD);
+		Check(drift >= 0 && drift < 2 * FakeClock::TICK, "a stall resyncs the deadline to a period after it", drift);
+	}
+
+	void RateChangeResets(void)
+	{
+		FakeClock clock;
+		auto pacer = clock.MakePacer();
+		pacer.SetTargetFrameRate(60.0);
+
+		pacer.WaitForNextFrame();
+		clock.Work(1000000);
+
+		pacer.SetTargetFrameRate(30.0);
+		pacer.WaitForNextFrame();
+		Check(pacer.GetLastWaitMs() == 0.0, "a new rate starts from the next frame");
+
+		const auto start = clock.now;
+		pacer.WaitForNextFrame();
+
+		const auto drift = clock.now - (start + 2 * PERIOD);
+		Check(drift >= 0 && drift < 4 * FakeClock::TICK, "waits the new period", drift);
+	}
+
+	void Latency(void)
+	{
+		FakeClock clock;
+		auto pacer = clock.MakePacer();
+
+		pacer.MarkPresented();
+		Check(pacer.GetLastLatencyMs() == 0.0, "present without input is not a sample");
+
+		pacer.MarkInputSampled();
+		clock.Work(8000000);
+		pacer.MarkPresented();
+
+		Check(pacer.GetLastLatencyMs() > 7.9 && pacer.GetLastLatencyMs() < 8.1, "input to present latency", static_cast<std::int64_t>(pacer.GetLastLatencyMs() * 1000.0));
+	}
+}
+
+int main(void)
+{
+	using namespace Prizm;
+
+	Uncapped();
+	WaitsForTheDeadline();
+	KeepsTheCadence();
+	LateFrameKeepsTheGrid();
+	StallResyncs();
+	RateChangeResets();
+	Latency();
+
+	if (failures) return EXIT_FAILURE;
+
+	std::cout << "FramePacer ok" << std::endl;
+	return EXIT_SUCCESS;
+}
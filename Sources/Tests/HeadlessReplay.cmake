@@ -0,0 +1,25 @@
+# records a headless run with scene changes, replays it and compares what the two runs printed
+# the stand-in loads take a random time, the replay has to swap on the recorded frames anyway
+# cmake -DRUNNER=<HeadlessRunner> -DRECORDING=<path> -P HeadlessReplay.cmake
+
+execute_process(COMMAND ${RUNNER} --frames 240 --scene-change 60 --record ${RECORDING} OUTPUT_VARIABLE recorded RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "recording failed: ${result}")
+endif()
+
+execute_process(COMMAND ${RUNNER} --scene-change 60 --replay ${RECORDING} OUTPUT_VARIABLE replayed RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "replay failed: ${result}")
+endif()
+
+# frame count, step count, scene changes and checksum, the timing differs
+string(REGEX MATCH "[0-9]+ frames in" recorded_frames "${recorded}")
+string(REGEX MATCH "[0-9]+ steps, [1-9][0-9]* scene changes, checksum [0-9a-f]+" recorded_steps "${recorded}")
+string(REGEX MATCH "[0-9]+ frames in" replayed_frames "${replayed}")
+string(REGEX MATCH "[0-9]+ steps, [1-9][0-9]* scene changes, checksum [0-9a-f]+" replayed_steps "${replayed}")
+
+if(NOT recorded_frames OR NOT recorded_steps OR NOT recorded_frames STREQUAL replayed_frames OR NOT recorded_steps STREQUAL replayed_steps)
+	message(FATAL_ERROR "replay diverged\n recorded: ${recorded_frames}, ${recorded_steps}\n replayed: ${replayed_frames}, ${replayed_steps}")
+endif()
+
+message(STATUS "${replayed_frames}, ${replayed_steps}")
@@ -0,0 +1,220 @@
+
+#include<Windows.h>
+
+#include<string>
+#include<vector>
+#include<chrono>
+#include<thread>
+#include<algorithm>
+
+#include"Cookers.h"
+#include"..\..\Utilities\AssetManifest.h"
+#include"..\..\Utilities\WorkerPool.h"
+#include"..\..\Utilities\Log.h"
+
+#pragma comment(lib, "Utilities.lib")
+
+/*
+Incremental asset cooker.
+
+AssetCooker [resource_dir] [--clean] [--jobs N] [--benchmark]
+
+Sources under Shaders/ and Textures/ are cooked into <resource_dir>/Cooked/.
+An asset is rebuilt only when the content hash of the source and its
+dependencies differs from the manifest, or one of its outputs is missing.
+--benchmark times a clean full cook followed by a no-op rebuild.
+*/
+
+namespace Prizm
+{
+	// same layout the runtime expects, see Game/Resource.h
+	const std::string DEFAULT_RESOURCE_DIR = "..\\..\\Resources\\";
+	const char* COOKED_SOURCE_DIRS[] = { "Shaders", "Textures" };
+
+	struct CookJob
+	{
+		CookedAsset asset;
+		bool success;
+		std::string error;
+	};
+
+	struct CookStats
+	{
+		int total;
+		int cooked;
+		int failed;
+		double milliseconds;
+	};
+
+	void CollectSources(const std::string& resource_dir, const std::string& relative_dir, std::vector<std::string>& sources)
+	{
+		WIN32_FIND_DATAA find_data;
+		HANDLE find = FindFirstFileA((resource_dir + relative_dir + "\\*").c_str(), &find_data);
+		if (find == INVALID_HANDLE_VALUE) return;
+
+		do
+		{
+			const std::string name = find_data.cFileName;
+			if (name == "." || name == "..") continue;
+
+			const std::string relative = relative_dir + "/" + name;
+
+			if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				CollectSources(resource_dir, relative, sources);
+			else if (Cookers::GetAssetKind(relative) != Cookers::UNKNOWN)
+				sources.emplace_back(relative);
+
+		} while (FindNextFileA(find, &find_data));
+
+		FindClose(find);
+	}
+
+	bool OutputsExist(const std::string& resource_dir, const CookedAsset& asset)
+	{
+		if (asset.outputs.empty()) return false;
+
+		for (auto& output : asset.outputs)
+		{
+			if (GetFileAttributesA((resource_dir + COOKED_DIR_NAME + output).c_str()) == INVALID_FILE_ATTRIBUTES)
+				return false;
+		}
+
+		return true;
+	}
+
+	CookStats CookAll(const std::string& resource_dir, bool clean, int job_count)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const std::string manifest_path = resource_dir + COOKED_DIR_NAME + MANIFEST_FILE_NAME;
+
+		AssetManifest manifest;
+		if (!clean) manifest.Load(manifest_path);
+
+		std::vector<std::string> sources;
+		for (auto dir : COOKED_SOURCE_DIRS)
+		{
+			CollectSources(resource_dir, dir, sources);
+		}
+
+		// drop assets whose source is gone
+		std::vector<std::string> removed;
+		for (auto& asset : manifest.Assets())
+		{
+			if (std::find(sources.begin(), sources.end(), asset.first) == sources.end())
+				removed.emplace_back(asset.first);
+		}
+		for (auto& source : removed)
+		{
+			manifest.Remove(source);
+		}
+
+		// dirty check is hashing only, cheap enough to run on the main thread
+		std::vector<CookJob> jobs;
+		for (auto& source : sources)
+		{
+			CookJob job;
+			job.asset.source = source;
+			job.asset.dependencies = Cookers::ScanDependencies(resource_dir, source);
+			job.asset.hash = AssetManifest::HashSources(resource_dir, source, job.asset.dependencies);
+			job.success = false;
+
+			const CookedAsset* cooked = manifest.Find(source);
+			if (cooked && cooked->hash == job.asset.hash && cooked->dependencies == job.asset.dependencies &&
+				OutputsExist(resource_dir, *cooked))
+				continue;
+
+			jobs.emplace_back(job);
+		}
+
+		if (!jobs.empty())
+		{
+			WorkerPool workers(job_count, static_cast<int>(jobs.size()), Cookers::BeginThread, Cookers::EndThread);
+
+			for (auto& job : jobs)
+			{
+				CookJob* target = &job;
+				workers.Add([target, &resource_dir]
+				{
+					target->success = Cookers::Cook(resource_dir, target->asset, target->error);
+				});
+			}
+
+			workers.WaitIdle();
+		}
+
+		CookStats stats = {};
+		stats.total = static_cast<int>(sources.size());
+
+		for (auto& job : jobs)
+		{
+			if (job.success)
+			{
+				manifest.Set(job.asset);
+				++stats.cooked;
+				Log::Info("[Cook] " + job.asset.source);
+			}
+			else
+			{
+				manifest.Remove(job.asset.source);
+				++stats.failed;
+				Log::Error("[Cook] " + job.asset.source + " : " + job.error);
+			}
+		}
+
+		if (!manifest.Save(manifest_path))
+			Log::Error("Cannot write manifest " + manifest_path);
+
+		const auto end = std::chrono::steady_clock::now();
+		stats.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+		return stats;
+	}
+
+	void Report(const char* label, const CookStats& stats)
+	{
+		Log::Info(std::string(label) + ": " + std::to_string(stats.cooked) + " cooked, "
+			+ std::to_string(stats.total - stats.cooked - stats.failed) + " up to date, "
+			+ std::to_string(stats.failed) + " failed in " + std::to_string(stats.milliseconds) + " ms.");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Prizm;
+
+	std::string resource_dir = DEFAULT_RESOURCE_DIR;
+	bool clean = false;
+	bool benchmark = false;
+	int job_count = static_cast<int>((std::max)(1u, std::thread::hardware_concurrency()));
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--clean") clean = true;
+		else if (arg == "--benchmark") benchmark = true;
+		else if (arg == "--jobs" && i + 1 < argc) job_count = (std::max)(1, atoi(argv[++i]));
+		else resource_dir = arg;
+	}
+
+	if (resource_dir.back() != '\\' && resource_dir.back() != '/')
+		resource_dir += "\\";
+
+	Log::Info("AssetCooker " + resource_dir + " with " + std::to_string(job_count) + " jobs.");
+
+	if (benchmark)
+	{
+		const CookStats full = CookAll(resource_dir, true, job_count);
+		Report("Full cook", full);
+
+		const CookStats noop = CookAll(resource_dir, false, job_count);
+		Report("No-op rebuild", noop);
+
+		return full.failed + noop.failed == 0 ? 0 : 1;
+	}
+
+	const CookStats stats = CookAll(resource_dir, clean, job_count);
+	Report(clean ? "Full cook" : "Incremental cook", stats);
+
+	return stats.failed == 0 ? 0 : 1;
+}
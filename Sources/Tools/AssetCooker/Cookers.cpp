@@ -0,0 +1,233 @@
+
+#include<Windows.h>
+#include<shlobj.h>
+#include<d3dcompiler.h>
+#include<wrl/client.h>
+
+#include<fstream>
+#include<algorithm>
+
+#include"Cookers.h"
+#include"..\..\Utilities\Utils.h"
+#include"DirectXTex\DirectXTex.h"
+
+#pragma comment(lib, "d3dcompiler.lib")
+#pragma comment(lib, "DirectXTex/DirectXTex.lib")
+
+namespace Prizm
+{
+	namespace Cookers
+	{
+		struct ShaderStage
+		{
+			const char* entry_point;
+			const char* target;
+			const char* suffix;
+		};
+
+		// suffix order matches ShaderType, the runtime looks outputs up by suffix
+		constexpr ShaderStage SHADER_STAGES[] =
+		{
+			{ "VSMain", "vs_5_0", ".vs.cso" },
+			{ "GSMain", "gs_5_0", ".gs.cso" },
+			{ "DSMain", "ds_5_0", ".ds.cso" },
+			{ "HSMain", "hs_5_0", ".hs.cso" },
+			{ "CSMain", "cs_5_0", ".cs.cso" },
+			{ "PSMain", "ps_5_0", ".ps.cso" },
+		};
+
+		constexpr UINT SHADER_COOK_FLAGS = D3DCOMPILE_ENABLE_STRICTNESS | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+
+		// only a successful CoInitializeEx (S_FALSE included) is balanced, RPC_E_CHANGED_MODE is not
+		thread_local HRESULT com_result_ = E_FAIL;
+
+		std::string ToLower(std::string str)
+		{
+			std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+			return str;
+		}
+
+		std::string Extension(const std::string& path)
+		{
+			const size_t dot = path.find_last_of('.');
+			if (dot == std::string::npos) return "";
+			return ToLower(path.substr(dot));
+		}
+
+		std::string Directory(const std::string& path)
+		{
+			const size_t slash = path.find_last_of("/\\");
+			if (slash == std::string::npos) return "";
+			return path.substr(0, slash + 1);
+		}
+
+		bool EnsureDirectory(const std::string& file_path)
+		{
+			std::string directory = Directory(file_path);
+			std::replace(directory.begin(), directory.end(), '/', '\\');
+
+			const int result = SHCreateDirectoryExA(nullptr, directory.c_str(), nullptr);
+			return result == ERROR_SUCCESS || result == ERROR_ALREADY_EXISTS || result == ERROR_FILE_EXISTS;
+		}
+
+		AssetKind GetAssetKind(const std::string& source)
+		{
+			const std::string extension = Extension(source);
+
+			if (extension == ".hlsl")
+				return SHADER;
+
+			if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" ||
+				extension == ".bmp" || extension == ".tga")
+				return TEXTURE;
+
+			return UNKNOWN;
+		}
+
+		void ScanIncludes(const std::string& resource_dir, const std::string& source, std::vector<std::string>& dependencies)
+		{
+			std::ifstream in(resource_dir + source);
+			if (!in) return;
+
+			std::string line;
+			while (std::getline(in, line))
+			{
+				const size_t include = line.find("#include");
+				if (include == std::string::npos) continue;
+
+				const size_t begin = line.find('"', include);
+				const size_t end = begin == std::string::npos ? std::string::npos : line.find('"', begin + 1);
+				if (end == std::string::npos) continue;
+
+				// D3D_COMPILE_STANDARD_FILE_INCLUDE resolves relative to the including file
+				const std::string dependency = Directory(source) + line.substr(begin + 1, end - begin - 1);
+
+				if (std::find(dependencies.begin(), dependencies.end(), dependency) != dependencies.end()) continue;
+
+				dependencies.emplace_back(dependency);
+				ScanIncludes(resource_dir, dependency, dependencies);
+			}
+		}
+
+		std::vector<std::string> ScanDependencies(const std::string& resource_dir, const std::string& source)
+		{
+			std::vector<std::string> dependencies;
+
+			if (GetAssetKind(source) == SHADER)
+				ScanIncludes(resource_dir, source, dependencies);
+
+			return dependencies;
+		}
+
+		bool CookShader(const std::string& resource_dir, CookedAsset& asset, std::string& error)
+		{
+			std::vector<char> text;
+			if (!AssetManifest::ReadFile(resource_dir + asset.source, text))
+			{
+				error = "cannot read " + asset.source;
+				return false;
+			}
+
+			const std::string code(text.begin(), text.end());
+			const std::wstring path = StrUtils::AsciiToUnicode((resource_dir + asset.source).c_str());
+			const std::string base = asset.source.substr(0, asset.source.find_last_of('.'));
+
+			for (auto& stage : SHADER_STAGES)
+			{
+				// only stages with an entry point in the source
+				if (code.find(std::string(stage.entry_point) + "(") == std::string::npos) continue;
+
+				Microsoft::WRL::ComPtr<ID3DBlob> blob;
+				Microsoft::WRL::ComPtr<ID3DBlob> error_blob;
+
+				if (failed(D3DCompileFromFile(path.c_str(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
+					stage.entry_point, stage.target, SHADER_COOK_FLAGS, 0, blob.GetAddressOf(), error_blob.GetAddressOf())))
+				{
+					error = error_blob ? static_cast<const char*>(error_blob->GetBufferPointer()) : "compile failed";
+					return false;
+				}
+
+				const std::string output = base + stage.suffix;
+				const std::string output_path = resource_dir + COOKED_DIR_NAME + output;
+				const std::wstring woutput_path = StrUtils::AsciiToUnicode(output_path.c_str());
+
+				if (!EnsureDirectory(output_path) || failed(D3DWriteBlobToFile(blob.Get(), woutput_path.c_str(), TRUE)))
+				{
+					error = "cannot write " + output_path;
+					return false;
+				}
+
+				asset.outputs.emplace_back(output);
+			}
+
+			if (asset.outputs.empty())
+			{
+				error = "no entry point found";
+				return false;
+			}
+
+			return true;
+		}
+
+		bool CookTexture(const std::string& resource_dir, CookedAsset& asset, std::string& error)
+		{
+			// COM is up from BeginThread
+			const std::string source_path = resource_dir + asset.source;
+			const std::wstring wsource_path(source_path.begin(), source_path.end());
+
+			DirectX::ScratchImage image;
+			HRESULT hr = Extension(asset.source) == ".tga"
+				? DirectX::LoadFromTGAFile(wsource_path.c_str(), nullptr, image)
+				: DirectX::LoadFromWICFile(wsource_path.c_str(), DirectX::WIC_FLAGS_NONE, nullptr, image);
+
+			if (failed(hr))
+			{
+				error = "cannot decode " + asset.source;
+				return false;
+			}
+
+			// keep the source extension so foo.png and foo.jpg do not collide
+			const std::string output = asset.source + ".dds";
+			const std::string output_path = resource_dir + COOKED_DIR_NAME + output;
+			const std::wstring woutput_path(output_path.begin(), output_path.end());
+
+			if (!EnsureDirectory(output_path) ||
+				failed(DirectX::SaveToDDSFile(image.GetImages(), image.GetImageCount(), image.GetMetadata(),
+					DirectX::DDS_FLAGS_NONE, woutput_path.c_str())))
+			{
+				error = "cannot write " + output_path;
+				return false;
+			}
+
+			asset.outputs.emplace_back(output);
+			return true;
+		}
+
+		void BeginThread(void)
+		{
+			com_result_ = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+		}
+
+		void EndThread(void)
+		{
+			if (SUCCEEDED(com_result_)) CoUninitialize();
+			com_result_ = E_FAIL;
+		}
+
+		bool Cook(const std::string& resource_dir, CookedAsset& asset, std::string& error)
+		{
+			asset.outputs.clear();
+
+			switch (GetAssetKind(asset.source))
+			{
+			case SHADER:
+				return CookShader(resource_dir, asset, error);
+			case TEXTURE:
+				return CookTexture(resource_dir, asset, error);
+			default:
+				error = "unknown asset type";
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include<string>
+#include<vector>
+
+#include"..\..\Utilities\AssetManifest.h"
+
+namespace Prizm
+{
+	namespace Cookers
+	{
+		enum AssetKind
+		{
+			SHADER,
+			TEXTURE,
+			UNKNOWN,
+		};
+
+		AssetKind GetAssetKind(const std::string& source);
+
+		// files the source pulls in (shader #include), relative to resource dir
+		std::vector<std::string> ScanDependencies(const std::string& resource_dir, const std::string& source);
+
+		// COM for the WIC decoder, once on every thread that cooks, before its first Cook
+		void BeginThread(void);
+		void EndThread(void);
+
+		// cook one source into <resource dir>/Cooked/, fills asset.outputs
+		bool Cook(const std::string& resource_dir, CookedAsset& asset, std::string& error);
+	}
+}
@@ -0,0 +1,275 @@
+#include<cmath>
+#include<atomic>
+#include<chrono>
+#include<random>
+#include<string>
+#include<thread>
+#include<vector>
+#include<cstdlib>
+#include<iostream>
+
+#include"../../Graphics/Window.h"
+#include"../../Input/Input.h"
+#include"../../Input/InputRecorder.h"
+#include"../../Game/GameTime.h"
+#include"../../Game/SceneTransition.h"
+#include"../../Game/AudioDriver/AudioDriver.h"
+#include"../../Framework/SoundFramework/Sound.h"
+#include"../../Utilities/FramePacer.h"
+#include"../../Utilities/PerfTimer.h"
+#include"../../Utilities/Log.h"
+#include"../../Utilities/Memory.h"
+
+/*
+The platform layer without the renderer, what runs on a machine with no D3D11.
+
+HeadlessRunner [--frames N] [--record path] [--replay path] [--scene-change N]
+               [--audio backend] [--audio-file path] [--audio-fast] [--memory-check]
+
+The frame loop of BaseSystem with the game left out: headless window, input,
+fixed steps and the mixer behind the configured audio driver (null by default),
+paced at the simulation rate. A replay runs unpaced and stops at its end, the
+step count and checksum it prints match the run that recorded it.
+
+--scene-change requests a scene transition every N frames, the load is a thread
+sleeping for a random time, the transition states and swap frames go into the checksum.
+
+The runner links Game/MemoryHooks.cpp like the game, the audio setup is tagged
+Memory::AUDIO. --memory-check fails the run unless the tagged live bytes went up
+with the setup and back down to where they started after the shutdown.
+*/
+
+namespace Prizm
+{
+	struct RunnerOptions
+	{
+		unsigned int frame_limit = 0;
+		std::string record_path;
+		std::string replay_path;
+		unsigned int scene_interval = 0;
+		AudioDriver::Options audio;
+		bool memory_check = false;
+	};
+
+	RunnerOptions ParseOptions(int argc, char** argv)
+	{
+		RunnerOptions options;
+		options.audio.backend = "null";
+
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string arg = argv[i];
+
+			if (arg == "--frames" && i + 1 < argc) options.frame_limit = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+			else if (arg == "--record" && i + 1 < argc) options.record_path = argv[++i];
+			else if (arg == "--replay" && i + 1 < argc) options.replay_path = argv[++i];
+			else if (arg == "--scene-change" && i + 1 < argc) options.scene_interval = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+			else if (arg == "--audio" && i + 1 < argc) options.audio.backend = argv[++i];
+			else if (arg == "--audio-file" && i + 1 < argc) options.audio.file_path = argv[++i];
+			else if (arg == "--audio-fast") options.audio.realtime = false;
+			else if (arg == "--memory-check") options.memory_check = true;
+		}
+
+		return options;
+	}
+
+	// FNV-1a
+	void Mix(std::uint64_t& hash, std::uint64_t value)
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+	}
+
+	// what the simulation saw this step
+	void HashStep(std::uint64_t& hash, std::uint64_t step)
+	{
+		Mix(hash, step);
+
+		for (KeyCode code = 0; code < Input::INPUT_CODE_COUNT; ++code)
+		{
+			if (Input::IsKeyPress(code)) Mix(hash, code);
+		}
+
+		Mix(hash, static_cast<std::uint64_t>(Input::MouseDeltaX()));
+		Mix(hash, static_cast<std::uint64_t>(Input::MouseDeltaY()));
+	}
+
+	// stand-in for the loader thread of SceneManager, takes as long as it likes
+	class SceneLoader
+	{
+	private:
+		std::thread _thread;
+		std::atomic<bool> _loaded;
+		std::mt19937 _random;
+
+	public:
+		SceneLoader(void) : _loaded(false), _random(std::random_device()()) {}
+		~SceneLoader(void) { Join(); }
+
+		void Start(void)
+		{
+			Join();
+
+			const auto milliseconds = std::uniform_int_distribution<int>(10, 200)(_random);
+
+			_loaded = false;
+			_thread = std::thread([this, milliseconds]()
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+				_loaded = true;
+			});
+		}
+
+		void Join(void)
+		{
+			if (_thread.joinable()) _thread.join();
+		}
+
+		bool IsLoaded(void) const { return _loaded; }
+	};
+
+	std::shared_ptr<SoundBuffer> MakeTone(unsigned int sample_rate, float frequency)
+	{
+		std::vector<float> samples(sample_rate);
+
+		for (unsigned int i = 0; i < sample_rate; ++i)
+		{
+			samples[i] = 0.25f * std::sin(2.0f * 3.14159265f * frequency * i / sample_rate);
+		}
+
+		return std::make_shared<SoundBuffer>(samples.data(), sample_rate, 1, sample_rate);
+	}
+
+	int Run(const RunnerOptions& options)
+	{
+		Input::Initialize();
+
+		if (!Window::Initialize(Window::HEADLESS)) return 1;
+
+		GameTime::Initialize();
+
+		if (!options.replay_path.empty())
+		{
+			double simulation_hz;
+			if (!InputRecorder::BeginReplay(options.replay_path, simulation_hz)) return 1;
+
+			GameTime::SetSimulationRate(simulation_hz);
+		}
+		else if (!options.record_path.empty())
+		{
+			if (!InputRecorder::BeginRecording(options.record_path, GameTime::GetSimulationRate())) return 1;
+		}
+
+		const auto audio_baseline = Memory::GetTagStats(Memory::AUDIO).live_bytes;
+		std::unique_ptr<Sound> sound;
+		std::unique_ptr<AudioDriver> driver;
+
+		{
+			Memory::TagScope tag(Memory::AUDIO);
+
+			sound = std::make_unique<Sound>();
+			sound->Initialize();
+
+			AudioDriver::Configure(options.audio);
+			auto mixer = sound.get();
+			driver = AudioDriver::Create([mixer](float* output, unsigned int frames) { mixer->Mix(output, frames); }, sound->GetSampleRate());
+
+			Sound::PlayParameters parameters;
+			parameters.loop = true;
+			sound->Play(MakeTone(sound->GetSampleRate(), 440.0f), parameters);
+		}
+
+		const auto audio_live = Memory::GetTagStats(Memory::AUDIO).live_bytes;
+
+		FramePacer pacer;
+		// a replay goes as fast as the machine allows, like the game's
+		if (!InputRecorder::IsReplaying()) pacer.SetTargetFrameRate(GameTime::GetSimulationRate());
+
+		SceneTransition transition;
+		SceneLoader loader;
+		unsigned int scene_count = 0;
+
+		unsigned int frame_count = 0;
+		std::uint64_t checksum = 14695981039346656037ull;
+		const auto begin_time = PerfTimer::Now();
+
+		while (true)
+		{
+			// like BaseSystem, wait before the pump so the input is not latched and then slept on
+			pacer.WaitForNextFrame();
+
+			if (!Window::PumpMessages()) break;
+
+			Input::PreStateUpdate();
+
+			if (InputRecorder::IsReplayFinished()) break;
+
+			const unsigned int steps = GameTime::Advance();
+
+			for (unsigned int i = 0; i < steps; ++i)
+			{
+				HashStep(checksum, GameTime::GetStepCount() - steps + i);
+			}
+
+			if (options.scene_interval && frame_count % options.scene_interval == 0 && !transition.IsActive())
+			{
+				transition.Begin();
+				loader.Start();
+			}
+
+			if (transition.Update(loader.IsLoaded()))
+			{// like SceneManager::SwapScene, the replay may get here before the load is done
+				loader.Join();
+				++scene_count;
+				Mix(checksum, frame_count);
+			}
+
+			Mix(checksum, transition.GetState());
+
+			sound->Update();
+
+			Input::PostStateUpdate();
+
+			if (++frame_count == options.frame_limit) break;
+		}
+
+		const double seconds = (PerfTimer::Now() - begin_time) * 1e-9;
+
+		std::cout << frame_count << " frames in " << seconds << " s, " << GameTime::GetStepCount() << " steps, " << scene_count << " scene changes, checksum "
+		          << std::hex << checksum << std::dec;
+		if (driver) std::cout << ", " << driver->GetUnderrunCount() << " audio underruns";
+		std::cout << std::endl;
+
+		if (driver) driver->Finalize();
+		driver.reset();
+		sound->Finalize();
+		sound.reset();
+
+		int result = 0;
+
+		if (options.memory_check)
+		{
+			const auto audio_left = Memory::GetTagStats(Memory::AUDIO).live_bytes;
+
+			std::cout << "audio heap " << audio_live - audio_baseline << " bytes live while running, "
+			          << static_cast<std::int64_t>(audio_left - audio_baseline) << " after shutdown" << std::endl;
+
+			if (audio_live <= audio_baseline || audio_left != audio_baseline) result = 1;
+		}
+
+		InputRecorder::EndRecording();
+		InputRecorder::EndReplay();
+
+		Window::Finalize();
+
+		return result;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	return Prizm::Run(Prizm::ParseOptions(argc, argv));
+}
@@ -0,0 +1,303 @@
+#include<ctime>
+#include<cstdio>
+#include<cstring>
+#include<string>
+#include<vector>
+#include<fstream>
+#include<iostream>
+#include<iterator>
+#include<unordered_map>
+
+#include"../../Utilities/BinaryLog.h"
+#include"../../Utilities/Platform.h"
+
+#ifdef _MSC_VER
+#pragma comment(lib, "Utilities.lib")
+#endif
+
+/*
+Renders a binary log written by Log::BINARY_FILE / CONSOLE_AND_BINARY_FILE.
+
+LogDecoder <file.plog> [--json] [--output path]
+
+Text output matches the plain log files, with milliseconds and the
+logging thread added. --json writes an array with one object per message
+that keeps the format string and the typed arguments next to the text.
+*/
+
+namespace Prizm
+{
+	constexpr const char* LEVEL_NAMES[] = { "INFO", "WARNING", "ERROR" };
+
+	struct LogHeader
+	{
+		double ticks_per_second;
+		std::uint64_t origin_ticks;
+		std::int64_t origin_time;
+	};
+
+	struct Message
+	{
+		std::uint8_t level;
+		std::uint64_t thread;
+		std::uint64_t ticks;
+		std::uint64_t format_id;
+		const char* arguments;
+		std::uint64_t size;
+	};
+
+	class LogReader
+	{
+	private:
+		const std::vector<char>& _data;
+		std::size_t _offset;
+
+	public:
+		explicit LogReader(const std::vector<char>& data) : _data(data), _offset(0) {}
+
+		bool AtEnd(void) const { return _offset >= _data.size(); }
+		std::size_t GetOffset(void) const { return _offset; }
+
+		bool ReadVarint(std::uint64_t& value)
+		{
+			const char* data = _data.data() + _offset;
+			if (!BinaryLog::ReadVarint(data, _data.data() + _data.size(), value)) return false;
+
+			_offset = data - _data.data();
+			return true;
+		}
+
+		template<class _T>
+		bool Read(_T& value)
+		{
+			if (_offset + sizeof(_T) > _data.size()) return false;
+
+			std::memcpy(&value, _data.data() + _offset, sizeof(_T));
+			_offset += sizeof(_T);
+			return true;
+		}
+
+		// points into the file data, no copy
+		bool ReadBytes(const char*& bytes, std::size_t size)
+		{
+			if (_offset + size > _data.size()) return false;
+
+			bytes = _data.data() + _offset;
+			_offset += size;
+			return true;
+		}
+	};
+
+	std::string FormatTime(const LogHeader& header, std::uint64_t ticks)
+	{
+		const double elapsed = (static_cast<double>(ticks) - static_cast<double>(header.origin_ticks)) / header.ticks_per_second;
+		const std::int64_t time = header.origin_time + static_cast<std::int64_t>(elapsed * 1e9);
+
+		const std::time_t seconds = static_cast<std::time_t>(time / 1000000000);
+		std::tm local_time;
+		Platform::LocalTime(seconds, local_time);
+
+		char buffer[48];
+		snprintf(buffer, sizeof(buffer), "%04d_%02d_%02d-%02d_%02d_%02d.%03d",
+			local_time.tm_year + 1900, local_time.tm_mon + 1, local_time.tm_mday,
+			local_time.tm_hour, local_time.tm_min, local_time.tm_sec, static_cast<int>(time / 1000000 % 1000));
+
+		return buffer;
+	}
+
+	std::string EscapeJson(const std::string& str)
+	{
+		std::string result;
+
+		for (unsigned char c : str)
+		{
+			if (c == '"' || c == '\\')
+			{
+				result += '\\';
+				result += static_cast<char>(c);
+			}
+			else if (c == '\n') result += "\\n";
+			else if (c == '\t') result += "\\t";
+			else if (c < 0x20)
+			{
+				char buffer[8];
+				snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				result += buffer;
+			}
+			else result += static_cast<char>(c);
+		}
+
+		return result;
+	}
+
+	std::string ArgumentToJson(const BinaryLog::Value& value)
+	{
+		std::string text;
+		Format::StringSink sink(text);
+
+		const std::vector<BinaryLog::Value> single = { value };
+		BinaryLog::FormatMessage(sink, "{}", single);
+
+		switch (value.type)
+		{
+		case BinaryLog::ARGUMENT_BOOL:
+		case BinaryLog::ARGUMENT_INT:
+		case BinaryLog::ARGUMENT_UINT:
+			return text;
+
+		case BinaryLog::ARGUMENT_DOUBLE:
+			// inf and nan are not JSON numbers
+			return text.find_first_of("in") == std::string::npos ? text : "\"" + text + "\"";
+
+		default:
+			return "\"" + EscapeJson(text) + "\"";
+		}
+	}
+
+	bool Decode(const std::vector<char>& data, std::ostream& out, bool json)
+	{
+		LogReader reader(data);
+
+		const char* magic;
+		LogHeader header;
+
+		if (!reader.ReadBytes(magic, BinaryLog::MAGIC_SIZE) || std::memcmp(magic, BinaryLog::MAGIC, BinaryLog::MAGIC_SIZE) != 0
+			|| !reader.Read(header.ticks_per_second) || !reader.Read(header.origin_ticks) || !reader.Read(header.origin_time)
+			|| header.ticks_per_second <= 0.0)
+		{
+			std::cerr << "Not a PrizmEngine binary log." << std::endl;
+			return false;
+		}
+
+		std::unordered_map<std::uint64_t, std::string> formats;
+		formats[BinaryLog::TEXT_FORMAT_ID] = BinaryLog::TEXT_FORMAT;
+
+		std::vector<BinaryLog::Value> values;
+		std::string text;
+		std::size_t message_count = 0;
+		std::uint64_t ticks = header.origin_ticks;
+
+		if (json) out << "[\n";
+
+		while (!reader.AtEnd())
+		{
+			const auto record_offset = reader.GetOffset();
+			std::uint8_t type = 0;
+			reader.Read(type);
+
+			if (type == BinaryLog::RECORD_FORMAT)
+			{
+				std::uint64_t id;
+				std::uint64_t length;
+				const char* bytes;
+
+				if (!reader.ReadVarint(id) || !reader.ReadVarint(length) || !reader.ReadBytes(bytes, static_cast<std::size_t>(length)))
+				{
+					std::cerr << "Truncated format record at " << record_offset << "." << std::endl;
+					break;
+				}
+
+				formats[id].assign(bytes, static_cast<std::size_t>(length));
+				continue;
+			}
+
+			Message message;
+			std::uint64_t delta;
+
+			if (type != BinaryLog::RECORD_MESSAGE
+				|| !reader.Read(message.level) || !reader.ReadVarint(message.thread) || !reader.ReadVarint(delta)
+				|| !reader.ReadVarint(message.format_id) || !reader.ReadVarint(message.size)
+				|| !reader.ReadBytes(message.arguments, static_cast<std::size_t>(message.size)))
+			{// a crash can cut the last batch short, everything before it is still good
+				std::cerr << "Corrupt or truncated record at " << record_offset << ", stopping." << std::endl;
+				break;
+			}
+
+			ticks += static_cast<std::uint64_t>(BinaryLog::UnZigZag(delta));
+			message.ticks = ticks;
+
+			auto format = formats.find(message.format_id);
+			const char* format_text = format != formats.end() ? format->second.c_str() : "<unknown format>";
+			const char* level = message.level < 3 ? LEVEL_NAMES[message.level] : "UNKNOWN";
+
+			if (!BinaryLog::DecodeArguments(message.arguments, static_cast<std::size_t>(message.size), values))
+				std::cerr << "Bad arguments at " << record_offset << "." << std::endl;
+
+			text.clear();
+			Format::StringSink sink(text);
+			BinaryLog::FormatMessage(sink, format_text, values);
+
+			if (json)
+			{
+				if (message_count) out << ",\n";
+
+				out << "{\"time\":\"" << FormatTime(header, message.ticks) << "\",\"ticks\":" << message.ticks
+					<< ",\"level\":\"" << level << "\",\"thread\":" << message.thread
+					<< ",\"format\":\"" << EscapeJson(format_text) << "\",\"args\":[";
+
+				for (std::size_t i = 0; i < values.size(); ++i)
+					out << (i ? "," : "") << ArgumentToJson(values[i]);
+
+				out << "],\"message\":\"" << EscapeJson(text) << "\"}";
+			}
+			else
+			{
+				out << '[' << FormatTime(header, message.ticks) << "][" << level << "][T" << message.thread << "]: " << text << '\n';
+			}
+
+			++message_count;
+		}
+
+		if (json) out << "\n]\n";
+
+		std::cerr << message_count << " messages, " << formats.size() << " formats, " << data.size() << " bytes." << std::endl;
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Prizm;
+
+	std::string input_path;
+	std::string output_path;
+	bool json = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--json") json = true;
+		else if (arg == "--output" && i + 1 < argc) output_path = argv[++i];
+		else input_path = arg;
+	}
+
+	if (input_path.empty())
+	{
+		std::cerr << "LogDecoder <file.plog> [--json] [--output path]" << std::endl;
+		return 1;
+	}
+
+	std::ifstream file(input_path, std::ios::binary);
+
+	if (!file)
+	{
+		std::cerr << "Cannot open " << input_path << std::endl;
+		return 1;
+	}
+
+	const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (output_path.empty())
+		return Decode(data, std::cout, json) ? 0 : 1;
+
+	std::ofstream out(output_path);
+
+	if (!out)
+	{
+		std::cerr << "Cannot open " << output_path << std::endl;
+		return 1;
+	}
+
+	return Decode(data, out, json) ? 0 : 1;
+}
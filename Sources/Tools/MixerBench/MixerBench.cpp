@@ -0,0 +1,157 @@
+#include<cmath>
+#include<random>
+#include<string>
+#include<vector>
+#include<iomanip>
+#include<iostream>
+
+#include"../../Framework/SoundFramework/Sound.h"
+#include"../../Utilities/PerfTimer.h"
+
+#ifdef _MSC_VER
+#pragma comment(lib, "Framework.lib")
+#pragma comment(lib, "Utilities.lib")
+#endif
+
+/*
+Mixing throughput of Sound, rendered offline on one thread.
+
+MixerBench [--voices N] [--seconds S] [--rate Hz] [--period frames] [--pitch] [--max-voices M]
+
+Plays N looping voices, half mono at 44.1 kHz and half stereo at the output rate,
+and pulls S seconds in period sized chunks like a driver would. Without --voices
+it sweeps 1 to MAX_VOICES. --pitch gives every voice a random pitch so no voice
+takes the same rate copy path. Every voice is mixed unless --max-voices caps them,
+then the cost should stay flat past M.
+*/
+
+namespace Prizm
+{
+	struct BenchOptions
+	{
+		unsigned int voices = 0;
+		double seconds = 10.0;
+		unsigned int sample_rate = 48000;
+		unsigned int period = 480;
+		bool pitch = false;
+		unsigned int max_voices = Sound::MAX_VOICES;
+	};
+
+	std::shared_ptr<SoundBuffer> MakeTone(unsigned int sample_rate, float frequency)
+	{
+		std::vector<float> samples(sample_rate);
+
+		for (unsigned int i = 0; i < sample_rate; ++i)
+		{
+			samples[i] = 0.5f * std::sin(2.0f * 3.14159265f * frequency * i / sample_rate);
+		}
+
+		return std::make_shared<SoundBuffer>(samples.data(), sample_rate, 1, sample_rate);
+	}
+
+	std::shared_ptr<SoundBuffer> MakeNoise(unsigned int sample_rate)
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> distribution(-0.25f, 0.25f);
+		std::vector<float> samples(sample_rate);
+
+		for (auto& sample : samples) sample = distribution(random);
+
+		return std::make_shared<SoundBuffer>(samples.data(), sample_rate / 2, 2, sample_rate);
+	}
+
+	void Run(const BenchOptions& options, unsigned int voice_count)
+	{
+		Sound sound;
+		sound.Initialize(options.sample_rate);
+		sound.SetMaxVoices(options.max_voices);
+
+		const std::shared_ptr<const SoundBuffer> buffers[] = { MakeTone(44100, 440.0f), MakeNoise(options.sample_rate) };
+
+		std::mt19937 random(voice_count);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		for (unsigned int i = 0; i < voice_count; ++i)
+		{
+			Sound::PlayParameters parameters;
+			parameters.gain = 1.0f / voice_count;
+			parameters.pan = unit(random) * 2.0f - 1.0f;
+			parameters.pitch = options.pitch ? 0.5f + unit(random) * 1.5f : 1.0f;
+			parameters.loop = true;
+			// the quieter ones go virtual first under a cap
+			parameters.gain *= 0.5f + unit(random);
+
+			sound.Play(buffers[i & 1], parameters);
+		}
+
+		const auto total_frames = static_cast<unsigned long long>(options.seconds * options.sample_rate);
+		std::vector<float> output(options.period * sound.GetChannels());
+
+		const auto begin = PerfTimer::Now();
+
+		for (unsigned long long frames = 0; frames < total_frames; frames += options.period)
+		{
+			sound.Mix(output.data(), options.period);
+		}
+
+		const double elapsed_ms = (PerfTimer::Now() - begin) / 1000000.0;
+		const double voice_frames = static_cast<double>(total_frames) * voice_count;
+
+		std::cout << std::setw(6) << voice_count << " voices " << std::setw(4) << sound.GetRealVoiceCount() << " mixed  "
+		          << std::fixed << std::setprecision(1)
+		          << std::setw(9) << elapsed_ms << " ms  "
+		          << std::setw(9) << options.seconds * 1000.0 / elapsed_ms << " x realtime  "
+		          << std::setw(9) << voice_frames / elapsed_ms / 1000.0 << " voice kframes/ms  "
+		          << std::setprecision(2)
+		          << std::setw(7) << elapsed_ms * 1000000.0 / voice_frames << " ns/voice frame"
+		          << std::endl;
+
+		sound.Finalize();
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Prizm;
+
+	BenchOptions options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--voices" && i + 1 < argc) options.voices = std::stoul(argv[++i]);
+		else if (arg == "--seconds" && i + 1 < argc) options.seconds = std::stod(argv[++i]);
+		else if (arg == "--rate" && i + 1 < argc) options.sample_rate = std::stoul(argv[++i]);
+		else if (arg == "--period" && i + 1 < argc) options.period = std::stoul(argv[++i]);
+		else if (arg == "--pitch") options.pitch = true;
+		else if (arg == "--max-voices" && i + 1 < argc) options.max_voices = std::stoul(argv[++i]);
+		else
+		{
+			std::cerr << "MixerBench [--voices N] [--seconds S] [--rate Hz] [--period frames] [--pitch] [--max-voices M]" << std::endl;
+			return 1;
+		}
+	}
+
+	if (options.voices > Sound::MAX_VOICES || options.max_voices > Sound::MAX_VOICES || options.sample_rate == 0 || options.period == 0)
+	{
+		std::cerr << "voices and max voices have to be at most " << Sound::MAX_VOICES << ", rate and period above 0" << std::endl;
+		return 1;
+	}
+
+	std::cout << "block " << Sound::BLOCK_FRAMES << " frames, " << options.sample_rate << " Hz, period " << options.period
+	          << (options.pitch ? ", random pitch" : "") << ", at most " << options.max_voices << " mixed" << std::endl;
+
+	if (options.voices)
+	{
+		Run(options, options.voices);
+		return 0;
+	}
+
+	for (unsigned int voices = 1; voices <= Sound::MAX_VOICES; voices *= 4)
+	{
+		Run(options, voices);
+	}
+
+	return 0;
+}
@@ -0,0 +1,222 @@
+#include<new>
+#include<atomic>
+#include<random>
+#include<string>
+#include<vector>
+#include<cstdlib>
+#include<iomanip>
+#include<iostream>
+
+#include"../../Framework/Entity.h"
+#include"../../Utilities/ResourcePool.h"
+#include"../../Utilities/PoolAllocator.h"
+#include"../../Utilities/PerfTimer.h"
+
+#ifdef _MSC_VER
+#pragma comment(lib, "Framework.lib")
+#pragma comment(lib, "Utilities.lib")
+#endif
+
+/*
+Entity churn through the spawn path of BaseScene, without a scene or a device.
+
+PoolBench [--spawns N] [--alive N] [--seconds S] [--rate Hz] [--make-shared]
+
+Keeps --alive enemies in a ResourcePool and every frame despawns and spawns
+N / rate of them, N per second (10000 by default). An enemy owns one component
+like the game's, both come from PoolAllocator. --make-shared allocates the
+enemies with std::make_shared the way the scenes did before the pools.
+
+The first second warms the pools up, after it every call into the global
+allocator is counted, a new slab included. With the pools the count has to stay
+0, otherwise the run fails.
+*/
+
+namespace
+{
+	std::atomic<unsigned long long> global_allocations(0);
+}
+
+void* operator new(std::size_t size)
+{
+	++global_allocations;
+
+	if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace Prizm
+{
+	struct BenchOptions
+	{
+		unsigned int spawns = 10000;
+		unsigned int alive = 2000;
+		double seconds = 5.0;
+		unsigned int rate = 60;
+		bool make_shared = false;
+	};
+
+	class Mover : public Component
+	{
+	private:
+		float _velocity[3] = {};
+
+	public:
+		bool Initialize(void) override { _velocity[0] = 1.0f; return true; }
+		void Run(void) override { _velocity[1] += _velocity[0]; }
+		void Draw(void) override {}
+		void Finalize(void) override {}
+	};
+
+	class Enemy : public Entity
+	{
+	private:
+		float _position[3] = {};
+		int _health = 0;
+
+	public:
+		bool Initialize(void) override
+		{
+			_health = 100;
+			AddComponent<Mover>();
+			return true;
+		}
+
+		void Run(void) override { _position[0] += 1.0f; RunComponets(); }
+		void Draw(void) override {}
+		void Finalize(void) override { FinalizeComponets(); }
+
+		int GetHealth(void) const { return _health; }
+	};
+
+	// BaseScene::AddGameObject3D / RemoveGameObject3D
+	class EnemyPool
+	{
+	private:
+		ResourcePool<Entity> _pool;
+		std::vector<unsigned int> _indices;
+		bool _make_shared;
+
+	public:
+		EnemyPool(unsigned int capacity, bool make_shared) : _make_shared(make_shared) { _indices.reserve(capacity); }
+
+		void Spawn(void)
+		{
+			const auto index = _make_shared
+				? _pool.Load(std::make_shared<Enemy>())
+				: _pool.Load(std::allocate_shared<Enemy>(PoolAllocator<Enemy>()));
+
+			_indices.emplace_back(index);
+			_pool.Get(index)->Initialize();
+		}
+
+		void Despawn(unsigned int slot)
+		{
+			const auto index = _indices[slot];
+
+			_pool.Get(index)->Finalize();
+			_pool.Release(index);
+
+			_indices[slot] = _indices.back();
+			_indices.pop_back();
+		}
+
+		void Run(void)
+		{
+			for (auto index : _indices) _pool.Get(index)->Run();
+		}
+
+		unsigned int GetAliveCount(void) const { return static_cast<unsigned int>(_indices.size()); }
+	};
+
+	int Run(const BenchOptions& options)
+	{
+		EnemyPool enemies(options.alive, options.make_shared);
+		std::mt19937 random(1);
+
+		for (unsigned int i = 0; i < options.alive; ++i) enemies.Spawn();
+
+		const unsigned int per_frame = (std::max)(options.spawns / options.rate, 1u);
+		const auto total_frames = static_cast<unsigned long long>(options.seconds * options.rate);
+
+		unsigned long long spawn_count = 0;
+		unsigned long long allocations = 0;
+		auto begin = PerfTimer::Now();
+
+		for (unsigned long long frame = 0; frame < total_frames; ++frame)
+		{
+			if (frame == options.rate)
+			{// the pools have seen the peak by now
+				spawn_count = 0;
+				allocations = global_allocations;
+				begin = PerfTimer::Now();
+			}
+
+			for (unsigned int i = 0; i < per_frame && enemies.GetAliveCount(); ++i)
+			{
+				enemies.Despawn(std::uniform_int_distribution<unsigned int>(0, enemies.GetAliveCount() - 1)(random));
+			}
+
+			for (unsigned int i = 0; i < per_frame; ++i) enemies.Spawn();
+
+			spawn_count += per_frame;
+			enemies.Run();
+		}
+
+		const double elapsed_ms = (PerfTimer::Now() - begin) / 1000000.0;
+		allocations = global_allocations - allocations;
+
+		std::cout << (options.make_shared ? "make_shared " : "pooled      ")
+		          << spawn_count << " spawns  " << enemies.GetAliveCount() << " alive  "
+		          << std::fixed << std::setprecision(1)
+		          << std::setw(8) << elapsed_ms << " ms  "
+		          << std::setprecision(2)
+		          << std::setw(7) << elapsed_ms * 1000000.0 / (spawn_count ? spawn_count : 1) << " ns/spawn  "
+		          << std::setw(5) << static_cast<double>(allocations) / (spawn_count ? spawn_count : 1) << " heap allocations/spawn";
+		std::cout << std::endl;
+
+		return options.make_shared || allocations == 0 ? 0 : 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Prizm;
+
+	BenchOptions options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--spawns" && i + 1 < argc) options.spawns = std::stoul(argv[++i]);
+		else if (arg == "--alive" && i + 1 < argc) options.alive = std::stoul(argv[++i]);
+		else if (arg == "--seconds" && i + 1 < argc) options.seconds = std::stod(argv[++i]);
+		else if (arg == "--rate" && i + 1 < argc) options.rate = std::stoul(argv[++i]);
+		else if (arg == "--make-shared") options.make_shared = true;
+		else
+		{
+			std::cerr << "PoolBench [--spawns N] [--alive N] [--seconds S] [--rate Hz] [--make-shared]" << std::endl;
+			return 1;
+		}
+	}
+
+	if (options.rate == 0 || options.seconds <= 1.0)
+	{
+		std::cerr << "rate has to be above 0 and seconds above 1, the first second is warm-up" << std::endl;
+		return 1;
+	}
+
+	return Run(options);
+}
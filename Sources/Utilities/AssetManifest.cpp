@@ -0,0 +1,187 @@
+
+#include<fstream>
+#include<sstream>
+#include<algorithm>
+
+#include"AssetManifest.h"
+#include"Utils.h"
+
+namespace Prizm
+{
+	namespace
+	{
+		// one asset per line, tab separated
+		// source	hash	dependency;dependency	output;output
+		constexpr const char* MANIFEST_HEADER = "# PrizmEngine asset manifest v1";
+
+		std::vector<std::string> Split(const std::string& str, char delimiter)
+		{
+			std::vector<std::string> result;
+			std::stringstream ss(str);
+			std::string item;
+
+			while (std::getline(ss, item, delimiter))
+			{
+				if (!item.empty()) result.emplace_back(item);
+			}
+
+			return result;
+		}
+
+		std::string Join(const std::vector<std::string>& items, char delimiter)
+		{
+			std::string result;
+
+			for (auto& item : items)
+			{
+				if (!result.empty()) result += delimiter;
+				result += item;
+			}
+
+			return result;
+		}
+	}
+
+	std::string CookedAsset::FindOutput(const std::string& suffix) const
+	{
+		for (auto& output : outputs)
+		{
+			if (output.size() >= suffix.size() &&
+				output.compare(output.size() - suffix.size(), suffix.size(), suffix) == 0)
+				return output;
+		}
+
+		return "";
+	}
+
+	bool AssetManifest::Load(const std::string& path)
+	{
+		std::ifstream in(path);
+		if (!in) return false;
+
+		_assets.clear();
+
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (line.empty() || line[0] == '#') continue;
+
+			std::vector<std::string> columns;
+			std::stringstream ss(line);
+			std::string column;
+			while (std::getline(ss, column, '\t'))
+			{
+				columns.emplace_back(column);
+			}
+
+			if (columns.size() < 2) continue;
+
+			CookedAsset asset;
+			asset.source = columns[0];
+			asset.hash = HashUtils::FromHexString(columns[1]);
+			if (columns.size() > 2) asset.dependencies = Split(columns[2], ';');
+			if (columns.size() > 3) asset.outputs = Split(columns[3], ';');
+
+			_assets[asset.source] = asset;
+		}
+
+		return true;
+	}
+
+	bool AssetManifest::Save(const std::string& path) const
+	{
+		std::ofstream out(path, std::ios::trunc);
+		if (!out) return false;
+
+		// sorted so the manifest diffs cleanly between cooks
+		std::vector<const CookedAsset*> sorted;
+		for (auto& asset : _assets)
+		{
+			sorted.emplace_back(&asset.second);
+		}
+
+		std::sort(sorted.begin(), sorted.end(),
+			[](const CookedAsset* a, const CookedAsset* b) { return a->source < b->source; });
+
+		out << MANIFEST_HEADER << "\n";
+
+		for (auto asset : sorted)
+		{
+			out << asset->source << '\t'
+				<< HashUtils::ToHexString(asset->hash) << '\t'
+				<< Join(asset->dependencies, ';') << '\t'
+				<< Join(asset->outputs, ';') << "\n";
+		}
+
+		return static_cast<bool>(out);
+	}
+
+	const CookedAsset* AssetManifest::Find(const std::string& source) const
+	{
+		auto it = _assets.find(source);
+		if (it == _assets.end()) return nullptr;
+
+		return &it->second;
+	}
+
+	void AssetManifest::Set(const CookedAsset& asset)
+	{
+		_assets[asset.source] = asset;
+	}
+
+	void AssetManifest::Remove(const std::string& source)
+	{
+		_assets.erase(source);
+	}
+
+	void AssetManifest::Clear(void)
+	{
+		_assets.clear();
+	}
+
+	bool AssetManifest::IsUpToDate(const std::string& resource_dir, const CookedAsset& asset)
+	{
+		const std::uint64_t hash = HashSources(resource_dir, asset.source, asset.dependencies);
+		return hash != 0 && hash == asset.hash;
+	}
+
+	std::uint64_t AssetManifest::HashSources(const std::string& resource_dir,
+		const std::string& source, const std::vector<std::string>& dependencies)
+	{
+		std::vector<char> data;
+
+		if (!ReadFile(resource_dir + source, data)) return 0;
+		std::uint64_t hash = HashUtils::Fnv1a64(data.data(), data.size());
+
+		for (auto& dependency : dependencies)
+		{
+			if (!ReadFile(resource_dir + dependency, data)) return 0;
+
+			// chain the name too, so renaming an include invalidates the asset
+			hash = HashUtils::Fnv1a64(dependency.data(), dependency.size(), hash);
+			hash = HashUtils::Fnv1a64(data.data(), data.size(), hash);
+		}
+
+		return hash;
+	}
+
+	bool AssetManifest::ReadFile(const std::string& path, std::vector<char>& out)
+	{
+		std::ifstream in(path, std::ios::binary | std::ios::ate);
+		if (!in) return false;
+
+		const std::streamsize size = in.tellg();
+		in.seekg(0, std::ios::beg);
+
+		out.resize(static_cast<size_t>(size));
+		if (size > 0 && !in.read(out.data(), size)) return false;
+
+		return true;
+	}
+
+	AssetManifest& AssetManifest::Runtime(void)
+	{
+		static AssetManifest manifest;
+		return manifest;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include<string>
+#include<vector>
+#include<unordered_map>
+#include<cstdint>
+
+namespace Prizm
+{
+	// cooked assets live under <resource dir>/Cooked/
+	const std::string COOKED_DIR_NAME = "Cooked\\";
+	const std::string MANIFEST_FILE_NAME = "manifest.txt";
+
+	struct CookedAsset
+	{
+		std::string source;						// relative to resource dir
+		std::uint64_t hash;						// content hash of source + dependencies
+		std::vector<std::string> dependencies;	// relative to resource dir
+		std::vector<std::string> outputs;		// relative to cooked dir
+
+		CookedAsset() : hash(0) {}
+
+		// first output whose name ends with suffix, empty if none
+		std::string FindOutput(const std::string& suffix) const;
+	};
+
+	class AssetManifest
+	{
+	private:
+		std::unordered_map<std::string, CookedAsset> _assets;
+
+	public:
+		bool Load(const std::string& path);
+		bool Save(const std::string& path) const;
+
+		const CookedAsset* Find(const std::string& source) const;
+		void Set(const CookedAsset& asset);
+		void Remove(const std::string& source);
+		void Clear(void);
+
+		size_t Size(void) const { return _assets.size(); }
+		const std::unordered_map<std::string, CookedAsset>& Assets(void) const { return _assets; }
+
+		// true when the sources on disk still hash to the cooked hash
+		static bool IsUpToDate(const std::string& resource_dir, const CookedAsset& asset);
+
+		// hash of the source and all dependencies, 0 if any of them is missing
+		static std::uint64_t HashSources(const std::string& resource_dir,
+			const std::string& source, const std::vector<std::string>& dependencies);
+
+		static bool ReadFile(const std::string& path, std::vector<char>& out);
+
+		// manifest the runtime loads at startup
+		static AssetManifest& Runtime(void);
+	};
+}
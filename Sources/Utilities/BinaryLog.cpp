@@ -0,0 +1,297 @@
+
+#include<cstring>
+#include<algorithm>
+
+#include"BinaryLog.h"
+
+namespace Prizm
+{
+	namespace
+	{
+		// padded two byte varint, so the length can be patched while the string grows
+		constexpr std::size_t STRING_LENGTH_SIZE = 2;
+
+		void WriteStringLength(char* out, std::size_t length)
+		{
+			out[0] = static_cast<char>(0x80 | (length & 0x7f));
+			out[1] = static_cast<char>(length >> 7);
+		}
+
+		std::size_t ReadStringLength(const char* data)
+		{
+			return (static_cast<unsigned char>(data[0]) & 0x7f) | (static_cast<std::size_t>(static_cast<unsigned char>(data[1])) << 7);
+		}
+
+		void FormatDecoded(Format::Sink& sink, const void* data, const Format::Spec& spec)
+		{
+			auto& value = *static_cast<const BinaryLog::Value*>(data);
+
+			switch (value.type)
+			{
+			case BinaryLog::ARGUMENT_BOOL:
+				Format::FormatValue(sink, value.raw != 0, spec);
+				break;
+
+			case BinaryLog::ARGUMENT_CHAR:
+				Format::FormatValue(sink, static_cast<char>(value.raw), spec);
+				break;
+
+			case BinaryLog::ARGUMENT_INT:
+				Format::FormatValue(sink, static_cast<long long>(BinaryLog::UnZigZag(value.raw)), spec);
+				break;
+
+			case BinaryLog::ARGUMENT_UINT:
+				Format::FormatValue(sink, static_cast<unsigned long long>(value.raw), spec);
+				break;
+
+			case BinaryLog::ARGUMENT_DOUBLE:
+			{
+				double real;
+				std::memcpy(&real, &value.raw, sizeof(real));
+				Format::FormatValue(sink, real, spec);
+				break;
+			}
+
+			case BinaryLog::ARGUMENT_POINTER:
+				// printed the same way, the address itself is never dereferenced
+				Format::FormatValue(sink, reinterpret_cast<const void*>(static_cast<std::uintptr_t>(value.raw)), spec);
+				break;
+
+			default:
+				Format::FormatValue(sink, value.text, spec);
+				break;
+			}
+		}
+	}
+
+	std::size_t BinaryLog::WriteVarint(char* out, std::uint64_t value)
+	{
+		std::size_t size = 0;
+
+		while (value >= 0x80)
+		{
+			out[size++] = static_cast<char>(value | 0x80);
+			value >>= 7;
+		}
+
+		out[size++] = static_cast<char>(value);
+		return size;
+	}
+
+	void BinaryLog::AppendVarint(std::string& out, std::uint64_t value)
+	{
+		char buffer[MAX_VARINT_SIZE];
+		out.append(buffer, WriteVarint(buffer, value));
+	}
+
+	bool BinaryLog::ReadVarint(const char*& data, const char* end, std::uint64_t& value)
+	{
+		value = 0;
+
+		for (unsigned int shift = 0; data < end && shift < 64; shift += 7)
+		{
+			const auto byte = static_cast<unsigned char>(*data++);
+			value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+			if (!(byte & 0x80)) return true;
+		}
+
+		return false;
+	}
+
+	BinaryLog::ArgumentWriter::ArgumentWriter(char* data, std::size_t capacity)
+		: _data(data)
+		, _capacity(capacity)
+		, _size(0)
+		, _string_begin(capacity)
+		, _truncated(false)
+	{
+	}
+
+	void BinaryLog::ArgumentWriter::PutRaw(ArgumentType type, const void* value, std::size_t size)
+	{
+		// a value is written whole or not at all
+		if (_size + 1 + size > _capacity)
+		{
+			_truncated = true;
+			return;
+		}
+
+		_data[_size++] = static_cast<char>(type);
+		std::memcpy(_data + _size, value, size);
+		_size += size;
+	}
+
+	void BinaryLog::ArgumentWriter::PutVarint(ArgumentType type, std::uint64_t value)
+	{
+		char buffer[MAX_VARINT_SIZE];
+		const auto size = WriteVarint(buffer, value);
+
+		if (_size + 1 + size > _capacity)
+		{
+			_truncated = true;
+			return;
+		}
+
+		_data[_size++] = static_cast<char>(type);
+		std::memcpy(_data + _size, buffer, size);
+		_size += size;
+	}
+
+	void BinaryLog::ArgumentWriter::Put(bool value)
+	{
+		const std::uint8_t byte = value ? 1 : 0;
+		PutRaw(ARGUMENT_BOOL, &byte, 1);
+	}
+
+	void BinaryLog::ArgumentWriter::Put(char value)
+	{
+		PutRaw(ARGUMENT_CHAR, &value, 1);
+	}
+
+	void BinaryLog::ArgumentWriter::Put(long long value)
+	{
+		PutVarint(ARGUMENT_INT, ZigZag(value));
+	}
+
+	void BinaryLog::ArgumentWriter::Put(unsigned long long value)
+	{
+		PutVarint(ARGUMENT_UINT, value);
+	}
+
+	void BinaryLog::ArgumentWriter::Put(double value)
+	{
+		const auto narrow = static_cast<float>(value);
+
+		if (static_cast<double>(narrow) == value)
+			PutRaw(ARGUMENT_FLOAT, &narrow, sizeof(narrow));
+		else
+			PutRaw(ARGUMENT_DOUBLE, &value, sizeof(value));
+	}
+
+	void BinaryLog::ArgumentWriter::Put(const char* value)
+	{
+		if (!value) value = "(null)";
+
+		BeginString();
+		Append(value, std::strlen(value));
+	}
+
+	void BinaryLog::ArgumentWriter::Put(const std::string& value)
+	{
+		BeginString();
+		Append(value.data(), value.size());
+	}
+
+	void BinaryLog::ArgumentWriter::Put(const void* value)
+	{
+		PutVarint(ARGUMENT_POINTER, static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value)));
+	}
+
+	void BinaryLog::ArgumentWriter::BeginString(void)
+	{
+		if (_size + 1 + STRING_LENGTH_SIZE > _capacity)
+		{// no room, the following Appends are dropped
+			_string_begin = _capacity;
+			_truncated = true;
+			return;
+		}
+
+		_data[_size++] = static_cast<char>(ARGUMENT_STRING);
+		_string_begin = _size;
+
+		WriteStringLength(_data + _size, 0);
+		_size += STRING_LENGTH_SIZE;
+	}
+
+	void BinaryLog::ArgumentWriter::Append(const char* text, std::size_t length)
+	{
+		if (_string_begin == _capacity) return;
+
+		const auto current = ReadStringLength(_data + _string_begin);
+
+		// cut at the buffer end or the length limit, whichever comes first
+		const auto count = (std::min)({ length, _capacity - _size, MAX_STRING_LENGTH - current });
+
+		std::memcpy(_data + _size, text, count);
+		_size += count;
+		_truncated |= count < length;
+
+		WriteStringLength(_data + _string_begin, current + count);
+	}
+
+	bool BinaryLog::DecodeArguments(const char* data, std::size_t size, std::vector<Value>& values)
+	{
+		values.clear();
+
+		const char* end = data + size;
+
+		while (data < end)
+		{
+			Value value = {};
+			value.type = static_cast<ArgumentType>(*data++);
+
+			switch (value.type)
+			{
+			case ARGUMENT_BOOL:
+			case ARGUMENT_CHAR:
+				if (data + 1 > end) return false;
+				value.raw = static_cast<unsigned char>(*data++);
+				break;
+
+			case ARGUMENT_INT:
+			case ARGUMENT_UINT:
+			case ARGUMENT_POINTER:
+				if (!ReadVarint(data, end, value.raw)) return false;
+				break;
+
+			case ARGUMENT_DOUBLE:
+				if (data + sizeof(double) > end) return false;
+				std::memcpy(&value.raw, data, sizeof(double));
+				data += sizeof(double);
+				break;
+
+			case ARGUMENT_FLOAT:
+			{// widened here, formatting only knows double
+				float narrow;
+				if (data + sizeof(narrow) > end) return false;
+				std::memcpy(&narrow, data, sizeof(narrow));
+				data += sizeof(narrow);
+
+				const double real = narrow;
+				std::memcpy(&value.raw, &real, sizeof(real));
+				value.type = ARGUMENT_DOUBLE;
+				break;
+			}
+
+			case ARGUMENT_STRING:
+			{
+				std::uint64_t length;
+				if (!ReadVarint(data, end, length) || length > static_cast<std::uint64_t>(end - data)) return false;
+
+				value.text.assign(data, static_cast<std::size_t>(length));
+				data += length;
+				break;
+			}
+
+			default:
+				return false;
+			}
+
+			values.emplace_back(std::move(value));
+		}
+
+		return true;
+	}
+
+	void BinaryLog::FormatMessage(Format::Sink& sink, const char* format, const std::vector<Value>& values)
+	{
+		std::vector<Format::Argument> arguments;
+		arguments.reserve(values.size());
+
+		for (auto& value : values)
+			arguments.emplace_back(Format::Argument{ &value, &FormatDecoded });
+
+		Format::FormatArguments(sink, format, arguments.data(), arguments.size());
+	}
+}
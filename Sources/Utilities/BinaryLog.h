@@ -0,0 +1,161 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+#include"Format.h"
+
+// structured log file, written by Log in the BINARY_FILE modes and rendered by Tools\LogDecoder
+//   header    "PRZMLOG1", ticks per second f64, origin ticks u64, origin system_clock ns i64
+//   format    u8 RECORD_FORMAT, id v, length v, text
+//   message   u8 RECORD_MESSAGE, level u8, thread v, ticks since the previous message zv, format id v, size v, arguments
+// v is an LEB128 varint, zv a zigzag varint, fixed size values are little endian as they are in memory
+// a format string is written once, the first time a message uses it
+// arguments are a type byte followed by the value, integers as varints, strings as length v and bytes
+
+namespace Prizm
+{
+	namespace BinaryLog
+	{
+		constexpr char MAGIC[] = "PRZMLOG1";
+		constexpr std::size_t MAGIC_SIZE = 8;
+		constexpr std::size_t HEADER_SIZE = MAGIC_SIZE + 8 + 8 + 8;
+
+		// format id of plain string messages, "{}" with one string argument
+		constexpr std::uint32_t TEXT_FORMAT_ID = 0;
+		constexpr const char* TEXT_FORMAT = "{}";
+
+		enum RecordType : std::uint8_t
+		{
+			RECORD_FORMAT = 1,
+			RECORD_MESSAGE,
+		};
+
+		enum ArgumentType : std::uint8_t
+		{
+			ARGUMENT_BOOL,
+			ARGUMENT_CHAR,
+			ARGUMENT_INT,		// zv
+			ARGUMENT_UINT,		// v
+			ARGUMENT_DOUBLE,	// f64
+			ARGUMENT_STRING,	// length v, bytes
+			ARGUMENT_POINTER,	// v
+			ARGUMENT_FLOAT,		// f32, also doubles that convert without loss
+		};
+
+		constexpr std::size_t MAX_VARINT_SIZE = 10;
+
+		// longest string argument, the length is always stored in two varint bytes
+		constexpr std::size_t MAX_STRING_LENGTH = 0x3fff;
+
+		inline std::uint64_t ZigZag(std::int64_t value)
+		{
+			return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+		}
+
+		inline std::int64_t UnZigZag(std::uint64_t value)
+		{
+			return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+		}
+
+		// returns the number of bytes written, out needs MAX_VARINT_SIZE
+		std::size_t WriteVarint(char* out, std::uint64_t value);
+		void AppendVarint(std::string& out, std::uint64_t value);
+
+		// advances data, false when the varint runs past end
+		bool ReadVarint(const char*& data, const char* end, std::uint64_t& value);
+
+		// serializes arguments into a fixed buffer, values that do not fit are cut
+		// types without an overload here are formatted to text with their FormatValue
+		class ArgumentWriter : public Format::Sink
+		{
+		private:
+			char* _data;
+			std::size_t _capacity;
+			std::size_t _size;
+			std::size_t _string_begin;	// length field of the string being appended to
+			bool _truncated;
+
+			void PutRaw(ArgumentType, const void* value, std::size_t size);
+			void PutVarint(ArgumentType, std::uint64_t value);
+
+		public:
+			ArgumentWriter(char* data, std::size_t capacity);
+
+			std::size_t GetSize(void) const { return _size; }
+			// a value was cut or left out for lack of room
+			bool IsTruncated(void) const { return _truncated; }
+
+			void Put(bool);
+			void Put(char);
+			void Put(long long);
+			void Put(unsigned long long);
+			void Put(double);
+			void Put(const char*);
+			void Put(const std::string&);
+			void Put(const void*);
+
+			void Put(int value) { Put(static_cast<long long>(value)); }
+			void Put(long value) { Put(static_cast<long long>(value)); }
+			void Put(short value) { Put(static_cast<long long>(value)); }
+			void Put(signed char value) { Put(static_cast<long long>(value)); }
+			void Put(unsigned int value) { Put(static_cast<unsigned long long>(value)); }
+			void Put(unsigned long value) { Put(static_cast<unsigned long long>(value)); }
+			void Put(unsigned short value) { Put(static_cast<unsigned long long>(value)); }
+			void Put(unsigned char value) { Put(static_cast<unsigned long long>(value)); }
+			void Put(float value) { Put(static_cast<double>(value)); }
+			void Put(char* value) { Put(static_cast<const char*>(value)); }
+
+			template<class _T>
+			void Put(const _T& value)
+			{
+				BeginString();
+				Format::FormatErased<_T>(*this, &value, Format::Spec{ 0, -1 });
+			}
+
+			// starts an empty string argument, Append adds to it
+			void BeginString(void);
+			void Append(const char* text, std::size_t length) override;
+		};
+
+		template<class... Args>
+		std::size_t EncodeArguments(char* data, std::size_t capacity, const Args&... args)
+		{
+			ArgumentWriter writer(data, capacity);
+
+			const int expand[] = { 0, (writer.Put(args), 0)... };
+			(void)expand;
+
+			return writer.GetSize();
+		}
+
+		// false when a value did not fit, size is what was written either way
+		template<class... Args>
+		bool TryEncodeArguments(char* data, std::size_t capacity, std::size_t& size, const Args&... args)
+		{
+			ArgumentWriter writer(data, capacity);
+
+			const int expand[] = { 0, (writer.Put(args), 0)... };
+			(void)expand;
+
+			size = writer.GetSize();
+			return !writer.IsTruncated();
+		}
+
+		// one decoded argument, raw holds the value of every type but strings, doubles as bits
+		struct Value
+		{
+			ArgumentType type;
+			std::uint64_t raw;
+			std::string text;
+		};
+
+		// false when the bytes are not a valid argument list
+		bool DecodeArguments(const char* data, std::size_t size, std::vector<Value>& values);
+
+		// renders a message with the same rules as Format::FormatTo
+		void FormatMessage(Format::Sink&, const char* format, const std::vector<Value>& values);
+	}
+}
@@ -0,0 +1,148 @@
+
+#include<cstdio>
+#include<algorithm>
+
+#include"Format.h"
+
+namespace Prizm
+{
+	namespace
+	{
+		constexpr char DIGITS_LOWER[] = "0123456789abcdef";
+		constexpr char DIGITS_UPPER[] = "0123456789ABCDEF";
+
+		Format::Spec ParseSpec(const char*& str)
+		{
+			Format::Spec spec = { 0, -1 };
+
+			// str is just past '{'
+			if (*str == ':')
+			{
+				++str;
+
+				if (*str == '.')
+				{
+					spec.precision = 0;
+					for (++str; *str >= '0' && *str <= '9'; ++str)
+						spec.precision = spec.precision * 10 + (*str - '0');
+				}
+
+				if (*str != '}') spec.type = *str++;
+			}
+
+			// str is on '}'
+			return spec;
+		}
+
+		void AppendUnsigned(Format::Sink& sink, unsigned long long value, bool negative, char type)
+		{
+			char buffer[24];
+			char* end = buffer + sizeof(buffer);
+			char* p = end;
+
+			if (type == 'x' || type == 'X')
+			{
+				const char* digits = type == 'x' ? DIGITS_LOWER : DIGITS_UPPER;
+				do { *--p = digits[value & 0xf]; value >>= 4; } while (value);
+			}
+			else
+			{
+				do { *--p = static_cast<char>('0' + value % 10); value /= 10; } while (value);
+			}
+
+			if (negative) *--p = '-';
+
+			sink.Append(p, end - p);
+		}
+	}
+
+	void Format::FormatValue(Sink& sink, bool value, const Spec&)
+	{
+		if (value) sink.Append("true", 4);
+		else sink.Append("false", 5);
+	}
+
+	void Format::FormatValue(Sink& sink, char value, const Spec&)
+	{
+		sink.Append(&value, 1);
+	}
+
+	void Format::FormatValue(Sink& sink, long long value, const Spec& spec)
+	{
+		const bool negative = value < 0 && spec.type == 0;
+		const auto magnitude = negative ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+
+		AppendUnsigned(sink, magnitude, negative, spec.type);
+	}
+
+	void Format::FormatValue(Sink& sink, unsigned long long value, const Spec& spec)
+	{
+		AppendUnsigned(sink, value, false, spec.type);
+	}
+
+	void Format::FormatValue(Sink& sink, double value, const Spec& spec)
+	{
+		char buffer[64];
+		int length = 0;
+
+		if (spec.precision >= 0)
+			length = snprintf(buffer, sizeof(buffer), spec.type == 'f' ? "%.*f" : "%.*g", spec.precision, value);
+		else
+			length = snprintf(buffer, sizeof(buffer), "%g", value);
+
+		if (length > 0)
+			sink.Append(buffer, (std::min)(static_cast<std::size_t>(length), sizeof(buffer) - 1));
+	}
+
+	void Format::FormatValue(Sink& sink, const char* value, const Spec&)
+	{
+		if (!value) value = "(null)";
+		sink.Append(value, std::strlen(value));
+	}
+
+	void Format::FormatValue(Sink& sink, const std::string& value, const Spec&)
+	{
+		sink.Append(value.data(), value.size());
+	}
+
+	void Format::FormatValue(Sink& sink, const void* value, const Spec&)
+	{
+		sink.Append("0x", 2);
+		AppendUnsigned(sink, reinterpret_cast<std::uintptr_t>(value), false, 'x');
+	}
+
+	void Format::FormatArguments(Sink& sink, const char* format, const Argument* arguments, std::size_t count)
+	{
+		const char* literal = format;
+		std::size_t index = 0;
+
+		for (const char* p = format; *p; ++p)
+		{
+			if (*p != '{' && *p != '}') continue;
+
+			// flush the literal run, keep one brace of an escape pair
+			const bool escaped = p[1] == *p;
+			sink.Append(literal, p - literal + (escaped ? 1 : 0));
+
+			if (escaped)
+			{
+				++p;
+			}
+			else if (*p == '{')
+			{
+				++p;
+				const auto spec = ParseSpec(p);
+
+				if (index < count)
+				{
+					auto& argument = arguments[index++];
+					argument.format(sink, argument.value, spec);
+				}
+			}
+
+			literal = p + 1;
+		}
+
+		sink.Append(literal, std::strlen(literal));
+	}
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<string>
+#include<utility>
+#include<type_traits>
+
+// compile-time checked format string, "{}" placeholders in the spirit of std::format
+//   Log::Info(PRIZM_FMT("loaded {} textures in {:.2} ms"), count, ms);
+// specs: {:x} {:X} hex integers, {:.N} {:.Nf} floating point precision, {{ and }} escape braces
+#define PRIZM_FMT(str)																			\
+	[]																							\
+	{																							\
+		struct PrizmFormatString : ::Prizm::Format::FormatStringBase							\
+		{																						\
+			static constexpr const char* Get(void) { return str; }								\
+		};																						\
+		return PrizmFormatString();																\
+	}()
+
+namespace Prizm
+{
+	namespace Format
+	{
+		struct FormatStringBase {};
+
+		template<class _Format>
+		struct IsFormatString : std::is_base_of<FormatStringBase, _Format> {};
+
+		// output target, Append may be called many times per format
+		class Sink
+		{
+		public:
+			virtual ~Sink(void) = default;
+			virtual void Append(const char* text, std::size_t length) = 0;
+		};
+
+		// unbounded, for callers that want a std::string
+		class StringSink : public Sink
+		{
+		private:
+			std::string& _out;
+
+		public:
+			explicit StringSink(std::string& out) : _out(out) {}
+			void Append(const char* text, std::size_t length) override { _out.append(text, length); }
+		};
+
+		struct Spec
+		{
+			char type;			// 0, 'x', 'X', 'f'
+			int precision;		// -1 = default
+		};
+
+		// placeholder kinds for the compile-time type check
+		enum SpecKind
+		{
+			SPEC_ANY,
+			SPEC_INTEGER,
+			SPEC_FLOAT,
+			SPEC_INVALID,
+		};
+
+		// ---- compile-time parsing, everything below runs in static_assert ----
+
+		// kind of the placeholder starting at the '{' at str, SPEC_INVALID when malformed
+		constexpr SpecKind ParseSpecKind(const char* str)
+		{
+			++str;
+			if (*str == '}') return SPEC_ANY;
+			if (*str != ':') return SPEC_INVALID;
+			++str;
+
+			if (*str == 'x' || *str == 'X') return str[1] == '}' ? SPEC_INTEGER : SPEC_INVALID;
+
+			if (*str == '.')
+			{
+				++str;
+				if (*str < '0' || *str > '9') return SPEC_INVALID;
+				while (*str >= '0' && *str <= '9') ++str;
+				if (*str == 'f') ++str;
+				return *str == '}' ? SPEC_FLOAT : SPEC_INVALID;
+			}
+
+			return SPEC_INVALID;
+		}
+
+		// number of placeholders, -1 when the string is malformed
+		constexpr int CountPlaceholders(const char* str)
+		{
+			int count = 0;
+
+			while (*str)
+			{
+				if (*str == '{')
+				{
+					if (str[1] == '{') { str += 2; continue; }
+					if (ParseSpecKind(str) == SPEC_INVALID) return -1;
+
+					while (*str != '}') ++str;
+					++count;
+				}
+				else if (*str == '}')
+				{
+					if (str[1] != '}') return -1;
+					++str;
+				}
+
+				++str;
+			}
+
+			return count;
+		}
+
+		constexpr SpecKind PlaceholderKind(const char* str, int index)
+		{
+			while (*str)
+			{
+				if (*str == '{')
+				{
+					if (str[1] == '{') { str += 2; continue; }
+					if (index-- == 0) return ParseSpecKind(str);
+
+					while (*str != '}') ++str;
+				}
+				else if (*str == '}')
+				{
+					++str;
+				}
+
+				++str;
+			}
+
+			return SPEC_INVALID;
+		}
+
+		template<class _T>
+		constexpr bool Accepts(SpecKind kind)
+		{
+			return kind == SPEC_ANY
+				|| (kind == SPEC_INTEGER && std::is_integral<_T>::value && !std::is_same<_T, bool>::value)
+				|| (kind == SPEC_FLOAT && std::is_floating_point<_T>::value);
+		}
+
+		template<class _Format, class... Args, std::size_t... I>
+		constexpr bool SpecsMatch(std::index_sequence<I...>)
+		{
+			const bool accepted[] = { true, Accepts<typename std::decay<Args>::type>(PlaceholderKind(_Format::Get(), static_cast<int>(I)))... };
+
+			for (auto result : accepted)
+			{
+				if (!result) return false;
+			}
+
+			return true;
+		}
+
+		// ---- value formatting, overload FormatValue(Sink&, const T&, const Spec&) to add types ----
+
+		void FormatValue(Sink&, bool, const Spec&);
+		void FormatValue(Sink&, char, const Spec&);
+		void FormatValue(Sink&, long long, const Spec&);
+		void FormatValue(Sink&, unsigned long long, const Spec&);
+		void FormatValue(Sink&, double, const Spec&);
+		void FormatValue(Sink&, const char*, const Spec&);
+		void FormatValue(Sink&, const std::string&, const Spec&);
+		void FormatValue(Sink&, const void*, const Spec&);
+
+		inline void FormatValue(Sink& sink, int value, const Spec& spec) { FormatValue(sink, static_cast<long long>(value), spec); }
+		inline void FormatValue(Sink& sink, long value, const Spec& spec) { FormatValue(sink, static_cast<long long>(value), spec); }
+		inline void FormatValue(Sink& sink, short value, const Spec& spec) { FormatValue(sink, static_cast<long long>(value), spec); }
+		inline void FormatValue(Sink& sink, signed char value, const Spec& spec) { FormatValue(sink, static_cast<long long>(value), spec); }
+		inline void FormatValue(Sink& sink, unsigned int value, const Spec& spec) { FormatValue(sink, static_cast<unsigned long long>(value), spec); }
+		inline void FormatValue(Sink& sink, unsigned long value, const Spec& spec) { FormatValue(sink, static_cast<unsigned long long>(value), spec); }
+		inline void FormatValue(Sink& sink, unsigned short value, const Spec& spec) { FormatValue(sink, static_cast<unsigned long long>(value), spec); }
+		inline void FormatValue(Sink& sink, unsigned char value, const Spec& spec) { FormatValue(sink, static_cast<unsigned long long>(value), spec); }
+		inline void FormatValue(Sink& sink, float value, const Spec& spec) { FormatValue(sink, static_cast<double>(value), spec); }
+		inline void FormatValue(Sink& sink, char* value, const Spec& spec) { FormatValue(sink, static_cast<const char*>(value), spec); }
+
+		// type erased argument, built on the stack for the runtime pass
+		struct Argument
+		{
+			const void* value;
+			void(*format)(Sink&, const void*, const Spec&);
+		};
+
+		template<class _T>
+		void FormatErased(Sink& sink, const void* value, const Spec& spec)
+		{
+			FormatValue(sink, *static_cast<const _T*>(value), spec);
+		}
+
+		template<class _T>
+		Argument MakeArgument(const _T& value)
+		{
+			return Argument{ &value, &FormatErased<_T> };
+		}
+
+		// runtime pass, the format is already validated
+		void FormatArguments(Sink&, const char* format, const Argument* arguments, std::size_t count);
+
+		// compile-time validation only, shared by every consumer of a PRIZM_FMT string
+		template<class _Format, class... Args>
+		void CheckFormat(void)
+		{
+			static_assert(IsFormatString<_Format>::value, "wrap the format string in PRIZM_FMT()");
+			static_assert(CountPlaceholders(_Format::Get()) >= 0, "malformed format string");
+			static_assert(CountPlaceholders(_Format::Get()) == static_cast<int>(sizeof...(Args)), "format placeholder count does not match the arguments");
+			static_assert(SpecsMatch<_Format, Args...>(std::index_sequence_for<Args...>()), "format spec does not fit the argument type");
+		}
+
+		template<class _Format, class... Args>
+		void FormatTo(Sink& sink, _Format, const Args&... args)
+		{
+			CheckFormat<_Format, Args...>();
+
+			const Argument arguments[] = { Argument{ nullptr, nullptr }, MakeArgument(args)... };
+			FormatArguments(sink, _Format::Get(), arguments + 1, sizeof...(Args));
+		}
+
+		template<class _Format, class... Args>
+		std::string ToString(_Format format, const Args&... args)
+		{
+			std::string result;
+			StringSink sink(result);
+			FormatTo(sink, format, args...);
+			return result;
+		}
+	}
+}
@@ -0,0 +1,198 @@
+
+#include<new>
+#include<atomic>
+#include<cstring>
+#include<algorithm>
+
+#include"FrameArena.h"
+
+namespace Prizm
+{
+	namespace
+	{
+		constexpr unsigned char POISON_BYTE = 0xDD;
+
+		std::atomic<std::uint64_t> frame_index_(0);
+		std::atomic<bool> enabled_(true);
+		std::atomic<bool> pending_enabled_(true);
+
+		// scopes open on this thread, the lazy per-frame reset waits until they are closed
+		thread_local unsigned int scope_depth_ = 0;
+
+		void Poison(void* ptr, std::size_t size)
+		{
+#if PRIZM_FRAME_ARENA_POISON
+			if (ptr && size) std::memset(ptr, POISON_BYTE, size);
+#else
+			(void)ptr;
+			(void)size;
+#endif
+		}
+	}
+
+	FrameArena::FrameArena(std::size_t capacity)
+		: _offset(0)
+		, _overflow_bytes(0)
+		, _high_water(0)
+		, _frame(frame_index_.load(std::memory_order_relaxed))
+	{
+		_block.size = capacity;
+		_block.data = static_cast<char*>(::operator new(capacity));
+	}
+
+	FrameArena::~FrameArena(void)
+	{
+		for (auto& block : _overflow)
+			::operator delete(block.data);
+
+		::operator delete(_block.data);
+	}
+
+	bool FrameArena::Owns(const void* ptr) const
+	{
+		auto p = static_cast<const char*>(ptr);
+
+		if (p >= _block.data && p < _block.data + _block.size) return true;
+
+		for (auto& block : _overflow)
+		{
+			if (p >= block.data && p < block.data + block.size) return true;
+		}
+
+		return false;
+	}
+
+	void* FrameArena::Allocate(std::size_t size, std::size_t alignment)
+	{
+		if (!enabled_.load(std::memory_order_relaxed))
+			return ::operator new(size);
+
+		const auto base = reinterpret_cast<std::uintptr_t>(_block.data);
+		const auto aligned = ((base + _offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1)) - base;
+
+		void* result = nullptr;
+
+		if (aligned + size <= _block.size)
+		{
+			_offset = aligned + size;
+			result = _block.data + aligned;
+		}
+		else
+		{// does not fit, the next Reset grows the block
+			Block block;
+			block.size = (std::max)(size, static_cast<std::size_t>(1));
+			block.data = static_cast<char*>(::operator new(block.size));
+
+			_overflow.emplace_back(block);
+			_overflow_bytes += block.size;
+			result = block.data;
+		}
+
+		_high_water = (std::max)(_high_water, GetUsedBytes());
+		return result;
+	}
+
+	void FrameArena::Deallocate(void* ptr, std::size_t size)
+	{
+		if (!ptr) return;
+
+		if (!Owns(ptr))
+		{// allocated while the arena was disabled
+			::operator delete(ptr);
+			return;
+		}
+
+		Poison(ptr, size);
+	}
+
+	void FrameArena::Reset(void)
+	{
+		Poison(_block.data, _offset);
+
+		const auto required = _offset + _overflow_bytes;
+
+		for (auto& block : _overflow)
+			::operator delete(block.data);
+
+		_overflow.clear();
+		_overflow_bytes = 0;
+		_offset = 0;
+
+		if (required > _block.size)
+		{// grow so that a frame like this one fits in the block
+			const auto capacity = (std::max)(_block.size * 2, required);
+
+			::operator delete(_block.data);
+			_block.data = static_cast<char*>(::operator new(capacity));
+			_block.size = capacity;
+		}
+	}
+
+	FrameArena::Scope::Scope(FrameArena& arena) : _arena(arena), _marker(arena.GetMarker())
+	{
+		++scope_depth_;
+	}
+
+	FrameArena::Scope::~Scope(void)
+	{
+		_arena.Rewind(_marker);
+		--scope_depth_;
+	}
+
+	FrameArena::Marker FrameArena::GetMarker(void) const
+	{
+		return Marker{ _offset, _overflow.size() };
+	}
+
+	void FrameArena::Rewind(const Marker& marker)
+	{
+		if (marker.offset < _offset)
+		{
+			Poison(_block.data + marker.offset, _offset - marker.offset);
+			_offset = marker.offset;
+		}
+
+		while (_overflow.size() > marker.overflow_count)
+		{
+			_overflow_bytes -= _overflow.back().size;
+			::operator delete(_overflow.back().data);
+			_overflow.pop_back();
+		}
+	}
+
+	FrameArena& FrameArena::ThreadLocal(void)
+	{
+		thread_local FrameArena arena;
+
+		const auto frame = frame_index_.load(std::memory_order_acquire);
+
+		if (arena._frame != frame && scope_depth_ == 0)
+		{
+			arena.Reset();
+			arena._frame = frame;
+		}
+
+		return arena;
+	}
+
+	void FrameArena::NextFrame(void)
+	{
+		enabled_.store(pending_enabled_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		frame_index_.fetch_add(1, std::memory_order_release);
+	}
+
+	std::uint64_t FrameArena::GetFrameIndex(void)
+	{
+		return frame_index_.load(std::memory_order_acquire);
+	}
+
+	void FrameArena::SetEnabled(bool enabled)
+	{
+		pending_enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
+	bool FrameArena::IsEnabled(void)
+	{
+		return enabled_.load(std::memory_order_relaxed);
+	}
+}
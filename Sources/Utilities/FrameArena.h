@@ -0,0 +1,133 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+#include<string>
+
+// poison freed frame memory so use-after-frame bugs show up as 0xDD garbage
+#ifndef PRIZM_FRAME_ARENA_POISON
+#ifdef _DEBUG
+#define PRIZM_FRAME_ARENA_POISON 1
+#else
+#define PRIZM_FRAME_ARENA_POISON 0
+#endif
+#endif
+
+namespace Prizm
+{
+	// bump allocator for memory that lives at most one frame
+	// every thread has its own arena, it rewinds itself on the first use after Graphics::EndFrame
+	class FrameArena
+	{
+	public:
+		struct Marker
+		{
+			std::size_t offset;
+			std::size_t overflow_count;
+		};
+
+		// rewinds to the marker taken at construction, for temporaries outside the frame loop
+		class Scope
+		{
+		private:
+			FrameArena& _arena;
+			Marker _marker;
+
+		public:
+			explicit Scope(FrameArena& arena);
+			~Scope(void);
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+		};
+
+		static constexpr std::size_t DEFAULT_CAPACITY = 256 * 1024;
+
+	private:
+		struct Block
+		{
+			char* data;
+			std::size_t size;
+		};
+
+		Block _block;
+		std::size_t _offset;
+
+		// allocations that did not fit, freed on Reset and folded into the next capacity
+		std::vector<Block> _overflow;
+		std::size_t _overflow_bytes;
+
+		std::size_t _high_water;
+		std::uint64_t _frame;
+
+		bool Owns(const void*) const;
+
+	public:
+		explicit FrameArena(std::size_t capacity = DEFAULT_CAPACITY);
+		~FrameArena(void);
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+		// memory is reclaimed on Reset, this only poisons in debug
+		// pointers that are not from this arena are returned to the heap
+		void Deallocate(void* ptr, std::size_t size);
+
+		void Reset(void);
+
+		Marker GetMarker(void) const;
+		void Rewind(const Marker&);
+
+		std::size_t GetUsedBytes(void) const { return _offset + _overflow_bytes; }
+		std::size_t GetCapacity(void) const { return _block.size; }
+		std::size_t GetHighWater(void) const { return _high_water; }
+
+		// arena of the calling thread
+		static FrameArena& ThreadLocal(void);
+
+		// called once per frame from Graphics::EndFrame
+		static void NextFrame(void);
+		static std::uint64_t GetFrameIndex(void);
+
+		// disabled arenas forward to the heap, applied on the next frame
+		static void SetEnabled(bool);
+		static bool IsEnabled(void);
+	};
+
+	// STL adapter, containers using it must not outlive the frame
+	template<class T>
+	class FrameAllocator
+	{
+	public:
+		using value_type = T;
+
+		FrameAllocator(void) noexcept {}
+
+		template<class U>
+		FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+		T* allocate(std::size_t n)
+		{
+			return static_cast<T*>(FrameArena::ThreadLocal().Allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* ptr, std::size_t n)
+		{
+			FrameArena::ThreadLocal().Deallocate(ptr, n * sizeof(T));
+		}
+	};
+
+	template<class T, class U>
+	bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+
+	template<class T, class U>
+	bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+	template<class T>
+	using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+	using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+}
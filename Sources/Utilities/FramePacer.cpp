@@ -0,0 +1,110 @@
+
+#include<thread>
+#include<chrono>
+
+#include"FramePacer.h"
+
+namespace Prizm
+{
+	std::int64_t FramePacer::SteadyClock(void)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void FramePacer::ThreadSleep(std::int64_t ns)
+	{
+		std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+	}
+
+	FramePacer::FramePacer(Clock clock, Sleep sleep)
+		: _clock(clock)
+		, _sleep(sleep)
+		, _target_hz(0.0)
+		, _period(0)
+		, _spin_threshold(DEFAULT_SPIN_THRESHOLD)
+		, _next_deadline(0)
+		, _last_wait(0)
+		, _input_time(0)
+		, _latencies()
+		, _latency_count(0)
+		, _latency_cursor(0)
+	{}
+
+	void FramePacer::SetTargetFrameRate(double hz)
+	{
+		_target_hz = hz > 0.0 ? hz : 0.0;
+		_period = hz > 0.0 ? static_cast<std::int64_t>(1e9 / hz) : 0;
+		_next_deadline = 0;
+	}
+
+	void FramePacer::WaitForNextFrame(void)
+	{
+		const auto begin = _clock();
+		_last_wait = 0;
+
+		if (!_period) return;
+
+		if (!_next_deadline || begin - _next_deadline > _period)
+		{// first frame or more than a frame late, resync instead of rushing to catch up
+			_next_deadline = begin + _period;
+			return;
+		}
+
+		auto now = begin;
+
+		// coarse sleep, the OS may oversleep by its timer granularity
+		if (_next_deadline - now > _spin_threshold)
+		{
+			_sleep(_next_deadline - now - _spin_threshold);
+			now = _clock();
+		}
+
+		while (now < _next_deadline)
+		{
+			std::this_thread::yield();
+			now = _clock();
+		}
+
+		_last_wait = now - begin;
+		_next_deadline += _period;
+	}
+
+	void FramePacer::MarkInputSampled(void)
+	{
+		_input_time = _clock();
+	}
+
+	void FramePacer::MarkPresented(void)
+	{
+		if (!_input_time) return;
+
+		_latencies[_latency_cursor] = _clock() - _input_time;
+		_latency_cursor = (_latency_cursor + 1) % LATENCY_HISTORY;
+		if (_latency_count < LATENCY_HISTORY) ++_latency_count;
+
+		_input_time = 0;
+	}
+
+	double FramePacer::GetLastLatencyMs(void) const
+	{
+		if (!_latency_count) return 0.0;
+
+		return _latencies[(_latency_cursor + LATENCY_HISTORY - 1) % LATENCY_HISTORY] * 1e-6;
+	}
+
+	double FramePacer::GetAverageLatencyMs(void) const
+	{
+		if (!_latency_count) return 0.0;
+
+		std::int64_t total = 0;
+		for (unsigned int i = 0; i < _latency_count; ++i)
+			total += _latencies[i];
+
+		return static_cast<double>(total) / _latency_count * 1e-6;
+	}
+
+	double FramePacer::GetLastWaitMs(void) const
+	{
+		return _last_wait * 1e-6;
+	}
+}
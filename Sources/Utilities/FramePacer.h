@@ -0,0 +1,62 @@
+#pragma once
+
+#include<cstdint>
+#include<functional>
+
+namespace Prizm
+{
+	// frame rate cap and input-to-present latency measurement
+	// the clock and the sleep are injectable so the pacing can run headless against a mock clock
+	class FramePacer
+	{
+	public:
+		// nanoseconds
+		using Clock = std::function<std::int64_t(void)>;
+		using Sleep = std::function<void(std::int64_t)>;
+
+		// sleep until this close to the deadline, then spin, covers the OS timer granularity
+		static constexpr std::int64_t DEFAULT_SPIN_THRESHOLD = 2000000;
+
+		// samples in the latency average
+		static constexpr unsigned int LATENCY_HISTORY = 64;
+
+		static std::int64_t SteadyClock(void);
+		static void ThreadSleep(std::int64_t);
+
+		explicit FramePacer(Clock clock = &FramePacer::SteadyClock, Sleep sleep = &FramePacer::ThreadSleep);
+
+		// 0 = uncapped
+		void SetTargetFrameRate(double hz);
+		double GetTargetFrameRate(void) const { return _target_hz; }
+
+		void SetSpinThreshold(std::int64_t ns) { _spin_threshold = ns; }
+
+		// block until the next frame deadline, call at the top of the frame
+		void WaitForNextFrame(void);
+
+		// latency is measured from the input sample to the present of the same frame
+		void MarkInputSampled(void);
+		void MarkPresented(void);
+
+		double GetLastLatencyMs(void) const;
+		double GetAverageLatencyMs(void) const;
+
+		// time spent in WaitForNextFrame during the last frame
+		double GetLastWaitMs(void) const;
+
+	private:
+		Clock _clock;
+		Sleep _sleep;
+
+		double _target_hz;
+		std::int64_t _period;
+		std::int64_t _spin_threshold;
+		std::int64_t _next_deadline;
+		std::int64_t _last_wait;
+
+		std::int64_t _input_time;
+		std::int64_t _latencies[LATENCY_HISTORY];
+		unsigned int _latency_count;
+		unsigned int _latency_cursor;
+	};
+}
@@ -1,20 +1,518 @@
-
 #include<fstream>
 #include<iostream>
-
-#include<Windows.h>
-#include<io.h>
-#include<fcntl.h>
+#include<cstring>
+#include<cstdio>
+#include<ctime>
+#include<atomic>
+#include<mutex>
+#include<thread>
+#include<memory>
+#include<vector>
+#include<chrono>
+#include<algorithm>
+#include<unordered_map>
+#include<condition_variable>
 
 #include"Log.h"
+#include"Platform.h"
 #include"Utils.h"
+#include"FrameArena.h"
+#include"SpscRing.h"
+#include"Profiler.h"
 
 namespace Prizm
 {
 	namespace Log
 	{
+		constexpr const char* LEVEL_TAGS[] = { "[INFO]: ", "[WARNING]: ", "[ERROR]: " };
+
+		// one cache line multiple, longer messages continue in the following records
+		constexpr std::size_t RECORD_TEXT_SIZE = 236;
+
+		// binary arguments of one message, room for a few strings of MAX_STRING_LENGTH
+		constexpr std::size_t OVERFLOW_SIZE = 64 * 1024;
+
+		struct Record
+		{
+			std::int64_t time;		// system_clock nanoseconds, Profiler ticks for binary records
+			const char* format;		// binary records only, text holds the serialized arguments
+			std::uint16_t length;
+			Level level;
+			bool continues;			// the message goes on in the next record
+			char text[RECORD_TEXT_SIZE];
+		};
+
+		static_assert(sizeof(Record) == 256, "log record should stay 256 bytes");
+
+		// 256 KB per logging thread
+		using RecordRing = SpscRing<Record, 1024>;
+
+		// the writer sleeps this long between batches unless an error wakes it
+		constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(5);
+
 		std::ofstream out_file_;
+		std::ofstream binary_file_;
 		LogMode current_mode_;
+		std::atomic<bool> binary_(false);
+		bool render_text_ = true;	// false when the binary file is the only output
+
+		struct ThreadRing
+		{
+			RecordRing records;
+
+			// consumer side, a message split over records waits here for its last record
+			std::string pending_text;	// binary
+			std::string pending_line;	// text
+			std::string pending_arguments;	// binary records, for both outputs
+
+			// the thread exited, the next thread to log takes the ring over, guarded by registry_mutex_
+			bool released = false;
+		};
+
+		// hands the ring back when its thread exits, so short lived threads do not leave 256 KB each behind
+		struct RingOwner
+		{
+			ThreadRing* ring = nullptr;
+
+			~RingOwner(void);
+		};
+
+		// producers register their ring once, the writer drains every ring
+		// a taken over ring keeps its index, in the binary file the thread number is reused
+		std::mutex registry_mutex_;
+		std::vector<std::unique_ptr<ThreadRing>> rings_;
+		thread_local RingOwner thread_ring_;
+		thread_local std::vector<char> overflow_;
+
+		std::thread writer_;
+		std::atomic<bool> running_(false);
+		std::mutex wake_mutex_;
+		std::condition_variable wake_;
+
+		// consumer side, guarded by registry_mutex_
+		std::string batch_;
+		std::int64_t cached_second_ = -1;
+		char cached_stamp_[48];
+
+		// binary consumer side, also guarded by registry_mutex_
+		std::string binary_batch_;
+		std::unordered_map<const char*, std::uint32_t> format_ids_;
+		std::uint32_t next_format_id_ = BinaryLog::TEXT_FORMAT_ID + 1;
+		std::vector<BinaryLog::Value> decoded_;
+		std::string scratch_;
+
+		// time base of the binary file, maps system_clock stamps of plain messages to ticks
+		std::uint64_t origin_ticks_ = 0;
+		std::int64_t origin_time_ = 0;
+		double ticks_per_nanosecond_ = 1.0;
+		std::uint64_t last_ticks_ = 0;		// messages store the distance to the one before
+
+		std::int64_t Now(void)
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		}
+
+		// [YYYY_MM_DD-HH_MM_SS], LocalTime only runs when the second changes
+		const char* TimeStamp(std::int64_t time)
+		{
+			const std::int64_t second = time / 1000000000;
+
+			if (second != cached_second_)
+			{
+				const std::time_t now = static_cast<std::time_t>(second);
+				std::tm current_time;
+				Platform::LocalTime(now, current_time);
+
+				snprintf(cached_stamp_, sizeof(cached_stamp_), "[%04d_%02d_%02d-%02d_%02d_%02d]",
+					current_time.tm_year + 1900, current_time.tm_mon + 1, current_time.tm_mday,
+					current_time.tm_hour, current_time.tm_min, current_time.tm_sec);
+
+				cached_second_ = second;
+			}
+
+			return cached_stamp_;
+		}
+
+		void WriteOut(const char* text, std::size_t length)
+		{
+			Platform::DebugOutput(text);		// vs
+
+			if (out_file_.is_open())
+			{
+				out_file_.write(text, length);	// file
+				out_file_.flush();
+			}
+
+			std::cout.write(text, length);		// console
+			std::cout.flush();
+		}
+
+		template<class _String>
+		void AppendHead(_String& out, std::int64_t time, Level level)
+		{
+			out.append(TimeStamp(time));
+			out.append(LEVEL_TAGS[level]);
+		}
+
+		template<class _T>
+		void AppendRaw(std::string& out, const _T& value)
+		{
+			out.append(reinterpret_cast<const char*>(&value), sizeof(_T));
+		}
+
+		std::uint32_t InternFormat(const char* format)
+		{
+			auto it = format_ids_.find(format);
+			if (it != format_ids_.end()) return it->second;
+
+			const auto id = next_format_id_++;
+			format_ids_.emplace(format, id);
+
+			const auto length = std::strlen(format);
+
+			AppendRaw(binary_batch_, BinaryLog::RECORD_FORMAT);
+			BinaryLog::AppendVarint(binary_batch_, id);
+			BinaryLog::AppendVarint(binary_batch_, length);
+			binary_batch_.append(format, length);
+
+			return id;
+		}
+
+		void AppendMessage(std::size_t thread, std::uint64_t ticks, Level level, std::uint32_t format_id, const char* arguments, std::size_t size)
+		{
+			// rings are drained one after another, so the distance can be negative
+			const auto delta = static_cast<std::int64_t>(ticks - last_ticks_);
+			last_ticks_ = ticks;
+
+			AppendRaw(binary_batch_, BinaryLog::RECORD_MESSAGE);
+			AppendRaw(binary_batch_, static_cast<std::uint8_t>(level));
+			BinaryLog::AppendVarint(binary_batch_, thread);
+			BinaryLog::AppendVarint(binary_batch_, BinaryLog::ZigZag(delta));
+			BinaryLog::AppendVarint(binary_batch_, format_id);
+			BinaryLog::AppendVarint(binary_batch_, size);
+			binary_batch_.append(arguments, size);
+		}
+
+		// plain messages become "{}" with the whole text as one string argument
+		void AppendTextMessage(std::size_t thread, std::int64_t time, Level level, const std::string& text)
+		{
+			const auto ticks = origin_ticks_ + static_cast<std::uint64_t>((std::max)(time - origin_time_, std::int64_t(0)) * ticks_per_nanosecond_);
+
+			scratch_.resize(3 + (std::min)(text.size(), BinaryLog::MAX_STRING_LENGTH));
+			AppendMessage(thread, ticks, level, BinaryLog::TEXT_FORMAT_ID, &scratch_[0], BinaryLog::EncodeArguments(&scratch_[0], scratch_.size(), text));
+		}
+
+		void DrainBinary(std::size_t thread, ThreadRing& ring, const Record& record)
+		{
+			auto& pending = ring.pending_text;
+			pending.append(record.text, record.length);
+
+			if (!record.continues)
+			{
+				AppendTextMessage(thread, record.time, record.level, pending);
+				pending.clear();
+			}
+		}
+
+		// records with a format, arguments split over records are joined before either output sees them
+		void DrainArguments(std::size_t thread, ThreadRing& ring, const Record& record, bool binary)
+		{
+			auto& pending = ring.pending_arguments;
+			const char* arguments = record.text;
+			std::size_t size = record.length;
+
+			if (record.continues || !pending.empty())
+			{
+				pending.append(record.text, record.length);
+				if (record.continues) return;
+
+				arguments = pending.data();
+				size = pending.size();
+			}
+
+			if (binary) AppendMessage(thread, static_cast<std::uint64_t>(record.time), record.level, InternFormat(record.format), arguments, size);
+
+			if (render_text_)
+			{// rendered here on the writer thread instead of on the caller
+				AppendHead(batch_, origin_time_ + static_cast<std::int64_t>((record.time - static_cast<std::int64_t>(origin_ticks_)) / ticks_per_nanosecond_), record.level);
+
+				Format::StringSink sink(batch_);
+				if (BinaryLog::DecodeArguments(arguments, size, decoded_))
+					BinaryLog::FormatMessage(sink, record.format, decoded_);
+
+				batch_.push_back('\n');
+			}
+
+			pending.clear();
+		}
+
+		void DrainText(ThreadRing& ring, const Record& record)
+		{
+			auto& line = ring.pending_line;
+
+			if (line.empty() && !record.continues)
+			{// the whole message in one record, straight into the batch
+				AppendHead(batch_, record.time, record.level);
+				batch_.append(record.text, record.length);
+				batch_.push_back('\n');
+				return;
+			}
+
+			// the rest may only be pushed after this drain, the line goes out once it is complete
+			if (line.empty()) AppendHead(line, record.time, record.level);
+
+			line.append(record.text, record.length);
+			if (record.continues) return;
+
+			line.push_back('\n');
+			batch_.append(line);
+			line.clear();
+		}
+
+		// the lock makes the writer and Flush take turns as the single consumer
+		void Drain(void)
+		{
+			std::lock_guard<std::mutex> lock(registry_mutex_);
+
+			batch_.clear();
+			binary_batch_.clear();
+
+			const bool binary = binary_file_.is_open();
+
+			for (std::size_t thread = 0; thread < rings_.size(); ++thread)
+			{
+				auto& ring = *rings_[thread];
+
+				while (auto record = ring.records.Front())
+				{
+					if (record->format) DrainArguments(thread, ring, *record, binary);
+					else
+					{
+						if (binary) DrainBinary(thread, ring, *record);
+						if (render_text_) DrainText(ring, *record);
+					}
+
+					ring.records.PopFront();
+				}
+			}
+
+			if (!batch_.empty())
+				WriteOut(batch_.c_str(), batch_.size());
+
+			if (!binary_batch_.empty())
+			{
+				binary_file_.write(binary_batch_.data(), binary_batch_.size());
+				binary_file_.flush();
+			}
+		}
+
+		void WriterLoop(void)
+		{
+			Profiler::SetThreadName("Log Writer");
+
+			while (running_.load(std::memory_order_acquire))
+			{
+				Drain();
+
+				std::unique_lock<std::mutex> lock(wake_mutex_);
+				wake_.wait_for(lock, FLUSH_INTERVAL);
+			}
+
+			Drain();
+		}
+
+		RecordRing& GetThreadRing(void)
+		{
+			if (!thread_ring_.ring)
+			{
+				std::lock_guard<std::mutex> lock(registry_mutex_);
+
+				// records the exited thread left are still drained first, the ring stays single producer
+				for (auto& ring : rings_)
+				{
+					if (!ring->released) continue;
+
+					ring->released = false;
+					thread_ring_.ring = ring.get();
+					break;
+				}
+
+				if (!thread_ring_.ring)
+				{
+					rings_.emplace_back(std::make_unique<ThreadRing>());
+					thread_ring_.ring = rings_.back().get();
+				}
+			}
+
+			return thread_ring_.ring->records;
+		}
+
+		RingOwner::~RingOwner(void)
+		{
+			if (!ring) return;
+
+			std::lock_guard<std::mutex> lock(registry_mutex_);
+			ring->released = true;
+		}
+
+		// before Initialize and after Finalize there is no writer, format and write on the caller
+		void WriteNow(Level level, const char* text, std::size_t length)
+		{
+			// the line is a temporary, build it in the frame arena instead of the heap
+			FrameArena::Scope scope(FrameArena::ThreadLocal());
+			FrameString line;
+
+			// the timestamp cache belongs to the consumer side
+			std::lock_guard<std::mutex> lock(registry_mutex_);
+
+			line.reserve(32 + length);
+			AppendHead(line, Now(), level);
+			line.append(text, length);
+			line.push_back('\n');
+
+			WriteOut(line.c_str(), line.size());
+		}
+
+		Record* BeginRecord(std::int64_t time, Level level)
+		{
+			auto& ring = GetThreadRing();
+
+			Record* record;
+			while (!(record = ring.BeginPush()))
+			{// full, hand the writer a turn rather than lose the message
+				wake_.notify_one();
+				std::this_thread::yield();
+			}
+
+			record->time = time;
+			record->format = nullptr;
+			record->level = level;
+			record->length = 0;
+			record->continues = false;
+
+			return record;
+		}
+	}
+
+	Log::RecordWriter::RecordWriter(Level level) : _level(level), _async(running_.load(std::memory_order_acquire)), _time(Now()), _record(nullptr) {}
+
+	Log::RecordWriter::~RecordWriter(void)
+	{
+		if (!_async)
+		{
+			WriteNow(_level, _sync_line.data(), _sync_line.size());
+			return;
+		}
+
+		// an empty message still makes a line
+		if (!_record) _record = BeginRecord(_time, _level);
+
+		_record->continues = false;
+		GetThreadRing().EndPush();
+
+		// errors should reach the file before a possible crash
+		if (_level == LEVEL_ERROR)
+			wake_.notify_one();
+	}
+
+	Log::BinaryRecordWriter::BinaryRecordWriter(Level level, const char* format)
+		: _record(BeginRecord(static_cast<std::int64_t>(Profiler::Now()), level))
+		, _overflow_size(0)
+	{
+		_record->format = format;
+	}
+
+	Log::BinaryRecordWriter::~BinaryRecordWriter(void)
+	{
+		const char* data = overflow_.data();
+
+		while (_overflow_size)
+		{
+			const auto count = (std::min)(_overflow_size, RECORD_TEXT_SIZE);
+			std::memcpy(_record->text, data, count);
+			_record->length = static_cast<std::uint16_t>(count);
+
+			data += count;
+			_overflow_size -= count;
+			if (!_overflow_size) break;
+
+			// full, the arguments go on in the next record
+			const auto time = _record->time;
+			const auto level = _record->level;
+			const auto format = _record->format;
+
+			_record->continues = true;
+			GetThreadRing().EndPush();
+
+			_record = BeginRecord(time, level);
+			_record->format = format;
+		}
+
+		GetThreadRing().EndPush();
+
+		if (_record->level == LEVEL_ERROR)
+			wake_.notify_one();
+	}
+
+	char* Log::BinaryRecordWriter::GetData(void)
+	{
+		return _record->text;
+	}
+
+	std::size_t Log::BinaryRecordWriter::GetCapacity(void) const
+	{
+		return RECORD_TEXT_SIZE;
+	}
+
+	void Log::BinaryRecordWriter::SetSize(std::size_t size)
+	{
+		_record->length = static_cast<std::uint16_t>(size);
+	}
+
+	char* Log::BinaryRecordWriter::GetOverflowData(void)
+	{
+		overflow_.resize(OVERFLOW_SIZE);
+		return overflow_.data();
+	}
+
+	std::size_t Log::BinaryRecordWriter::GetOverflowCapacity(void) const
+	{
+		return OVERFLOW_SIZE;
+	}
+
+	void Log::BinaryRecordWriter::SetOverflowSize(std::size_t size)
+	{
+		_overflow_size = size;
+	}
+
+	void Log::RecordWriter::Append(const char* text, std::size_t length)
+	{
+		if (!_async)
+		{
+			_sync_line.append(text, length);
+			return;
+		}
+
+		while (length)
+		{
+			if (!_record)
+			{
+				_record = BeginRecord(_time, _level);
+			}
+			else if (_record->length == RECORD_TEXT_SIZE)
+			{// full, the message goes on in the next record
+				_record->continues = true;
+				GetThreadRing().EndPush();
+				_record = BeginRecord(_time, _level);
+			}
+
+			const auto count = (std::min)(length, RECORD_TEXT_SIZE - _record->length);
+			std::memcpy(_record->text + _record->length, text, count);
+			_record->length = static_cast<std::uint16_t>(_record->length + count);
+
+			text += count;
+			length -= count;
+		}
 	}
 
 	void Log::Initialize(LogMode mode, std::string& current_dir)
@@ -37,122 +535,102 @@ namespace Prizm
 			InitFile(current_dir);
 			break;
 
+		case LogMode::BINARY_FILE:
+			InitBinaryFile(current_dir);
+			render_text_ = false;
+			break;
+
+		case LogMode::CONSOLE_AND_BINARY_FILE:
+			InitConsole();
+			InitBinaryFile(current_dir);
+			break;
+
 		default:
 			break;
 		}
 
 		current_mode_ = mode;
+
+		batch_.reserve(64 * 1024);
+		binary_batch_.reserve(64 * 1024);
+		binary_ = binary_file_.is_open();
+		running_ = true;
+		writer_ = std::thread(WriterLoop);
 	}
 
 	void Log::Finalize(void)
 	{
-		std::string msg = StrUtils::Time::GetCurrentTimeAsStringWithBrackets() + "[Log] Finalize()";
-		if (out_file_.is_open())
+		binary_ = false;
+
+		if (running_.exchange(false))
 		{
-			out_file_ << msg;
-			out_file_.close();
+			wake_.notify_one();
+			writer_.join();
 		}
-		std::cout << msg;
-		OutputDebugStringA(msg.c_str());
 
-		if (current_mode_ == CONSOLE || current_mode_ == CONSOLE_AND_FILE)
+		if (binary_file_.is_open())
+			binary_file_.close();
+
+		const char msg[] = "[Log] Finalize()";
+		WriteNow(LEVEL_INFO, msg, sizeof(msg) - 1);
+
+		if (out_file_.is_open())
+			out_file_.close();
+
+		if (current_mode_ == CONSOLE || current_mode_ == CONSOLE_AND_FILE || current_mode_ == CONSOLE_AND_BINARY_FILE)
 		{
-			FreeConsole();
+			Platform::CloseConsole();
 		}
 	}
 
-	void Log::Error(const std::string& s)
+	void Log::Flush(void)
 	{
-		std::string err = StrUtils::Time::GetCurrentTimeAsStringWithBrackets() + "[ERROR]: " + s + "\n";
-
-		OutputDebugStringA(err.c_str());	// vs
-		
-		if (out_file_.is_open())
-			out_file_ << err;				// file
-		
-		std::cout << err;					// console
+		Drain();
 	}
 
-	void Log::Warning(const std::string& s)
+	bool Log::IsBinary(void)
 	{
-		std::string warn = StrUtils::Time::GetCurrentTimeAsStringWithBrackets() + "[WARNING]: " + s + "\n";
-
-		OutputDebugStringA(warn.c_str());	// vs
+		return binary_.load(std::memory_order_relaxed);
+	}
 
-		if (out_file_.is_open())
-			out_file_ << warn;				// file
+	void Log::Error(const std::string& s)
+	{
+		RecordWriter(LEVEL_ERROR).Append(s.data(), s.size());
+	}
 
-		std::cout << warn;					// console
+	void Log::Warning(const std::string& s)
+	{
+		RecordWriter(LEVEL_WARNING).Append(s.data(), s.size());
 	}
 
 	void Log::Info(const std::string& s)
 	{
-		std::string info = StrUtils::Time::GetCurrentTimeAsStringWithBrackets() + "[INFO]: " + s + "\n";
-
-		OutputDebugStringA(info.c_str());	// vs
-
-		if (out_file_.is_open())
-			out_file_ << info;				// file
-
-		std::cout << info;					// console
+		RecordWriter(LEVEL_INFO).Append(s.data(), s.size());
 	}
 
 	void Log::InitConsole(void)
 	{
-		// src: https://stackoverflow.com/a/46050762/2034041
-
-		AllocConsole();
-
-		// Get STDOUT handle
-		HANDLE console_output = GetStdHandle(STD_OUTPUT_HANDLE);
-		int system_output = _open_osfhandle(intptr_t(console_output), _O_TEXT);
-		std::FILE *output_handle = _fdopen(system_output, "w");
-
-		// Get STDERR handle
-		HANDLE console_error = GetStdHandle(STD_ERROR_HANDLE);
-		int system_error = _open_osfhandle(intptr_t(console_error), _O_TEXT);
-		std::FILE *error_handle = _fdopen(system_error, "w");
-
-		// Get STDIN handle
-		HANDLE console_input = GetStdHandle(STD_INPUT_HANDLE);
-		int system_input = _open_osfhandle(intptr_t(console_input), _O_TEXT);
-		std::FILE *input_handle = _fdopen(system_input, "r");
-
-		//make cout, wcout, cin, wcin, wcerr, cerr, wclog and clog point to console as well
-		std::ios::sync_with_stdio(true);
-
-		// Redirect the CRT standard input, output, and error handles to the console
-		freopen_s(&input_handle, "CONIN$", "r", stdin);
-		freopen_s(&output_handle, "CONOUT$", "w", stdout);
-		freopen_s(&error_handle, "CONOUT$", "w", stderr);
-
-		std::wcout.clear();
-		std::cout.clear();
-		std::wcerr.clear();
-		std::cerr.clear();
-		std::wcin.clear();
-		std::cin.clear();
+		Platform::OpenConsole();
 	}
 
 	void Log::InitFile(std::string& current_dir)
 	{
-		const std::string log_directory = current_dir + "\\Logs";
+		const std::string log_directory = current_dir + Platform::PATH_SEPARATOR + "Logs";
 
 		std::string err_msg = "";
 
-		if (CreateDirectoryA(current_dir.c_str(), nullptr))
+		if (Platform::MakeDirectory(current_dir))
 		{
-			if (CreateDirectoryA(log_directory.c_str(), nullptr))
+			if (Platform::MakeDirectory(log_directory))
 			{
 				std::string file_name = StrUtils::Time::GetCurrentTimeAsString() + "_PrizmEngine_Log.txt";
 
-				out_file_.open(log_directory + "//" + file_name);
+				out_file_.open(log_directory + Platform::PATH_SEPARATOR + file_name);
 
 				if (out_file_)
 				{
-					std::string msg = StrUtils::Time::GetCurrentTimeAsStringWithBrackets() + "[Log] " + "Log Initialize Done.";
-					out_file_ << msg;
-					std::cout << msg << std::endl;
+					const char msg[] = "[Log] Log Initialize Done.";
+					WriteNow(LEVEL_INFO, msg, sizeof(msg) - 1);
 				}
 				else
 				{
@@ -171,7 +649,39 @@ namespace Prizm
 
 		if (!err_msg.empty())
 		{
-			MessageBoxA(NULL, err_msg.c_str(), "PrizmEngine: Error Initializing Logging", MB_OK);
+			Platform::ShowError("PrizmEngine: Error Initializing Logging", err_msg);
 		}
 	}
+	void Log::InitBinaryFile(std::string& current_dir)
+	{
+		const std::string log_directory = current_dir + Platform::PATH_SEPARATOR + "Logs";
+
+		Platform::MakeDirectory(current_dir);
+		Platform::MakeDirectory(log_directory);
+
+		const std::string file_name = StrUtils::Time::GetCurrentTimeAsString() + "_PrizmEngine_Log.plog";
+
+		binary_file_.open(log_directory + Platform::PATH_SEPARATOR + file_name, std::ios::binary);
+
+		if (!binary_file_)
+		{
+			Platform::ShowError("PrizmEngine: Error Initializing Logging", "Cannot open log file " + file_name);
+			return;
+		}
+
+		const double ticks_per_second = Profiler::GetTicksPerSecond();
+
+		origin_ticks_ = Profiler::Now();
+		origin_time_ = Now();
+		last_ticks_ = origin_ticks_;
+		ticks_per_nanosecond_ = ticks_per_second / 1e9;
+
+		binary_file_.write(BinaryLog::MAGIC, BinaryLog::MAGIC_SIZE);
+		binary_file_.write(reinterpret_cast<const char*>(&ticks_per_second), sizeof(ticks_per_second));
+		binary_file_.write(reinterpret_cast<const char*>(&origin_ticks_), sizeof(origin_ticks_));
+		binary_file_.write(reinterpret_cast<const char*>(&origin_time_), sizeof(origin_time_));
+
+		const std::string msg = "[Log] Binary log " + file_name;
+		WriteNow(LEVEL_INFO, msg.data(), msg.size());
+	}
 }
\ No newline at end of file
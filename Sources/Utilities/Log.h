@@ -1,6 +1,11 @@
 #pragma once
 
 #include<string>
+#include<cstdint>
+#include<type_traits>
+
+#include"Format.h"
+#include"BinaryLog.h"
 
 namespace Prizm
 {
@@ -12,44 +17,131 @@ namespace Prizm
 			CONSOLE,
 			FILE,
 			CONSOLE_AND_FILE,
+			BINARY_FILE,				// structured .plog, render it with Tools\LogDecoder
+			CONSOLE_AND_BINARY_FILE,
+		};
+
+		enum Level : std::uint8_t
+		{
+			LEVEL_INFO,
+			LEVEL_WARNING,
+			LEVEL_ERROR,
 		};
 
+		struct Record;
+
 		void Initialize(LogMode, std::string&);
 
 		void Finalize(void);
 
+		// messages are queued per thread and written by a background thread after Initialize
+		// Flush writes everything queued so far on the calling thread
+		void Flush(void);
+
+		// true while PRIZM_FMT messages are stored as raw arguments instead of text
+		bool IsBinary(void);
+
+		// format sink that writes straight into the calling thread's log records
+		// one writer is one message, it is queued when the writer goes out of scope
+		class RecordWriter : public Format::Sink
+		{
+		private:
+			Level _level;
+			bool _async;				// latched at construction, Finalize may stop the writer meanwhile
+			std::int64_t _time;
+			Record* _record;			// slot being filled, not yet published
+			std::string _sync_line;		// only used while the background writer is not running
+
+		public:
+			explicit RecordWriter(Level);
+			~RecordWriter(void);
+
+			RecordWriter(const RecordWriter&) = delete;
+			RecordWriter& operator=(const RecordWriter&) = delete;
+
+			void Append(const char* text, std::size_t length) override;
+		};
+
+		// one binary message, the arguments are serialized into the record as they are
+		// arguments longer than a record go to the overflow buffer and continue in the following records
+		class BinaryRecordWriter
+		{
+		private:
+			Record* _record;
+			std::size_t _overflow_size;
+
+		public:
+			BinaryRecordWriter(Level, const char* format);
+			~BinaryRecordWriter(void);
+
+			BinaryRecordWriter(const BinaryRecordWriter&) = delete;
+			BinaryRecordWriter& operator=(const BinaryRecordWriter&) = delete;
+
+			char* GetData(void);
+			std::size_t GetCapacity(void) const;
+			void SetSize(std::size_t);
+
+			// per thread, split over records when the writer goes out of scope
+			char* GetOverflowData(void);
+			std::size_t GetOverflowCapacity(void) const;
+			void SetOverflowSize(std::size_t);
+		};
+
+		template<class _Format, class... Args>
+		void Write(Level level, _Format format, const Args&... args)
+		{
+			if (IsBinary())
+			{// nothing is formatted on the caller, the format string is interned by the writer
+				Format::CheckFormat<_Format, Args...>();
+
+				BinaryRecordWriter writer(level, _Format::Get());
+				std::size_t size;
+
+				if (BinaryLog::TryEncodeArguments(writer.GetData(), writer.GetCapacity(), size, args...))
+				{
+					writer.SetSize(size);
+					return;
+				}
+
+				// rare, encoded again without the one record limit
+				BinaryLog::TryEncodeArguments(writer.GetOverflowData(), writer.GetOverflowCapacity(), size, args...);
+				writer.SetOverflowSize(size);
+				return;
+			}
+
+			RecordWriter writer(level);
+			Format::FormatTo(writer, format, args...);
+		}
+
 		void Error(const std::string&);
 
-		template<class... Args>
-		void Error(const std::string& format, Args&&... args)
+		// Log::Error(PRIZM_FMT("{} failed, hr = {:x}"), name, hr);
+		template<class _Format, class... Args, class = typename std::enable_if<Format::IsFormatString<_Format>::value>::type>
+		void Error(_Format format, const Args&... args)
 		{
-			char msg[128];
-			sprintf_s(msg, format, args...);
-			Error(std::string(msg));
+			Write(LEVEL_ERROR, format, args...);
 		}
 
 		void Warning(const std::string&);
 
-		template<class... Args>
-		void Warning(const std::string& format, Args&&... args)
+		template<class _Format, class... Args, class = typename std::enable_if<Format::IsFormatString<_Format>::value>::type>
+		void Warning(_Format format, const Args&... args)
 		{
-			char msg[128];
-			sprintf_s(msg, format, args...);
-			Warning(std::string(msg));
+			Write(LEVEL_WARNING, format, args...);
 		}
 
 		void Info(const std::string&);
 
-		template<class... Args>
-		void Info(const std::string& format, Args&&... args)
+		template<class _Format, class... Args, class = typename std::enable_if<Format::IsFormatString<_Format>::value>::type>
+		void Info(_Format format, const Args&... args)
 		{
-			char msg[128];
-			sprintf_s(msg, format, args...);
-			Info(std::string(msg));
+			Write(LEVEL_INFO, format, args...);
 		}
 
 		void InitConsole(void);
 
 		void InitFile(std::string&);
+
+		void InitBinaryFile(std::string&);
 	};
-}
\ No newline at end of file
+}
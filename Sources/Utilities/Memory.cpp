@@ -0,0 +1,313 @@
+
+#include<atomic>
+#include<cassert>
+#include<cstdlib>
+#include<fstream>
+#include<sstream>
+#include<algorithm>
+
+#include"Memory.h"
+#include"Log.h"
+
+namespace Prizm
+{
+	namespace Memory
+	{
+		// everything below is touched from inside operator new, so it is all
+		// plain atomics in static storage and nothing here may allocate
+
+		constexpr std::uint32_t HEADER_MAGIC = 0x4d5a5250;	// "PRZM"
+
+		struct alignas(16) AllocationHeader
+		{
+			std::uint64_t size;
+			std::uint32_t tag;
+			std::uint32_t magic;
+		};
+
+		static_assert(sizeof(AllocationHeader) == 16, "allocation header must keep 16 byte alignment");
+
+		constexpr const char* TAG_NAMES[TAG_MAX] = { "Untagged", "Graphics", "Audio", "Scene", "Assets", "ImGui" };
+
+		struct TagCounters
+		{
+			std::atomic<std::uint64_t> live_bytes;
+			std::atomic<std::uint64_t> peak_bytes;
+			std::atomic<std::uint64_t> allocation_count;
+			std::atomic<std::uint64_t> allocated_bytes;
+			std::atomic<std::uint64_t> budget;
+		};
+
+		TagCounters tag_counters_[TAG_MAX];
+		std::atomic<std::uint64_t> free_count_(0);
+
+		// open addressing, slots are claimed once and never freed
+		constexpr std::size_t CALLSITE_TABLE_SIZE = 4096;
+		constexpr std::size_t CALLSITE_MAX_PROBE = 32;
+
+		struct CallsiteSlot
+		{
+			std::atomic<std::uintptr_t> address;
+			std::atomic<std::uint64_t> allocation_count;
+			std::atomic<std::uint64_t> bytes;
+		};
+
+		CallsiteSlot callsites_[CALLSITE_TABLE_SIZE];
+		std::atomic<std::uint64_t> dropped_callsites_(0);
+
+		thread_local Tag current_tag_ = UNTAGGED;
+
+		// game thread only, latched in NextFrame
+		struct FrameSnapshot
+		{
+			std::uint64_t allocation_count;
+			std::uint64_t allocated_bytes;
+			std::uint64_t frame_allocations;
+			std::uint64_t frame_bytes;
+			bool over_budget;
+		};
+
+		FrameSnapshot frame_snapshots_[TAG_MAX];
+
+		void RecordCallsite(const void* callsite, std::size_t size)
+		{
+			const auto address = reinterpret_cast<std::uintptr_t>(callsite);
+			if (!address) return;
+
+			auto hash = static_cast<std::size_t>((static_cast<std::uint64_t>(address) >> 4) * 0x9E3779B97F4A7C15ull);
+
+			for (std::size_t probe = 0; probe < CALLSITE_MAX_PROBE; ++probe)
+			{
+				auto& slot = callsites_[(hash + probe) & (CALLSITE_TABLE_SIZE - 1)];
+				auto current = slot.address.load(std::memory_order_relaxed);
+
+				if (current == 0)
+				{
+					std::uintptr_t expected = 0;
+					if (slot.address.compare_exchange_strong(expected, address, std::memory_order_relaxed))
+						current = address;
+					else
+						current = expected;
+				}
+
+				if (current == address)
+				{
+					slot.allocation_count.fetch_add(1, std::memory_order_relaxed);
+					slot.bytes.fetch_add(size, std::memory_order_relaxed);
+					return;
+				}
+			}
+
+			dropped_callsites_.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void UpdatePeak(TagCounters& counters, std::uint64_t live)
+		{
+			auto peak = counters.peak_bytes.load(std::memory_order_relaxed);
+
+			while (live > peak && !counters.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+		}
+	}
+
+	Memory::TagScope::TagScope(Tag tag) : _previous(current_tag_)
+	{
+		current_tag_ = tag;
+	}
+
+	Memory::TagScope::~TagScope(void)
+	{
+		current_tag_ = _previous;
+	}
+
+	Memory::Tag Memory::GetCurrentTag(void)
+	{
+		return current_tag_;
+	}
+
+	const char* Memory::GetTagName(Tag tag)
+	{
+		return tag < TAG_MAX ? TAG_NAMES[tag] : "Invalid";
+	}
+
+	void* Memory::Allocate(std::size_t size, const void* callsite)
+	{
+		return Allocate(size, current_tag_, callsite);
+	}
+
+	void* Memory::Allocate(std::size_t size, Tag tag, const void* callsite)
+	{
+		auto header = static_cast<AllocationHeader*>(std::malloc(sizeof(AllocationHeader) + size));
+		if (!header) return nullptr;
+
+		if (tag >= TAG_MAX) tag = UNTAGGED;
+
+		header->size = size;
+		header->tag = tag;
+		header->magic = HEADER_MAGIC;
+
+		auto& counters = tag_counters_[tag];
+		counters.allocation_count.fetch_add(1, std::memory_order_relaxed);
+		counters.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+		UpdatePeak(counters, counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+
+		RecordCallsite(callsite, size);
+
+		return header + 1;
+	}
+
+	void Memory::Free(void* ptr)
+	{
+		if (!ptr) return;
+
+		// everything that reaches the replaced operator delete came from the replaced operator new
+		auto header = static_cast<AllocationHeader*>(ptr) - 1;
+		assert(header->magic == HEADER_MAGIC && header->tag < TAG_MAX);
+
+		header->magic = 0;
+		tag_counters_[header->tag].live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+		free_count_.fetch_add(1, std::memory_order_relaxed);
+
+		std::free(header);
+	}
+
+	Memory::TagStats Memory::GetTagStats(Tag tag)
+	{
+		TagStats stats = {};
+		if (tag >= TAG_MAX) return stats;
+
+		auto& counters = tag_counters_[tag];
+		stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+		stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+		stats.allocation_count = counters.allocation_count.load(std::memory_order_relaxed);
+		stats.budget = counters.budget.load(std::memory_order_relaxed);
+		stats.frame_allocations = frame_snapshots_[tag].frame_allocations;
+		stats.frame_bytes = frame_snapshots_[tag].frame_bytes;
+
+		return stats;
+	}
+
+	void Memory::SetBudget(Tag tag, std::uint64_t bytes)
+	{
+		if (tag >= TAG_MAX) return;
+
+		tag_counters_[tag].budget.store(bytes, std::memory_order_relaxed);
+		frame_snapshots_[tag].over_budget = false;
+	}
+
+	std::vector<Memory::CallsiteStats> Memory::GetTopCallsites(std::size_t count)
+	{
+		std::vector<CallsiteStats> result;
+
+		for (auto& slot : callsites_)
+		{
+			const auto address = slot.address.load(std::memory_order_relaxed);
+			if (!address) continue;
+
+			CallsiteStats stats;
+			stats.address = reinterpret_cast<const void*>(address);
+			stats.allocation_count = slot.allocation_count.load(std::memory_order_relaxed);
+			stats.bytes = slot.bytes.load(std::memory_order_relaxed);
+			result.emplace_back(stats);
+		}
+
+		std::sort(result.begin(), result.end(), [](const CallsiteStats& a, const CallsiteStats& b)
+		{
+			return a.allocation_count > b.allocation_count;
+		});
+
+		if (result.size() > count) result.resize(count);
+
+		return result;
+	}
+
+	void Memory::NextFrame(void)
+	{
+		for (unsigned int i = 0; i < TAG_MAX; ++i)
+		{
+			auto& counters = tag_counters_[i];
+			auto& snapshot = frame_snapshots_[i];
+
+			const auto allocation_count = counters.allocation_count.load(std::memory_order_relaxed);
+			const auto allocated_bytes = counters.allocated_bytes.load(std::memory_order_relaxed);
+
+			snapshot.frame_allocations = allocation_count - snapshot.allocation_count;
+			snapshot.frame_bytes = allocated_bytes - snapshot.allocated_bytes;
+			snapshot.allocation_count = allocation_count;
+			snapshot.allocated_bytes = allocated_bytes;
+
+			// warn on the way over the budget only, not every frame
+			const auto budget = counters.budget.load(std::memory_order_relaxed);
+			const bool over_budget = budget && counters.live_bytes.load(std::memory_order_relaxed) > budget;
+
+			if (over_budget && !snapshot.over_budget)
+			{
+				Log::Warning(std::string("Memory budget exceeded for ") + TAG_NAMES[i] + ": "
+					+ std::to_string(counters.live_bytes.load(std::memory_order_relaxed) / 1024) + " KB live, budget "
+					+ std::to_string(budget / 1024) + " KB.");
+			}
+
+			snapshot.over_budget = over_budget;
+		}
+	}
+
+	bool Memory::DumpCsv(const std::string& path)
+	{
+		std::ofstream file(path);
+
+		if (!file)
+		{
+			Log::Error("Cannot open " + path);
+			return false;
+		}
+
+		file << "tag,live_bytes,peak_bytes,allocations,frame_allocations,frame_bytes,budget\n";
+
+		for (unsigned int i = 0; i < TAG_MAX; ++i)
+		{
+			auto stats = GetTagStats(static_cast<Tag>(i));
+			file << TAG_NAMES[i] << ',' << stats.live_bytes << ',' << stats.peak_bytes << ',' << stats.allocation_count << ','
+				<< stats.frame_allocations << ',' << stats.frame_bytes << ',' << stats.budget << '\n';
+		}
+
+		file << "\ncallsite,allocations,bytes\n";
+
+		for (auto& callsite : GetTopCallsites(CALLSITE_TABLE_SIZE))
+		{
+			std::stringstream address;
+			address << "0x" << std::hex << reinterpret_cast<std::uintptr_t>(callsite.address);
+
+			file << address.str() << ',' << callsite.allocation_count << ',' << callsite.bytes << '\n';
+		}
+
+		if (dropped_callsites_.load(std::memory_order_relaxed))
+			file << "dropped," << dropped_callsites_.load(std::memory_order_relaxed) << ",0\n";
+
+		Log::Info("Memory stats written to " + path);
+		return true;
+	}
+
+	std::uint64_t Memory::GetAllocationCount(void)
+	{
+		std::uint64_t count = 0;
+
+		for (auto& counters : tag_counters_)
+			count += counters.allocation_count.load(std::memory_order_relaxed);
+
+		return count;
+	}
+
+	std::uint64_t Memory::GetFreeCount(void)
+	{
+		return free_count_.load(std::memory_order_relaxed);
+	}
+
+	std::uint64_t Memory::GetAllocatedBytes(void)
+	{
+		std::uint64_t bytes = 0;
+
+		for (auto& counters : tag_counters_)
+			bytes += counters.allocated_bytes.load(std::memory_order_relaxed);
+
+		return bytes;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+namespace Prizm
+{
+	// tagged heap tracking, fed by the operator new / delete replacement in Game\MemoryHooks.cpp
+	namespace Memory
+	{
+		enum Tag : unsigned
+		{
+			UNTAGGED = 0,
+			GRAPHICS,
+			AUDIO,
+			SCENE,
+			ASSETS,
+			IMGUI,
+
+			TAG_MAX
+		};
+
+		// allocations on this thread are charged to tag until the scope ends
+		class TagScope
+		{
+		private:
+			Tag _previous;
+
+		public:
+			explicit TagScope(Tag tag);
+			~TagScope(void);
+
+			TagScope(const TagScope&) = delete;
+			TagScope& operator=(const TagScope&) = delete;
+		};
+
+		struct TagStats
+		{
+			std::uint64_t live_bytes;
+			std::uint64_t peak_bytes;
+			std::uint64_t allocation_count;		// since startup
+			std::uint64_t frame_allocations;	// during the last frame
+			std::uint64_t frame_bytes;
+			std::uint64_t budget;				// 0 = no budget
+		};
+
+		struct CallsiteStats
+		{
+			const void* address;				// return address of the operator new call
+			std::uint64_t allocation_count;
+			std::uint64_t bytes;
+		};
+
+		Tag GetCurrentTag(void);
+		const char* GetTagName(Tag);
+
+		// header-prefixed malloc / free, must not be mixed with plain malloc / free
+		void* Allocate(std::size_t size, const void* callsite);
+		void* Allocate(std::size_t size, Tag tag, const void* callsite);
+		void Free(void*);
+
+		TagStats GetTagStats(Tag);
+
+		// warn once live bytes of tag go over bytes, checked in NextFrame
+		void SetBudget(Tag, std::uint64_t bytes);
+
+		// callsites sorted by allocation count
+		std::vector<CallsiteStats> GetTopCallsites(std::size_t count);
+
+		// latch per frame rates and check budgets, once per frame on the game thread
+		void NextFrame(void);
+
+		// tag table and callsite histogram
+		bool DumpCsv(const std::string& path);
+
+		// totals since startup, diff them across a frame for per frame numbers
+		std::uint64_t GetAllocationCount(void);
+		std::uint64_t GetFreeCount(void);
+		std::uint64_t GetAllocatedBytes(void);
+	}
+}
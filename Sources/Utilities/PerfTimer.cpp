@@ -1,68 +1,197 @@
 
+#include<limits>
+#include<thread>
+#include<algorithm>
+
 #include"PerfTimer.h"
+// for the default of PRIZM_PROFILER_USE_TSC, not only a -D of it
+#include"Profiler.h"
+
+// the profiler times its zones with the same calibration
+#if PRIZM_PERF_TIMER_USE_TSC || PRIZM_PROFILER_USE_TSC
+#define PRIZM_TSC_CALIBRATION 1
+#else
+#define PRIZM_TSC_CALIBRATION 0
+#endif
+
+#if PRIZM_TSC_CALIBRATION
+#ifdef _MSC_VER
+#include<intrin.h>
+#else
+#include<x86intrin.h>
+#endif
+#endif
 
 namespace Prizm
 {
-	PerfTimer::PerfTimer() : _is_stopped(false){}
+	namespace
+	{
+		constexpr double NANOSECONDS_PER_MILLISECOND = 1e6;
+		constexpr double NANOSECONDS_PER_SECOND = 1e9;
+
+		PerfTimer::Nanoseconds SteadyNow(void)
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+#if PRIZM_TSC_CALIBRATION
+		struct TscCalibration
+		{
+			std::uint64_t origin;
+			double nanoseconds_per_tick;
+
+			TscCalibration(void)
+			{
+				const auto clock_begin = SteadyNow();
+				const auto tsc_begin = __rdtsc();
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+				const auto tsc_end = __rdtsc();
+				const auto clock_end = SteadyNow();
+
+				origin = tsc_begin;
+				nanoseconds_per_tick = static_cast<double>(clock_end - clock_begin) / static_cast<double>(tsc_end - tsc_begin);
+			}
+		};
+
+		// sleeps 50 ms on first use
+		const TscCalibration& GetTscCalibration(void)
+		{
+			static const TscCalibration calibration;
+			return calibration;
+		}
+#endif
+	}
+
+	PerfTimer::Nanoseconds PerfTimer::Now(void)
+	{
+#if PRIZM_PERF_TIMER_USE_TSC
+		const auto& calibration = GetTscCalibration();
+
+		// offset from the calibration point keeps the double product exact for days
+		return static_cast<Nanoseconds>((__rdtsc() - calibration.origin) * calibration.nanoseconds_per_tick);
+#else
+		return SteadyNow();
+#endif
+	}
+
+	double PerfTimer::GetTscTicksPerSecond(void)
+	{
+#if PRIZM_TSC_CALIBRATION
+		return NANOSECONDS_PER_SECOND / GetTscCalibration().nanoseconds_per_tick;
+#else
+		return 0.0;
+#endif
+	}
+
+	PerfTimer::PerfTimer() : _base_time(0), _prev_time(0), _curr_time(0), _stop_time(0), _paused_time(0), _dt(0), _is_stopped(false)
+	{
+		Reset();
+	}
+
 	PerfTimer::~PerfTimer() = default;
 
-	float PerfTimer::Tick()
+	PerfTimer::Nanoseconds PerfTimer::TickNanoseconds()
 	{
 		if (_is_stopped)
 		{
-			_dt = Duration::zero();
-			return _dt.count();
+			_dt = 0;
+			return _dt;
 		}
 
-		_curr_time = std::chrono::system_clock::now();
+		_curr_time = Now();
 		_dt = _curr_time - _prev_time;
-
 		_prev_time = _curr_time;
-		_dt = _dt.count() < 0.0f ? _dt.zero() : _dt;
 
-		return _dt.count();
+		return _dt;
+	}
+
+	float PerfTimer::Tick()
+	{
+		return static_cast<float>(TickNanoseconds() / NANOSECONDS_PER_SECOND);
 	}
 
 	void PerfTimer::Start()
 	{
 		if (_is_stopped)
 		{
-			_paused_time = _start_time - _stop_time;
-			_prev_time = std::chrono::system_clock::now();
+			const auto now = Now();
+
+			_paused_time += now - _stop_time;
+			_prev_time = _curr_time = now;
 			_is_stopped = false;
 		}
-		Tick();
+		TickNanoseconds();
 	}
 
 	void PerfTimer::Stop()
 	{
-		Tick();
+		TickNanoseconds();
 		if (!_is_stopped)
 		{
-			_stop_time = std::chrono::system_clock::now();
+			_stop_time = Now();
 			_is_stopped = true;
 		}
 	}
 
 	float PerfTimer::DeltaTime() const
 	{
-		return _dt.count();
+		return static_cast<float>(_dt / NANOSECONDS_PER_SECOND);
 	}
 
-	float PerfTimer::TotalTime() const
+	PerfTimer::Nanoseconds PerfTimer::TotalNanoseconds() const
 	{
-		Duration total_time = Duration::zero();
+		if (_is_stopped) return (_stop_time - _base_time) - _paused_time;
 
-		if (_is_stopped) total_time = (_stop_time - _base_time) - _paused_time;
-		else total_time = (_curr_time - _base_time) - _paused_time;
+		return (_curr_time - _base_time) - _paused_time;
+	}
 
-		return total_time.count();
+	float PerfTimer::TotalTime() const
+	{
+		return static_cast<float>(TotalNanoseconds() / NANOSECONDS_PER_SECOND);
 	}
 
 	void PerfTimer::Reset()
 	{
-		_base_time = _prev_time = std::chrono::system_clock::now();
+		_base_time = _prev_time = _curr_time = _stop_time = Now();
+		_paused_time = 0;
 		_is_stopped = true;
-		_dt = Duration::zero();
+		_dt = 0;
+	}
+
+	TimerStats::TimerStats(double ema_alpha) : _ema_alpha(ema_alpha)
+	{
+		Reset();
 	}
+
+	void TimerStats::Add(PerfTimer::Nanoseconds duration)
+	{
+		_last = duration;
+		_min = (std::min)(_min, duration);
+		_max = (std::max)(_max, duration);
+		_total += duration;
+		_ema = _count ? _ema + _ema_alpha * (duration - _ema) : static_cast<double>(duration);
+		++_count;
+	}
+
+	void TimerStats::Reset(void)
+	{
+		_last = 0;
+		_min = (std::numeric_limits<PerfTimer::Nanoseconds>::max)();
+		_max = 0;
+		_total = 0;
+		_count = 0;
+		_ema = 0.0;
+	}
+
+	double TimerStats::GetLastMs(void) const { return _last / NANOSECONDS_PER_MILLISECOND; }
+
+	double TimerStats::GetMinMs(void) const { return _count ? _min / NANOSECONDS_PER_MILLISECOND : 0.0; }
+
+	double TimerStats::GetMaxMs(void) const { return _max / NANOSECONDS_PER_MILLISECOND; }
+
+	double TimerStats::GetMeanMs(void) const { return _count ? static_cast<double>(_total) / _count / NANOSECONDS_PER_MILLISECOND : 0.0; }
+
+	double TimerStats::GetEmaMs(void) const { return _ema / NANOSECONDS_PER_MILLISECOND; }
 }
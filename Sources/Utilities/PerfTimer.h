@@ -1,26 +1,36 @@
 #pragma once
 
-#include<memory>
+#include<cstdint>
 #include<chrono>
 
+// rdtsc as the time source, calibrated against steady_clock once, needs an invariant TSC
+#ifndef PRIZM_PERF_TIMER_USE_TSC
+#define PRIZM_PERF_TIMER_USE_TSC 0
+#endif
+
 namespace Prizm
 {
-	using Time = std::chrono::time_point<std::chrono::system_clock>;
-	using Duration = std::chrono::duration<float>;
-
+	// monotonic timer, all time is kept as integer nanoseconds so long sessions do not drift
 	class PerfTimer
 	{
-	private:
-		Time     _base_time,
-		         _prev_time,
-	             _curr_time,
-		         _start_time,
-		         _stop_time;
-		Duration _paused_time,
-	             _dt;
-		bool     _is_stopped;
+	public:
+		using Nanoseconds = std::int64_t;
 
-		float Tick();
+		// monotonic nanoseconds, only differences are meaningful
+		static Nanoseconds Now(void);
+
+		// __rdtsc ticks per second, measured once for every TSC time source
+		// 0 unless built with PRIZM_PERF_TIMER_USE_TSC or PRIZM_PROFILER_USE_TSC
+		static double GetTscTicksPerSecond(void);
+
+	private:
+		Nanoseconds _base_time,
+		            _prev_time,
+		            _curr_time,
+		            _stop_time,
+		            _paused_time,
+		            _dt;
+		bool        _is_stopped;
 
 	public:
 		PerfTimer();
@@ -28,9 +38,59 @@ namespace Prizm
 
 		void Start();
 		void Stop();
+		// seconds since the previous Tick, 0 while stopped
+		float Tick();
+		Nanoseconds TickNanoseconds();
 		float DeltaTime() const;
+		Nanoseconds DeltaNanoseconds() const { return _dt; }
 		// not include stopped time
 		float TotalTime() const;
+		Nanoseconds TotalNanoseconds() const;
 		void Reset();
 	};
-}
\ No newline at end of file
+
+	// running statistics of a measured duration
+	class TimerStats
+	{
+	private:
+		PerfTimer::Nanoseconds _last,
+		                       _min,
+		                       _max,
+		                       _total;
+		std::uint64_t          _count;
+		double                 _ema;
+		double                 _ema_alpha;
+
+	public:
+		static constexpr double DEFAULT_EMA_ALPHA = 0.1;
+
+		explicit TimerStats(double ema_alpha = DEFAULT_EMA_ALPHA);
+
+		void Add(PerfTimer::Nanoseconds);
+		void Reset(void);
+
+		std::uint64_t GetCount(void) const { return _count; }
+
+		// milliseconds
+		double GetLastMs(void) const;
+		double GetMinMs(void) const;
+		double GetMaxMs(void) const;
+		double GetMeanMs(void) const;
+		double GetEmaMs(void) const;
+	};
+
+	// adds the lifetime of the scope to stats
+	class ScopedTimer
+	{
+	private:
+		TimerStats& _stats;
+		PerfTimer::Nanoseconds _begin;
+
+	public:
+		explicit ScopedTimer(TimerStats& stats) : _stats(stats), _begin(PerfTimer::Now()) {}
+		~ScopedTimer(void) { _stats.Add(PerfTimer::Now() - _begin); }
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+	};
+}
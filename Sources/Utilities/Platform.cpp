@@ -0,0 +1,215 @@
+
+#include<cstdio>
+#include<iostream>
+
+#ifdef _WIN32
+#include<Windows.h>
+#include<shlobj.h>
+#include<io.h>
+#include<fcntl.h>
+#else
+#include<cerrno>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#endif
+
+#include"Platform.h"
+
+namespace Prizm
+{
+#ifdef _WIN32
+
+	void Platform::DebugOutput(const char* text)
+	{
+		OutputDebugStringA(text);
+	}
+
+	void Platform::OpenConsole(void)
+	{
+		// src: https://stackoverflow.com/a/46050762/2034041
+
+		AllocConsole();
+
+		// Get STDOUT handle
+		HANDLE console_output = GetStdHandle(STD_OUTPUT_HANDLE);
+		int system_output = _open_osfhandle(intptr_t(console_output), _O_TEXT);
+		std::FILE *output_handle = _fdopen(system_output, "w");
+
+		// Get STDERR handle
+		HANDLE console_error = GetStdHandle(STD_ERROR_HANDLE);
+		int system_error = _open_osfhandle(intptr_t(console_error), _O_TEXT);
+		std::FILE *error_handle = _fdopen(system_error, "w");
+
+		// Get STDIN handle
+		HANDLE console_input = GetStdHandle(STD_INPUT_HANDLE);
+		int system_input = _open_osfhandle(intptr_t(console_input), _O_TEXT);
+		std::FILE *input_handle = _fdopen(system_input, "r");
+
+		//make cout, wcout, cin, wcin, wcerr, cerr, wclog and clog point to console as well
+		std::ios::sync_with_stdio(true);
+
+		// Redirect the CRT standard input, output, and error handles to the console
+		freopen_s(&input_handle, "CONIN$", "r", stdin);
+		freopen_s(&output_handle, "CONOUT$", "w", stdout);
+		freopen_s(&error_handle, "CONOUT$", "w", stderr);
+
+		std::wcout.clear();
+		std::cout.clear();
+		std::wcerr.clear();
+		std::cerr.clear();
+		std::wcin.clear();
+		std::cin.clear();
+	}
+
+	void Platform::CloseConsole(void)
+	{
+		FreeConsole();
+	}
+
+	bool Platform::MakeDirectory(const std::string& path)
+	{
+		const int result = SHCreateDirectoryExA(nullptr, path.c_str(), nullptr);
+		return result == ERROR_SUCCESS || result == ERROR_ALREADY_EXISTS || result == ERROR_FILE_EXISTS;
+	}
+
+	void Platform::LocalTime(std::time_t time, std::tm& local_time)
+	{
+		localtime_s(&local_time, &time);
+	}
+
+	void Platform::ShowError(const char* caption, const std::string& message)
+	{
+		MessageBoxA(NULL, message.c_str(), caption, MB_OK);
+	}
+
+	bool Platform::Confirm(void* native_window, const char* caption, const char* message)
+	{
+		return MessageBoxA(static_cast<HWND>(native_window), message, caption, MB_YESNO | MB_DEFBUTTON2) == IDYES;
+	}
+
+	bool Platform::MappedFile::Open(const std::string& path)
+	{
+		this->Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		// the mapping keeps the file open
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (!mapping) return false;
+
+		const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data)
+		{
+			CloseHandle(mapping);
+			return false;
+		}
+
+		_data = static_cast<const unsigned char*>(data);
+		_size = static_cast<std::size_t>(size.QuadPart);
+		_mapping = mapping;
+		return true;
+	}
+
+	void Platform::MappedFile::Close(void)
+	{
+		if (!_data) return;
+
+		UnmapViewOfFile(_data);
+		CloseHandle(_mapping);
+
+		_data = nullptr;
+		_size = 0;
+		_mapping = nullptr;
+	}
+
+#else
+
+	void Platform::DebugOutput(const char*) {}
+
+	void Platform::OpenConsole(void) {}
+
+	void Platform::CloseConsole(void) {}
+
+	bool Platform::MakeDirectory(const std::string& path)
+	{
+		for (auto separator = path.find('/', 1); separator != std::string::npos; separator = path.find('/', separator + 1))
+			mkdir(path.substr(0, separator).c_str(), 0755);
+
+		return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+	}
+
+	void Platform::LocalTime(std::time_t time, std::tm& local_time)
+	{
+		localtime_r(&time, &local_time);
+	}
+
+	void Platform::ShowError(const char* caption, const std::string& message)
+	{
+		std::cerr << caption << ": " << message << std::endl;
+	}
+
+	bool Platform::Confirm(void*, const char*, const char*)
+	{
+		// no dialog toolkit, a close request on Linux always goes through
+		return true;
+	}
+
+	bool Platform::MappedFile::Open(const std::string& path)
+	{
+		this->Close();
+
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file < 0) return false;
+
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// the mapping keeps the file open
+		void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED) return false;
+
+		madvise(data, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+
+		_data = static_cast<const unsigned char*>(data);
+		_size = static_cast<std::size_t>(status.st_size);
+		return true;
+	}
+
+	void Platform::MappedFile::Close(void)
+	{
+		if (!_data) return;
+
+		munmap(const_cast<unsigned char*>(_data), _size);
+
+		_data = nullptr;
+		_size = 0;
+	}
+
+#endif
+
+	Platform::MappedFile::MappedFile(void) : _data(nullptr), _size(0), _mapping(nullptr)
+	{
+
+	}
+
+	Platform::MappedFile::~MappedFile(void)
+	{
+		this->Close();
+	}
+}
\ No newline at end of file
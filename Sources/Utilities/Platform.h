@@ -0,0 +1,63 @@
+#pragma once
+
+#include<ctime>
+#include<string>
+#include<cstddef>
+
+// thin OS layer, everything above it is free of <Windows.h> and unistd.h
+// Win32 and POSIX implementations live side by side in Platform.cpp
+
+namespace Prizm
+{
+	namespace Platform
+	{
+#ifdef _WIN32
+		constexpr char PATH_SEPARATOR = '\\';
+#else
+		constexpr char PATH_SEPARATOR = '/';
+#endif
+
+		// debugger output window on Windows, nothing elsewhere since stdout is already the console
+		void DebugOutput(const char*);
+
+		// attaches a console to a GUI process, stdout already is one on Linux
+		void OpenConsole(void);
+		void CloseConsole(void);
+
+		// creates missing parents too, true when the directory exists afterwards
+		bool MakeDirectory(const std::string&);
+
+		// thread safe localtime
+		void LocalTime(std::time_t, std::tm&);
+
+		// blocking message box, stderr when there is no display
+		void ShowError(const char* caption, const std::string& message);
+
+		// yes / no question, native_window may be null, true without a display
+		bool Confirm(void* native_window, const char* caption, const char* message);
+
+		// read-only view of a whole file, pages come in from disk as they are touched
+		class MappedFile
+		{
+		private:
+			const unsigned char* _data;
+			std::size_t _size;
+			// the mapping object on Windows
+			void* _mapping;
+
+		public:
+			MappedFile(void);
+			~MappedFile(void);
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			// false when the file is missing or empty
+			bool Open(const std::string& path);
+			void Close(void);
+
+			const unsigned char* GetData(void) const { return _data; }
+			std::size_t GetSize(void) const { return _size; }
+		};
+	}
+}
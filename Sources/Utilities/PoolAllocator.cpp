@@ -0,0 +1,80 @@
+
+#include<algorithm>
+#include<cstdint>
+
+#include"PoolAllocator.h"
+
+namespace Prizm
+{
+	FixedPool::FixedPool(std::size_t block_size, std::size_t alignment, std::size_t blocks_per_slab)
+		: _alignment((std::max)(alignment, alignof(FreeNode)))
+		, _blocks_per_slab((std::max)(blocks_per_slab, static_cast<std::size_t>(1)))
+		, _free_list(nullptr)
+		, _used_blocks(0)
+	{
+		// every block has to hold a freelist node and keep the next block aligned
+		block_size = (std::max)(block_size, sizeof(FreeNode));
+		_block_size = (block_size + _alignment - 1) / _alignment * _alignment;
+	}
+
+	FixedPool::~FixedPool(void)
+	{
+		for (auto slab : _slabs)
+			::operator delete(slab);
+	}
+
+	void FixedPool::AddSlab(void)
+	{
+		// over-allocate so the first block can be aligned
+		void* slab = ::operator new(_block_size * _blocks_per_slab + _alignment);
+		_slabs.emplace_back(slab);
+
+		const auto address = reinterpret_cast<std::uintptr_t>(slab);
+		auto first = reinterpret_cast<char*>((address + _alignment - 1) / _alignment * _alignment);
+
+		// link in reverse so blocks are handed out in address order
+		for (std::size_t i = _blocks_per_slab; i > 0; --i)
+		{
+			auto node = reinterpret_cast<FreeNode*>(first + (i - 1) * _block_size);
+			node->next = _free_list;
+			_free_list = node;
+		}
+	}
+
+	void* FixedPool::Allocate(void)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		if (!_free_list) AddSlab();
+
+		auto node = _free_list;
+		_free_list = node->next;
+		++_used_blocks;
+
+		return node;
+	}
+
+	void FixedPool::Deallocate(void* ptr)
+	{
+		if (!ptr) return;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		auto node = static_cast<FreeNode*>(ptr);
+		node->next = _free_list;
+		_free_list = node;
+		--_used_blocks;
+	}
+
+	std::size_t FixedPool::GetUsedBlocks(void)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _used_blocks;
+	}
+
+	std::size_t FixedPool::GetCapacity(void)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _slabs.size() * _blocks_per_slab;
+	}
+}
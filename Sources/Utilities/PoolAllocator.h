@@ -0,0 +1,92 @@
+#pragma once
+
+#include<cstddef>
+#include<vector>
+#include<mutex>
+#include<new>
+
+namespace Prizm
+{
+	// fixed-size block allocator, blocks are carved from contiguous slabs and recycled through a freelist
+	// slabs are kept until the pool is destroyed, so churn never returns to the global heap
+	class FixedPool
+	{
+	private:
+		struct FreeNode
+		{
+			FreeNode* next;
+		};
+
+		std::size_t _block_size;
+		std::size_t _alignment;
+		std::size_t _blocks_per_slab;
+
+		std::vector<void*> _slabs;
+		FreeNode* _free_list;
+		std::size_t _used_blocks;
+
+		std::mutex _mutex;
+
+		void AddSlab(void);
+
+	public:
+		static constexpr std::size_t DEFAULT_BLOCKS_PER_SLAB = 256;
+
+		FixedPool(std::size_t block_size, std::size_t alignment, std::size_t blocks_per_slab = DEFAULT_BLOCKS_PER_SLAB);
+		~FixedPool(void);
+
+		FixedPool(const FixedPool&) = delete;
+		FixedPool& operator=(const FixedPool&) = delete;
+
+		void* Allocate(void);
+		void Deallocate(void*);
+
+		std::size_t GetBlockSize(void) const { return _block_size; }
+		std::size_t GetUsedBlocks(void);
+		std::size_t GetCapacity(void);
+	};
+
+	// STL adapter, one FixedPool per allocated type
+	// std::allocate_shared rebinds it to the control block type, so the object and its control block share one block
+	template<class T>
+	class PoolAllocator
+	{
+	public:
+		using value_type = T;
+
+		PoolAllocator(void) noexcept {}
+
+		template<class U>
+		PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+		static FixedPool& Pool(void)
+		{
+			static FixedPool pool(sizeof(T), alignof(T));
+			return pool;
+		}
+
+		T* allocate(std::size_t n)
+		{
+			if (n != 1) return static_cast<T*>(::operator new(n * sizeof(T)));
+
+			return static_cast<T*>(Pool().Allocate());
+		}
+
+		void deallocate(T* ptr, std::size_t n)
+		{
+			if (n != 1)
+			{
+				::operator delete(ptr);
+				return;
+			}
+
+			Pool().Deallocate(ptr);
+		}
+	};
+
+	template<class T, class U>
+	bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+
+	template<class T, class U>
+	bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
+}
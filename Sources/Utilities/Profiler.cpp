@@ -0,0 +1,416 @@
+
+#include<atomic>
+#include<mutex>
+#include<memory>
+#include<fstream>
+#include<algorithm>
+#include<unordered_map>
+
+#include"Profiler.h"
+#include"PerfTimer.h"
+#include"Log.h"
+
+namespace Prizm
+{
+	namespace Profiler
+	{
+		struct Event
+		{
+			const char* name;
+			std::uint64_t begin;
+			std::uint64_t end;
+			std::uint16_t depth;
+		};
+
+		// single producer (the owning thread), single consumer (NextFrame on the main thread)
+		class ThreadBuffer
+		{
+		public:
+			static constexpr std::size_t CAPACITY = 16384;	// power of two
+
+			std::uint32_t id;
+			std::string name;
+
+			Event events[CAPACITY];
+			std::atomic<std::uint64_t> write;
+			std::atomic<std::uint64_t> read;
+			std::atomic<std::uint64_t> dropped;
+
+			explicit ThreadBuffer(std::uint32_t thread_id) : id(thread_id), write(0), read(0), dropped(0) {}
+		};
+
+		struct CapturedEvent
+		{
+			Event event;
+			std::uint32_t thread_id;
+		};
+
+		// gives the buffer back when its thread exits, a loader thread per scene load would leave 512 KB each behind
+		struct BufferOwner
+		{
+			ThreadBuffer* buffer = nullptr;
+
+			~BufferOwner(void);
+		};
+
+		// registration is the only locked path on the producer side
+		// a taken over buffer keeps its id, events still in it are drained as usual
+		std::mutex registry_mutex_;
+		std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers_;
+		std::vector<ThreadBuffer*> free_buffers_;
+
+		thread_local BufferOwner thread_buffer_;
+		thread_local std::uint16_t thread_depth_ = 0;
+
+		// main thread only
+		std::uint64_t frame_index_ = 0;
+		std::uint64_t frame_begin_ = 0;
+		double frame_ms_ = 0.0;
+		std::vector<ZoneStats> frame_stats_;
+		std::vector<CapturedEvent> capture_;
+		std::vector<std::pair<std::uint64_t, std::uint64_t>> capture_frames_;	// frame index, timestamp
+		std::atomic<bool> capturing_(false);
+
+		constexpr std::size_t MAX_CAPTURE_EVENTS = 4 * 1024 * 1024;
+
+		ThreadBuffer& GetThreadBuffer(void)
+		{
+			if (!thread_buffer_.buffer)
+			{
+				std::lock_guard<std::mutex> lock(registry_mutex_);
+
+				if (free_buffers_.empty())
+				{
+					thread_buffers_.emplace_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(thread_buffers_.size())));
+					free_buffers_.push_back(thread_buffers_.back().get());
+				}
+
+				thread_buffer_.buffer = free_buffers_.back();
+				thread_buffer_.buffer->name = "Thread " + std::to_string(thread_buffer_.buffer->id);
+				free_buffers_.pop_back();
+			}
+
+			return *thread_buffer_.buffer;
+		}
+
+		BufferOwner::~BufferOwner(void)
+		{
+			if (!buffer) return;
+
+			std::lock_guard<std::mutex> lock(registry_mutex_);
+			free_buffers_.push_back(buffer);
+		}
+
+		std::string Escape(const char* str)
+		{
+			std::string result;
+
+			for (; *str; ++str)
+			{
+				if (*str == '"' || *str == '\\') result += '\\';
+				result += *str;
+			}
+
+			return result;
+		}
+
+		template<class T>
+		void WriteValue(std::ofstream& file, const T& value)
+		{
+			file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		void WriteString(std::ofstream& file, const std::string& str)
+		{
+			WriteValue(file, static_cast<std::uint16_t>(str.size()));
+			file.write(str.data(), str.size());
+		}
+
+		bool WriteChromeTrace(const std::string& path)
+		{
+			std::ofstream file(path);
+			if (!file) return false;
+
+			const double us_per_tick = 1e6 / GetTicksPerSecond();
+			const std::uint64_t origin = capture_.empty() ? 0 : capture_.front().event.begin;
+
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+			bool first = true;
+			auto separator = [&]() { if (!first) file << ",\n"; first = false; };
+
+			{
+				std::lock_guard<std::mutex> lock(registry_mutex_);
+
+				for (auto& buffer : thread_buffers_)
+				{
+					separator();
+					file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+						<< ",\"args\":{\"name\":\"" << Escape(buffer->name.c_str()) << "\"}}";
+				}
+			}
+
+			for (auto& frame : capture_frames_)
+			{
+				if (frame.second < origin) continue;
+
+				separator();
+				file << "{\"name\":\"Frame " << frame.first << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":"
+					<< (frame.second - origin) * us_per_tick << "}";
+			}
+
+			for (auto& captured : capture_)
+			{
+				auto& event = captured.event;
+				if (event.begin < origin) continue;
+
+				separator();
+				file << "{\"name\":\"" << Escape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << captured.thread_id
+					<< ",\"ts\":" << (event.begin - origin) * us_per_tick << ",\"dur\":" << (event.end - event.begin) * us_per_tick << "}";
+			}
+
+			file << "\n]}\n";
+			return true;
+		}
+
+		// "PRZMPRF1", ticks per second, thread names, zone names, frames, events
+		// events are 20 bytes: begin offset u64, duration u32, name u32, thread u16, depth u16
+		bool WriteBinary(const std::string& path)
+		{
+			std::ofstream file(path, std::ios::binary);
+			if (!file) return false;
+
+			const std::uint64_t origin = capture_.empty() ? 0 : capture_.front().event.begin;
+
+			file.write("PRZMPRF1", 8);
+			WriteValue(file, GetTicksPerSecond());
+
+			{
+				std::lock_guard<std::mutex> lock(registry_mutex_);
+
+				WriteValue(file, static_cast<std::uint32_t>(thread_buffers_.size()));
+				for (auto& buffer : thread_buffers_)
+					WriteString(file, buffer->name);
+			}
+
+			std::unordered_map<const char*, std::uint32_t> name_indices;
+			std::vector<const char*> names;
+
+			for (auto& captured : capture_)
+			{
+				if (name_indices.emplace(captured.event.name, static_cast<std::uint32_t>(names.size())).second)
+					names.emplace_back(captured.event.name);
+			}
+
+			WriteValue(file, static_cast<std::uint32_t>(names.size()));
+			for (auto name : names)
+				WriteString(file, name);
+
+			WriteValue(file, static_cast<std::uint32_t>(capture_frames_.size()));
+			for (auto& frame : capture_frames_)
+			{
+				WriteValue(file, frame.first);
+				WriteValue(file, frame.second >= origin ? frame.second - origin : 0);
+			}
+
+			WriteValue(file, static_cast<std::uint64_t>(capture_.size()));
+			for (auto& captured : capture_)
+			{
+				auto& event = captured.event;
+				const auto duration = (std::min)(event.end - event.begin, static_cast<std::uint64_t>(UINT32_MAX));
+
+				WriteValue(file, event.begin - origin);
+				WriteValue(file, static_cast<std::uint32_t>(duration));
+				WriteValue(file, name_indices[event.name]);
+				WriteValue(file, static_cast<std::uint16_t>(captured.thread_id));
+				WriteValue(file, event.depth);
+			}
+
+			return true;
+		}
+	}
+
+	double Profiler::GetTicksPerSecond(void)
+	{
+#if PRIZM_PROFILER_USE_TSC
+		// the calibration PerfTimer uses, so both agree and the 50 ms sleep happens once
+		return PerfTimer::GetTscTicksPerSecond();
+#else
+		return 1e9;
+#endif
+	}
+
+	std::uint16_t Profiler::PushDepth(void)
+	{
+		return thread_depth_++;
+	}
+
+	void Profiler::PopDepth(void)
+	{
+		--thread_depth_;
+	}
+
+	void Profiler::Record(const char* name, std::uint64_t begin, std::uint64_t end, std::uint16_t depth)
+	{
+		auto& buffer = GetThreadBuffer();
+
+		const auto write = buffer.write.load(std::memory_order_relaxed);
+
+		if (write - buffer.read.load(std::memory_order_acquire) >= ThreadBuffer::CAPACITY)
+		{// consumer is behind, drop rather than block
+			buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		auto& event = buffer.events[write & (ThreadBuffer::CAPACITY - 1)];
+		event.name = name;
+		event.begin = begin;
+		event.end = end;
+		event.depth = depth;
+
+		buffer.write.store(write + 1, std::memory_order_release);
+	}
+
+	void Profiler::SetThreadName(const char* name)
+	{
+		auto& buffer = GetThreadBuffer();
+
+		std::lock_guard<std::mutex> lock(registry_mutex_);
+		buffer.name = name;
+	}
+
+	void Profiler::NextFrame(void)
+	{
+		const auto now = Now();
+		const double ms_per_tick = 1e3 / GetTicksPerSecond();
+		const bool capturing = capturing_.load(std::memory_order_relaxed);
+
+		frame_stats_.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(registry_mutex_);
+
+			for (auto& buffer : thread_buffers_)
+			{
+				const auto write = buffer->write.load(std::memory_order_acquire);
+				auto read = buffer->read.load(std::memory_order_relaxed);
+
+				for (; read != write; ++read)
+				{
+					const auto& event = buffer->events[read & (ThreadBuffer::CAPACITY - 1)];
+
+					// merge zones of the same name and thread, the list stays short
+					auto it = std::find_if(frame_stats_.begin(), frame_stats_.end(), [&](const ZoneStats& stats)
+					{
+						return stats.name == event.name && stats.thread_id == buffer->id;
+					});
+
+					if (it == frame_stats_.end())
+					{
+						ZoneStats stats = { event.name, buffer->id, event.depth, 0, 0.0 };
+						frame_stats_.emplace_back(stats);
+						it = frame_stats_.end() - 1;
+					}
+
+					it->calls++;
+					it->total_ms += (event.end - event.begin) * ms_per_tick;
+					it->depth = (std::min)(it->depth, event.depth);
+
+					if (capturing && capture_.size() < MAX_CAPTURE_EVENTS)
+					{
+						CapturedEvent captured = { event, buffer->id };
+						capture_.emplace_back(captured);
+					}
+				}
+
+				buffer->read.store(read, std::memory_order_release);
+			}
+		}
+
+		if (capturing)
+			capture_frames_.emplace_back(frame_index_, now);
+
+		if (frame_begin_)
+			frame_ms_ = (now - frame_begin_) * ms_per_tick;
+
+		frame_begin_ = now;
+		++frame_index_;
+	}
+
+	std::uint64_t Profiler::GetFrameIndex(void)
+	{
+		return frame_index_;
+	}
+
+	double Profiler::GetFrameMs(void)
+	{
+		return frame_ms_;
+	}
+
+	const std::vector<Profiler::ZoneStats>& Profiler::GetFrameStats(void)
+	{
+		return frame_stats_;
+	}
+
+	std::uint32_t Profiler::GetThreadIndex(void)
+	{
+		return GetThreadBuffer().id;
+	}
+
+	std::string Profiler::GetThreadName(std::uint32_t thread_id)
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex_);
+
+		return thread_id < thread_buffers_.size() ? thread_buffers_[thread_id]->name : std::string("Unknown");
+	}
+
+	void Profiler::BeginCapture(void)
+	{
+		capture_.clear();
+		capture_frames_.clear();
+		capturing_ = true;
+
+		Log::Info("Profiler capture started.");
+	}
+
+	bool Profiler::IsCapturing(void)
+	{
+		return capturing_;
+	}
+
+	bool Profiler::EndCapture(const std::string& path)
+	{
+		if (!capturing_) return false;
+		capturing_ = false;
+
+		// events are appended in drain order, exporters expect time order
+		std::stable_sort(capture_.begin(), capture_.end(), [](const CapturedEvent& a, const CapturedEvent& b)
+		{
+			return a.event.begin < b.event.begin;
+		});
+
+		const bool written = WriteChromeTrace(path + ".json") && WriteBinary(path + ".prof");
+
+		if (written)
+			Log::Info("Profiler capture written to " + path + ".json / .prof, " + std::to_string(capture_.size()) + " events.");
+		else
+			Log::Error("Failed to write profiler capture " + path);
+
+		capture_.clear();
+		capture_.shrink_to_fit();
+		capture_frames_.clear();
+
+		return written;
+	}
+
+	std::uint64_t Profiler::GetDroppedEventCount(void)
+	{
+		std::uint64_t dropped = 0;
+
+		std::lock_guard<std::mutex> lock(registry_mutex_);
+		for (auto& buffer : thread_buffers_)
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+		return dropped;
+	}
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include<cstdint>
+#include<chrono>
+#include<string>
+#include<vector>
+
+// instrumentation on by default, define PRIZM_PROFILER_ENABLED 0 to compile the zones out
+#ifndef PRIZM_PROFILER_ENABLED
+#define PRIZM_PROFILER_ENABLED 1
+#endif
+
+// rdtsc timestamps, cheaper than steady_clock but needs an invariant TSC
+#ifndef PRIZM_PROFILER_USE_TSC
+#define PRIZM_PROFILER_USE_TSC 0
+#endif
+
+#if PRIZM_PROFILER_USE_TSC
+#ifdef _MSC_VER
+#include<intrin.h>
+#else
+#include<x86intrin.h>
+#endif
+#endif
+
+#define PRIZM_PROFILER_CONCAT_IMPL(a, b) a##b
+#define PRIZM_PROFILER_CONCAT(a, b) PRIZM_PROFILER_CONCAT_IMPL(a, b)
+
+#if PRIZM_PROFILER_ENABLED
+// name has to be a string literal, only the pointer is recorded
+#define PRIZM_ZONE(name) ::Prizm::Profiler::Zone PRIZM_PROFILER_CONCAT(prizm_zone_, __LINE__)(name)
+#else
+#define PRIZM_ZONE(name)
+#endif
+
+namespace Prizm
+{
+	namespace Profiler
+	{
+		// zone durations of the last completed frame, merged by name and thread
+		struct ZoneStats
+		{
+			const char* name;
+			std::uint32_t thread_id;
+			std::uint16_t depth;
+			std::uint32_t calls;
+			double total_ms;
+		};
+
+		inline std::uint64_t Now(void)
+		{
+#if PRIZM_PROFILER_USE_TSC
+			return __rdtsc();
+#else
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+		}
+
+		// Now() ticks per second, calibrated against steady_clock on first use with TSC
+		double GetTicksPerSecond(void);
+
+		// called by Zone, records one complete zone on the calling thread
+		void Record(const char* name, std::uint64_t begin, std::uint64_t end, std::uint16_t depth);
+
+		std::uint16_t PushDepth(void);
+		void PopDepth(void);
+
+		class Zone
+		{
+		private:
+			const char* _name;
+			std::uint16_t _depth;
+			std::uint64_t _begin;
+
+		public:
+			explicit Zone(const char* name) : _name(name), _depth(PushDepth()), _begin(Now()) {}
+
+			~Zone(void)
+			{
+				Record(_name, _begin, Now(), _depth);
+				PopDepth();
+			}
+
+			Zone(const Zone&) = delete;
+			Zone& operator=(const Zone&) = delete;
+		};
+
+		// shown in the trace viewer, call once from each thread
+		void SetThreadName(const char* name);
+
+		// frame marker, drains every thread buffer and rebuilds the frame stats
+		// call once per frame on the main thread
+		void NextFrame(void);
+		std::uint64_t GetFrameIndex(void);
+
+		// time between the last two NextFrame calls
+		double GetFrameMs(void);
+
+		const std::vector<ZoneStats>& GetFrameStats(void);
+
+		// registry index of the calling thread, matches ZoneStats::thread_id
+		std::uint32_t GetThreadIndex(void);
+
+		// name given by SetThreadName, ZoneStats::thread_id indexes the registry
+		std::string GetThreadName(std::uint32_t thread_id);
+
+		// events recorded between BeginCapture and EndCapture are exported
+		void BeginCapture(void);
+		bool IsCapturing(void);
+
+		// <path>.json is Chrome trace-event JSON (chrome://tracing, Perfetto)
+		// <path>.prof is the compact binary form
+		bool EndCapture(const std::string& path);
+
+		// number of events lost to full thread buffers
+		std::uint64_t GetDroppedEventCount(void);
+	}
+}
@@ -24,7 +24,8 @@ namespace Prizm
 		{
 			if (_reuce.size())
 			{
-				auto& reuse_index = _reuce.back();
+				// copy, pop_back would leave a reference dangling
+				const auto reuse_index = _reuce.back();
 				_reuce.pop_back();
 
 				_resources[reuse_index] = std::move(resource);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include<atomic>
+#include<cstddef>
+#include<utility>
+
+namespace Prizm
+{
+	// bounded lock-free ring for exactly one producer thread and one consumer thread
+	// capacity has to be a power of two, slots are written in place through BeginPush / EndPush
+	template<class _T, std::size_t _Capacity>
+	class SpscRing
+	{
+		static_assert(_Capacity && (_Capacity & (_Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+	private:
+		static constexpr std::size_t CACHE_LINE = 64;
+
+		// producer and consumer indices on separate cache lines
+		std::atomic<std::size_t> _write;
+		char _write_padding[CACHE_LINE - sizeof(std::atomic<std::size_t>)];
+		std::atomic<std::size_t> _read;
+		char _read_padding[CACHE_LINE - sizeof(std::atomic<std::size_t>)];
+
+		_T _items[_Capacity];
+
+	public:
+		static constexpr std::size_t CAPACITY = _Capacity;
+
+		SpscRing(void) : _write(0), _read(0) {}
+
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		// producer, nullptr when full
+		_T* BeginPush(void)
+		{
+			const auto write = _write.load(std::memory_order_relaxed);
+			if (write - _read.load(std::memory_order_acquire) >= _Capacity) return nullptr;
+
+			return &_items[write & (_Capacity - 1)];
+		}
+
+		// producer, publishes the slot returned by BeginPush
+		void EndPush(void)
+		{
+			_write.store(_write.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		bool Push(const _T& item)
+		{
+			auto slot = BeginPush();
+			if (!slot) return false;
+
+			*slot = item;
+			EndPush();
+			return true;
+		}
+
+		bool Push(_T&& item)
+		{
+			auto slot = BeginPush();
+			if (!slot) return false;
+
+			*slot = std::move(item);
+			EndPush();
+			return true;
+		}
+
+		// consumer, nullptr when empty
+		_T* Front(void)
+		{
+			const auto read = _read.load(std::memory_order_relaxed);
+			if (read == _write.load(std::memory_order_acquire)) return nullptr;
+
+			return &_items[read & (_Capacity - 1)];
+		}
+
+		// consumer, releases the slot returned by Front
+		void PopFront(void)
+		{
+			_read.store(_read.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		bool Pop(_T& item)
+		{
+			auto slot = Front();
+			if (!slot) return false;
+
+			item = std::move(*slot);
+			PopFront();
+			return true;
+		}
+
+		// approximate from any thread other than the two ends
+		std::size_t Size(void) const
+		{
+			return _write.load(std::memory_order_acquire) - _read.load(std::memory_order_acquire);
+		}
+
+		bool Empty(void) const { return Size() == 0; }
+	};
+}
@@ -4,9 +4,14 @@
 #include<sstream>
 #include<ctime>
 #include<iomanip>
+#include<cstdlib>
+
+#ifdef _WIN32
 #include "shlobj.h"
+#endif
 
 #include"Utils.h"
+#include"Platform.h"
 
 namespace Prizm
 {
@@ -29,7 +34,7 @@ namespace Prizm
 			const std::time_t now = std::time(0);
 			std::tm current_time;
 			
-			localtime_s(&current_time, &now);
+			Platform::LocalTime(now, current_time);
 
 			// YYYY-MM-DD_HH-MM-SS
 			std::stringstream ss;
@@ -50,6 +55,7 @@ namespace Prizm
 
 	namespace DirectoryUtils
 	{
+#ifdef _WIN32
 		std::string GetSpecialFolderPath(FolderType folder)
 		{
 			const KNOWNFOLDERID& folder_id = [&]()
@@ -77,6 +83,73 @@ namespace Prizm
 
 			return StrUtils::UnicodeToAscii(destination_path);
 		}
+#else
+		// XDG base directories, APPDATA maps to the config home
+		std::string GetSpecialFolderPath(FolderType folder)
+		{
+			auto environment = [](const char* name) -> std::string
+			{
+				const char* value = std::getenv(name);
+				return value ? value : "";
+			};
+
+			const std::string home = environment("HOME");
+
+			switch (folder)
+			{
+			case PROGRAM_FILE:
+				return "/usr/local";
+			case APPDATA:
+			{
+				const std::string config = environment("XDG_CONFIG_HOME");
+				return config.empty() ? home + "/.config" : config;
+			}
+			case LOCAL_APPDATA:
+			{
+				const std::string data = environment("XDG_DATA_HOME");
+				return data.empty() ? home + "/.local/share" : data;
+			}
+			case USER_PROFILE:
+				return home;
+			case DOCUMENTS:
+				return home + "/Documents";
+			}
+
+			return home;
+		}
+#endif
+	}
+
+	namespace HashUtils
+	{
+		std::uint64_t Fnv1a64(const void* data, size_t size, std::uint64_t seed)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			std::uint64_t hash = seed;
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				hash ^= bytes[i];
+				hash *= FNV1A_PRIME;
+			}
+
+			return hash;
+		}
+
+		std::string ToHexString(std::uint64_t value)
+		{
+			std::stringstream ss;
+			ss << std::hex << std::setfill('0') << std::setw(16) << value;
+			return ss.str();
+		}
+
+		std::uint64_t FromHexString(const std::string& str)
+		{
+			std::uint64_t value = 0;
+			std::stringstream ss(str);
+			ss >> std::hex >> value;
+			return value;
+		}
 	}
 
 	namespace Utils
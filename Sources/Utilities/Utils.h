@@ -2,6 +2,7 @@
 
 #include<string>
 #include<random>
+#include<cstdint>
 
 namespace Prizm
 {
@@ -38,6 +39,17 @@ namespace Prizm
 		std::string GetSpecialFolderPath(FolderType);
 	}
 
+	namespace HashUtils
+	{
+		constexpr std::uint64_t FNV1A_OFFSET_BASIS = 14695981039346656037ull;
+		constexpr std::uint64_t FNV1A_PRIME = 1099511628211ull;
+
+		// 64bit FNV-1a, pass the previous result as seed to chain buffers
+		std::uint64_t Fnv1a64(const void* data, size_t size, std::uint64_t seed = FNV1A_OFFSET_BASIS);
+		std::string ToHexString(std::uint64_t value);
+		std::uint64_t FromHexString(const std::string& str);
+	}
+
 	namespace Utils
 	{
 		float RandF(float low, float high);
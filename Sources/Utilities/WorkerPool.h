@@ -4,9 +4,12 @@
 #include<mutex>
 #include<deque>
 #include<vector>
+#include<functional>
 #include<condition_variable>
 #include<cassert>
 
+#include"Profiler.h"
+
 namespace Prizm
 {
 	template<typename _T>
@@ -21,7 +24,7 @@ namespace Prizm
 
 		bool Push(const _T& task)
 		{
-			if (_size <= _deque.size())
+			if (_size <= static_cast<int>(_deque.size()))
 				return false;
 
 			_deque.emplace_back(task);
@@ -30,7 +33,7 @@ namespace Prizm
 
 		bool Push(_T&& task)
 		{
-			if (_size <= _deque.size())
+			if (_size <= static_cast<int>(_deque.size()))
 				return false;
 
 			_deque.emplace_back(std::move(task));
@@ -58,14 +61,23 @@ namespace Prizm
 	private:
 		TaskQueue<std::function<void()>> _pool;
 		bool _is_terminated;
+		int _running;
 		std::mutex _mutex;
 		std::condition_variable _cv;
+		std::condition_variable _idle_cv;
 		std::vector<std::thread> _threads;
 
+		// per-thread setup the tasks rely on (COM for WIC), end runs when the thread leaves its loop
+		std::function<void()> _thread_begin;
+		std::function<void()> _thread_end;
+
 	public:
-		WorkerPool(int thread_count, int queue_size)
-			: _is_terminated(false)
-			, _pool(queue_size)
+		WorkerPool(int thread_count, int queue_size, std::function<void()> thread_begin = nullptr, std::function<void()> thread_end = nullptr)
+			: _pool(queue_size)
+			, _is_terminated(false)
+			, _running(0)
+			, _thread_begin(std::move(thread_begin))
+			, _thread_end(std::move(thread_end))
 		{
 			for (int i = 0; i < thread_count; ++i)
 			{
@@ -75,16 +87,16 @@ namespace Prizm
 
 		~WorkerPool(void)
 		{
-			std::unique_lock<std::mutex> lock(_mutex);
-			_is_terminated = true;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_is_terminated = true;
+			}
 
 			_cv.notify_all();
 
-			const int size = _threads.size();
-
-			for (int i = 0; i < size; ++i)
+			for (auto& thread : _threads)
 			{
-				_threads.at(i).join();
+				thread.join();
 			}
 		}
 
@@ -94,7 +106,7 @@ namespace Prizm
 
 			if (!_pool.Push(task)) return false;
 
-			_cv.notify_all();
+			_cv.notify_one();
 
 			return true;
 		}
@@ -105,32 +117,71 @@ namespace Prizm
 
 			if (!_pool.Push(std::move(task))) return false;
 
-			_cv.notify_all();
+			_cv.notify_one();
 
 			return true;
 		}
 
+		// block until the queue is drained and no task is running
+		void WaitIdle(void)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_idle_cv.wait(lock, [this] { return _pool.Empty() && _running == 0; });
+		}
+
+		int ThreadCount(void) const
+		{
+			return static_cast<int>(_threads.size());
+		}
+
 	private:
 		std::function<void()> _run = [this]
 		{
+			Profiler::SetThreadName("Worker");
+
+			struct ThreadScope
+			{
+				const std::function<void()>& end;
+
+				~ThreadScope(void) { if (end) end(); }
+			};
+
+			if (_thread_begin) _thread_begin();
+			ThreadScope scope{ _thread_end };
+
 			while (true)
 			{
 				std::function<void()> func;
 
-				std::unique_lock<std::mutex> lock(_mutex);
-
-				while (_pool.Empty()) 
 				{
-					if (_is_terminated) return;
+					std::unique_lock<std::mutex> lock(_mutex);
 
-					_cv.wait(lock);
+					while (_pool.Empty())
+					{
+						if (_is_terminated) return;
+
+						_cv.wait(lock);
+					}
+
+					const bool result = _pool.Pop(func);
+					assert(result);
+					++_running;
 				}
 
-				const bool result = _pool.Pop(func);
-				assert(result);
+				// run outside the lock so workers actually execute in parallel
+				{
+					PRIZM_ZONE("WorkerPool::Task");
+					func();
+				}
 
-				func();
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+					--_running;
+
+					if (_pool.Empty() && _running == 0)
+						_idle_cv.notify_all();
+				}
 			}
 		};
 	};
-}
\ No newline at end of file
+}